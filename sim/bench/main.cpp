@@ -0,0 +1,259 @@
+/**
+  * Host benchmark of the firmware hot paths, on the simulation build.
+  *
+  * vase-bench [--samples N] [--stage NAME]
+  *
+  * Each stage is run N times (default 100000) and reported as one CSV line:
+  *
+  *   stage,samples,total_ns,ns_per_sample
+  *
+  * Timings are host CPU time and only compare builds with each other: the device is a
+  * 16 MHz Cortex-M0 without a divider or a cache. Probe settling waits are simulated and
+  * cost nothing here; MicroBitProfiler times the real path on the device.
+  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "MicroBit.h"
+
+#include "sensors/moisture/MicroBitMoistureSensor.h"
+#include "services/moisture/MicroBitMoistureService.h"
+#include "services/command/MicroBitCommandService.h"
+#include "storage/history/MicroBitHistory.h"
+#include "controllers/forecast/MicroBitDryingForecast.h"
+#include "controllers/forecast/MicroBitEvapotranspiration.h"
+
+static MicroBitMessageBus bus;
+static BLEDevice ble;
+
+static MicroBitPin probe(MICROBIT_ID_IO_P0, MICROBIT_PIN_P0, PIN_CAPABILITY_ALL);
+static MicroBitPin excitation(MICROBIT_ID_IO_P1, MICROBIT_PIN_P1, PIN_CAPABILITY_ALL);
+
+// Keeps the results alive, so that the compiler cannot drop the work
+static volatile int32_t sink;
+
+static uint32_t samples = 100000;
+static const char *only = NULL;
+
+// Samples of sensor_to_notify that were not notified
+static uint32_t missed = 0;
+
+/**
+  * Time a stage and print its line.
+  *
+  * @param stage the name of the stage.
+  * @param body runs one sample of the stage, given its index.
+  */
+template <typename Body>
+static void bench(const char *stage, Body body)
+{
+    if (only != NULL && strcmp(only, stage) != 0)
+        return;
+
+    // Warm up the caches and the branch predictors
+    for (uint32_t i = 0; i < samples / 10; i++)
+        body(i);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < samples; i++)
+        body(i);
+
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%s,%u,%llu,%.1f\n", stage, samples, (unsigned long long)ns, (double)ns / samples);
+    fflush(stdout);
+}
+
+/**
+  * A probe reading that moves a little around a level.
+  */
+static void setProbe(uint32_t i)
+{
+    sim_environment().analogIn[MICROBIT_PIN_P0] = 400 + (i * 7) % 13;
+}
+
+/**
+  * One sample of the sensor-to-notify path, a second after the previous one.
+  *
+  * @return true if the sample was notified.
+  */
+static bool sampleAndNotify(MicroBitMoistureSensor &sensor, uint32_t i)
+{
+    wait_ms(MICROBIT_MOISTURE_SERVICE_MIN_INTERVAL);
+    sim_environment().analogIn[MICROBIT_PIN_P0] = 300 + (i % 2) * 400;
+    sensor.setNextSample(0);
+    sensor.updateSample();
+
+    bool notified = !ble.gattServer().getNotifications().empty();
+
+    ble.simulateDataSent();
+    ble.gattServer().getNotifications().clear();
+
+    return notified;
+}
+
+static void benchSensor()
+{
+    static MicroBitMoistureSensor sensor(probe, excitation);
+
+    sensor.setTemperatureCompensation(20);
+    sensor.setTemperature(25);
+
+    bench("moisture_sample", [](uint32_t i) {
+        setProbe(i);
+        sensor.setNextSample(0);
+        sensor.updateSample();
+        sink = sensor.getMoistureLevel();
+    });
+
+    sensor.setBurst(8, MOISTURE_REDUCTION_MEAN);
+
+    bench("moisture_sample_burst8_mean", [](uint32_t i) {
+        setProbe(i);
+        sensor.setNextSample(0);
+        sensor.updateSample();
+        sink = sensor.getMoistureLevel();
+    });
+
+    sensor.setBurst(8, MOISTURE_REDUCTION_TRIMMED_MEAN);
+
+    bench("moisture_sample_burst8_trimmed", [](uint32_t i) {
+        setProbe(i);
+        sensor.setNextSample(0);
+        sensor.updateSample();
+        sink = sensor.getMoistureLevel();
+    });
+
+    sensor.setBurst(8, MOISTURE_REDUCTION_MEDIAN);
+
+    bench("moisture_sample_burst8_median", [](uint32_t i) {
+        setProbe(i);
+        sensor.setNextSample(0);
+        sensor.updateSample();
+        sink = sensor.getMoistureLevel();
+    });
+
+    sensor.setBurst(1);
+
+    // The whole sensor-to-notify path: sample, event, moisture service handler and notify.
+    // The reading swings and a second goes by between samples, so that every sample is notified:
+    // a sample that is not fails the bench, as the stage would no longer time the whole path.
+    static MicroBitMoistureService service(ble, sensor, 10);
+
+    ble.simulateConnect();
+
+    // Let the moisture filters settle on the swing first
+    for (uint32_t i = 0; i < 16; i++)
+        sampleAndNotify(sensor, i);
+
+    bench("sensor_to_notify", [](uint32_t i) {
+        if (!sampleAndNotify(sensor, i))
+            missed++;
+    });
+
+    ble.simulateDisconnect();
+}
+
+static void benchProcessing()
+{
+    static MicroBitMoistureCalibration calibration;
+
+    calibration.set(245, 1023, MICROBIT_MOISTURE_CURVE_RESISTIVE);
+
+    bench("calibration_apply", [](uint32_t i) {
+        sink = calibration.apply(i & 1023);
+    });
+
+    static MicroBitMoistureFilter filter;
+
+    bench("filter_chain", [](uint32_t i) {
+        sink = filter.apply(20 + (i * 7) % 5);
+    });
+
+    static MicroBitHistory history;
+
+    bench("history_record", [](uint32_t i) {
+        MicroBitHistorySample s = { i * 300, (uint8_t)(20 + i % 5), (uint8_t)(i * 13), 18, 0 };
+        history.record(s);
+    });
+
+    bench("history_read", [](uint32_t i) {
+        static MicroBitHistorySample state;
+        uint8_t record[MICROBIT_HISTORY_RECORD_SIZE];
+        uint32_t seq = history.first() + i % MICROBIT_HISTORY_CAPACITY;
+
+        if (seq == history.first())
+            history.stateBefore(seq, state);
+
+        history.read(seq, record);
+        MicroBitHistory::decode(record, state);
+        sink = state.moisture;
+    });
+
+    static MicroBitDryingForecast forecast;
+    static MicroBitEvapotranspiration et;
+
+    et.update(100, 20);
+
+    bench("forecast_update", [](uint32_t i) {
+        forecast.update(30 - (int)(i % 20), i * 1000);
+        sink = forecast.timeToThreshold(15, 10, et);
+    });
+
+    bench("et_update", [](uint32_t i) {
+        et.update(i & 0xFF, 20);
+        sink = et.getTotal();
+    });
+}
+
+static void benchCommand()
+{
+    static MicroBitCommandService service(ble);
+    static GattAttribute::Handle_t handle = ble.gattServer().findCharacteristic(UUID(MicroBitCommandServiceDataUUID));
+
+    // Threshold, pulse, periods and a watering
+    static const uint8_t batch[] = { 1, 1, 1, 15, 2, 2, 0xA0, 0x0F, 3, 8, 0xE8, 0x03, 0, 0, 0x60, 0xEA, 0, 0, 4, 0 };
+
+    bench("command_decode", [](uint32_t) {
+        ble.simulateWrite(handle, batch, sizeof(batch));
+        service.acknowledge(MICROBIT_COMMAND_STATUS_OK);
+    });
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--samples") && i + 1 < argc)
+            samples = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--stage") && i + 1 < argc)
+            only = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--samples N] [--stage NAME]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (samples == 0)
+        samples = 1;
+
+    printf("stage,samples,total_ns,ns_per_sample\n");
+
+    benchSensor();
+
+    if (missed)
+    {
+        fprintf(stderr, "sensor_to_notify: %u samples not notified\n", missed);
+        return 1;
+    }
+
+    benchProcessing();
+    benchCommand();
+
+    return 0;
+}
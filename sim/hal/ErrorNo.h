@@ -0,0 +1,29 @@
+#ifndef ERROR_NO_H
+#define ERROR_NO_H
+
+/**
+  * Status and panic codes, with the values of microbit-dal.
+  */
+enum ErrorCode
+{
+    MICROBIT_OK = 0,
+    MICROBIT_INVALID_PARAMETER = -1001,
+    MICROBIT_NOT_SUPPORTED = -1002,
+    MICROBIT_CALIBRATION_IN_PROGRESS = -1003,
+    MICROBIT_CALIBRATION_REQUIRED = -1004,
+    MICROBIT_NO_RESOURCES = -1005,
+    MICROBIT_BUSY = -1006,
+    MICROBIT_CANCELLED = -1007,
+    MICROBIT_I2C_ERROR = -1010,
+    MICROBIT_SERIAL_IN_USE = -1011,
+    MICROBIT_NO_DATA = -1012
+};
+
+enum PanicCode
+{
+    MICROBIT_OOM = 20,
+    MICROBIT_HEAP_ERROR = 30,
+    MICROBIT_NULL_DEREFERENCE = 40
+};
+
+#endif
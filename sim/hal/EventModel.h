@@ -0,0 +1,79 @@
+#ifndef EVENT_MODEL_H
+#define EVENT_MODEL_H
+
+#include <functional>
+
+#include "MicroBitConfig.h"
+#include "MicroBitEvent.h"
+
+// Listener flags, with the values of microbit-dal
+#define MESSAGE_BUS_LISTENER_REENTRANT          0x0008
+#define MESSAGE_BUS_LISTENER_QUEUE_IF_BUSY      0x0010
+#define MESSAGE_BUS_LISTENER_DROP_IF_BUSY       0x0020
+#define MESSAGE_BUS_LISTENER_NONBLOCKING        0x0040
+#define MESSAGE_BUS_LISTENER_URGENT             0x0080
+#define MESSAGE_BUS_LISTENER_DELETING           0x8000
+
+#define MESSAGE_BUS_LISTENER_IMMEDIATE          (MESSAGE_BUS_LISTENER_NONBLOCKING | MESSAGE_BUS_LISTENER_URGENT)
+
+#define EVENT_LISTENER_DEFAULT_FLAGS            MESSAGE_BUS_LISTENER_QUEUE_IF_BUSY
+
+/**
+  * Interface of an event bus: listeners are called with the events matching their
+  * id and value, MICROBIT_ID_ANY and MICROBIT_EVT_ANY matching any.
+  */
+class EventModel
+{
+    public:
+
+    static EventModel *defaultEventBus;
+
+    virtual ~EventModel()
+    {
+    }
+
+    /**
+      * Deliver an event to the matching listeners.
+      */
+    virtual int send(MicroBitEvent evt) = 0;
+
+    /**
+      * Register a listener. The object and the bytes of the handler identify it for remove().
+      */
+    virtual int add(uint16_t id, uint16_t value, const std::function<void(MicroBitEvent)> &handler, const void *object, const void *key, int keySize, uint16_t flags) = 0;
+
+    /**
+      * Remove the listener registered with the same object and handler.
+      */
+    virtual int remove(uint16_t id, uint16_t value, const void *object, const void *key, int keySize) = 0;
+
+    int listen(int id, int value, void (*handler)(MicroBitEvent), uint16_t flags = EVENT_LISTENER_DEFAULT_FLAGS)
+    {
+        if (handler == NULL)
+            return MICROBIT_INVALID_PARAMETER;
+
+        return add(id, value, handler, NULL, &handler, sizeof(handler), flags);
+    }
+
+    template <typename T>
+    int listen(uint16_t id, uint16_t value, T *object, void (T::*handler)(MicroBitEvent), uint16_t flags = EVENT_LISTENER_DEFAULT_FLAGS)
+    {
+        if (object == NULL || handler == NULL)
+            return MICROBIT_INVALID_PARAMETER;
+
+        return add(id, value, [object, handler](MicroBitEvent e) { (object->*handler)(e); }, object, &handler, sizeof(handler), flags);
+    }
+
+    int ignore(int id, int value, void (*handler)(MicroBitEvent))
+    {
+        return remove(id, value, NULL, &handler, sizeof(handler));
+    }
+
+    template <typename T>
+    int ignore(uint16_t id, uint16_t value, T *object, void (T::*handler)(MicroBitEvent))
+    {
+        return remove(id, value, object, &handler, sizeof(handler));
+    }
+};
+
+#endif
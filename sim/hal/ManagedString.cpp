@@ -0,0 +1,52 @@
+#include <stdio.h>
+
+#include "ManagedString.h"
+#include "MicroBitImage.h"
+
+ManagedString::ManagedString()
+{
+}
+
+ManagedString::ManagedString(const char *str) : s(str != NULL ? str : "")
+{
+}
+
+ManagedString::ManagedString(const char value) : s(1, value)
+{
+}
+
+ManagedString::ManagedString(const int value)
+{
+    char buffer[12];
+
+    snprintf(buffer, sizeof(buffer), "%d", value);
+    s = buffer;
+}
+
+int ManagedString::length() const
+{
+    return s.length();
+}
+
+const char *ManagedString::toCharArray() const
+{
+    return s.c_str();
+}
+
+bool ManagedString::operator==(const ManagedString &other) const
+{
+    return s == other.s;
+}
+
+MicroBitImage::MicroBitImage()
+{
+}
+
+MicroBitImage::MicroBitImage(const char *s) : s(s != NULL ? s : "")
+{
+}
+
+const char *MicroBitImage::toString() const
+{
+    return s.c_str();
+}
@@ -0,0 +1,28 @@
+#ifndef MANAGED_STRING_H
+#define MANAGED_STRING_H
+
+#include <string>
+
+#include "MicroBitConfig.h"
+
+/**
+  * Host simulation stand-in for the reference counted string of microbit-dal.
+  */
+class ManagedString
+{
+    std::string s;
+
+    public:
+
+    ManagedString();
+    ManagedString(const char *str);
+    ManagedString(const char value);
+    ManagedString(const int value);
+
+    int length() const;
+    const char *toCharArray() const;
+
+    bool operator==(const ManagedString &other) const;
+};
+
+#endif
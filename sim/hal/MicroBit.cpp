@@ -0,0 +1,47 @@
+#include "MicroBit.h"
+
+MicroBitIO::MicroBitIO() :
+    P0(MICROBIT_ID_IO_P0, MICROBIT_PIN_P0, PIN_CAPABILITY_ALL),
+    P1(MICROBIT_ID_IO_P1, MICROBIT_PIN_P1, PIN_CAPABILITY_ALL),
+    P2(MICROBIT_ID_IO_P2, MICROBIT_PIN_P2, PIN_CAPABILITY_ALL),
+    P3(MICROBIT_ID_IO_P3, MICROBIT_PIN_P3, PIN_CAPABILITY_AD),
+    P4(MICROBIT_ID_IO_P4, MICROBIT_PIN_P4, PIN_CAPABILITY_AD),
+    P5(MICROBIT_ID_IO_P5, MICROBIT_PIN_P5, PIN_CAPABILITY_DIGITAL),
+    P6(MICROBIT_ID_IO_P6, MICROBIT_PIN_P6, PIN_CAPABILITY_DIGITAL),
+    P7(MICROBIT_ID_IO_P7, MICROBIT_PIN_P7, PIN_CAPABILITY_DIGITAL),
+    P8(MICROBIT_ID_IO_P8, MICROBIT_PIN_P8, PIN_CAPABILITY_DIGITAL),
+    P9(MICROBIT_ID_IO_P9, MICROBIT_PIN_P9, PIN_CAPABILITY_DIGITAL),
+    P10(MICROBIT_ID_IO_P10, MICROBIT_PIN_P10, PIN_CAPABILITY_AD),
+    P11(MICROBIT_ID_IO_P11, MICROBIT_PIN_P11, PIN_CAPABILITY_DIGITAL),
+    P12(MICROBIT_ID_IO_P12, MICROBIT_PIN_P12, PIN_CAPABILITY_DIGITAL),
+    P13(MICROBIT_ID_IO_P13, MICROBIT_PIN_P13, PIN_CAPABILITY_DIGITAL),
+    P14(MICROBIT_ID_IO_P14, MICROBIT_PIN_P14, PIN_CAPABILITY_DIGITAL),
+    P15(MICROBIT_ID_IO_P15, MICROBIT_PIN_P15, PIN_CAPABILITY_DIGITAL),
+    P16(MICROBIT_ID_IO_P16, MICROBIT_PIN_P16, PIN_CAPABILITY_DIGITAL),
+    P19(MICROBIT_ID_IO_P19, MICROBIT_PIN_P19, PIN_CAPABILITY_DIGITAL),
+    P20(MICROBIT_ID_IO_P20, MICROBIT_PIN_P20, PIN_CAPABILITY_DIGITAL)
+{
+}
+
+MicroBit::MicroBit() :
+    buttonA(MICROBIT_ID_BUTTON_A),
+    buttonB(MICROBIT_ID_BUTTON_B),
+    ble(NULL)
+{
+}
+
+void MicroBit::init()
+{
+    if (ble == NULL)
+        ble = new BLEDevice();
+}
+
+void MicroBit::sleep(uint32_t milliseconds)
+{
+    fiber_sleep(milliseconds);
+}
+
+unsigned long MicroBit::systemTime()
+{
+    return system_timer_current_time();
+}
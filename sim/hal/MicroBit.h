@@ -0,0 +1,93 @@
+#ifndef MICROBIT_H
+#define MICROBIT_H
+
+#include "mbed.h"
+
+#include "MicroBitConfig.h"
+#include "MicroBitDevice.h"
+#include "ErrorNo.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitComponent.h"
+#include "ManagedString.h"
+#include "MicroBitImage.h"
+#include "MicroBitEvent.h"
+#include "EventModel.h"
+#include "MicroBitMessageBus.h"
+#include "MicroBitFiber.h"
+#include "MicroBitPin.h"
+#include "MicroBitButton.h"
+#include "MicroBitDisplay.h"
+#include "MicroBitThermometer.h"
+#include "MicroBitStorage.h"
+#include "MicroBitSerial.h"
+#include "MicroBitBLEManager.h"
+#include "MicroBitSimulator.h"
+
+/**
+  * The edge connector.
+  */
+class MicroBitIO
+{
+    public:
+
+    MicroBitPin P0;
+    MicroBitPin P1;
+    MicroBitPin P2;
+    MicroBitPin P3;
+    MicroBitPin P4;
+    MicroBitPin P5;
+    MicroBitPin P6;
+    MicroBitPin P7;
+    MicroBitPin P8;
+    MicroBitPin P9;
+    MicroBitPin P10;
+    MicroBitPin P11;
+    MicroBitPin P12;
+    MicroBitPin P13;
+    MicroBitPin P14;
+    MicroBitPin P15;
+    MicroBitPin P16;
+    MicroBitPin P19;
+    MicroBitPin P20;
+
+    MicroBitIO();
+};
+
+/**
+  * The micro:bit runtime, with the members of microbit-dal used by the SmartVase.
+  */
+class MicroBit
+{
+    public:
+
+    MicroBitMessageBus messageBus;
+    MicroBitStorage storage;
+    MicroBitSerial serial;
+    MicroBitDisplay display;
+    MicroBitButton buttonA;
+    MicroBitButton buttonB;
+    MicroBitIO io;
+    MicroBitThermometer thermometer;
+    BLEDevice *ble;
+
+    MicroBit();
+
+    /**
+      * Start the runtime: the BLE device is created, and the system timer starts ticking.
+      */
+    void init();
+
+    /**
+      * Sleep the calling fiber.
+      *
+      * @param milliseconds the time to sleep for.
+      */
+    void sleep(uint32_t milliseconds);
+
+    /**
+      * Milliseconds since the start.
+      */
+    unsigned long systemTime();
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef MICROBIT_BLE_MANAGER_H
+#define MICROBIT_BLE_MANAGER_H
+
+#include "MicroBitConfig.h"
+#include "ble/BLE.h"
+
+#define MICROBIT_BLE_EVT_CONNECTED          1
+#define MICROBIT_BLE_EVT_DISCONNECTED       2
+
+#endif
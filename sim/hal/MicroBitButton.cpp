@@ -0,0 +1,15 @@
+#include "MicroBitConfig.h"
+#include "MicroBitButton.h"
+#include "MicroBitEvent.h"
+
+MicroBitButton::MicroBitButton(uint16_t id)
+{
+    this->id = id;
+}
+
+void MicroBitButton::click()
+{
+    MicroBitEvent(id, MICROBIT_BUTTON_EVT_DOWN);
+    MicroBitEvent(id, MICROBIT_BUTTON_EVT_UP);
+    MicroBitEvent(id, MICROBIT_BUTTON_EVT_CLICK);
+}
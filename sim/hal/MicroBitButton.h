@@ -0,0 +1,29 @@
+#ifndef MICROBIT_BUTTON_H
+#define MICROBIT_BUTTON_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+
+#define MICROBIT_BUTTON_EVT_DOWN            1
+#define MICROBIT_BUTTON_EVT_UP              2
+#define MICROBIT_BUTTON_EVT_CLICK           3
+#define MICROBIT_BUTTON_EVT_LONG_CLICK      4
+#define MICROBIT_BUTTON_EVT_HOLD            5
+#define MICROBIT_BUTTON_EVT_DOUBLE_CLICK    6
+
+/**
+  * A push button, pressed by the simulation.
+  */
+class MicroBitButton : public MicroBitComponent
+{
+    public:
+
+    MicroBitButton(uint16_t id);
+
+    /**
+      * Press and release the button, firing the down, up and click events.
+      */
+    void click();
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef MICROBIT_COMPONENT_H
+#define MICROBIT_COMPONENT_H
+
+#include "MicroBitConfig.h"
+
+// Component ids, with the values of microbit-dal
+#define MICROBIT_ID_BUTTON_A            1
+#define MICROBIT_ID_BUTTON_B            2
+#define MICROBIT_ID_BUTTON_RESET        3
+#define MICROBIT_ID_ACCELEROMETER       4
+#define MICROBIT_ID_COMPASS             5
+#define MICROBIT_ID_DISPLAY             6
+#define MICROBIT_ID_IO_P0               7
+#define MICROBIT_ID_IO_P1               8
+#define MICROBIT_ID_IO_P2               9
+#define MICROBIT_ID_IO_P3               10
+#define MICROBIT_ID_IO_P4               11
+#define MICROBIT_ID_IO_P5               12
+#define MICROBIT_ID_IO_P6               13
+#define MICROBIT_ID_IO_P7               14
+#define MICROBIT_ID_IO_P8               15
+#define MICROBIT_ID_IO_P9               16
+#define MICROBIT_ID_IO_P10              17
+#define MICROBIT_ID_IO_P11              18
+#define MICROBIT_ID_IO_P12              19
+#define MICROBIT_ID_IO_P13              20
+#define MICROBIT_ID_IO_P14              21
+#define MICROBIT_ID_IO_P15              22
+#define MICROBIT_ID_IO_P16              23
+#define MICROBIT_ID_IO_P19              24
+#define MICROBIT_ID_IO_P20              25
+#define MICROBIT_ID_BUTTON_AB           26
+#define MICROBIT_ID_GESTURE             27
+#define MICROBIT_ID_THERMOMETER         28
+#define MICROBIT_ID_RADIO               29
+#define MICROBIT_ID_RADIO_DATA_READY    30
+#define MICROBIT_ID_MULTIBUTTON_ATTACH  31
+#define MICROBIT_ID_SERIAL              32
+#define MICROBIT_ID_IO_INT1             33
+#define MICROBIT_ID_IO_INT2             34
+#define MICROBIT_ID_IO_INT3             35
+#define MICROBIT_ID_PARTIAL_FLASHING    36
+
+#define MICROBIT_ID_MESSAGE_BUS_LISTENER    1021
+#define MICROBIT_ID_NOTIFY_ONE              1022
+#define MICROBIT_ID_NOTIFY                  1023
+
+#define MICROBIT_ID_BLE                     1000
+
+#define MICROBIT_COMPONENT_RUNNING          0x01
+
+/**
+  * Base class of the components called back by the system timer and the idle fiber.
+  */
+class MicroBitComponent
+{
+    public:
+
+    uint16_t id;
+    uint8_t status;
+
+    MicroBitComponent()
+    {
+        this->id = 0;
+        this->status = 0;
+    }
+
+    /**
+      * Callback from the system timer, in interrupt context on the device.
+      */
+    virtual void systemTick()
+    {
+    }
+
+    /**
+      * Callback from the idle fiber, once the other fibers are blocked.
+      */
+    virtual void idleTick()
+    {
+    }
+
+    /**
+      * Simulator only, not in microbit-dal: system time, in ms, of the next tick the
+      * component has work for, (uint64_t)-1 if none. While no fiber is runnable the
+      * simulation skips the ticks before the earliest one. The default asks for every tick.
+      */
+    virtual uint64_t getWakeupTime()
+    {
+        return 0;
+    }
+
+    virtual ~MicroBitComponent()
+    {
+    }
+};
+
+#endif
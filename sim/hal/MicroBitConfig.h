@@ -0,0 +1,32 @@
+#ifndef MICROBIT_CONFIG_H
+#define MICROBIT_CONFIG_H
+
+/**
+  * Host simulation stand-in for the microbit-dal configuration: the options the
+  * SmartVase firmware relies on, with the values of its config.json.
+  */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "ErrorNo.h"
+
+#define CONFIG_ENABLED(X) (X == 1)
+#define CONFIG_DISABLED(X) (X != 1)
+
+// Not in microbit-dal: set for the few places of the firmware that differ in the simulation
+#define MICROBIT_SIM                            1
+
+// Attribute table size, as set by "gatt_table_size" in config.json
+#define MICROBIT_SD_GATT_TABLE_SIZE             0x600
+
+#define MICROBIT_BLE_SECURITY_LEVEL             SECURITY_MODE_ENCRYPTION_OPEN_LINK
+
+// Period of the system tick, in ms
+#define SYSTEM_TICK_PERIOD_MS                   6
+
+// Number of components the system timer and the idle fiber can call back
+#define MICROBIT_SYSTEM_COMPONENTS              10
+#define MICROBIT_IDLE_COMPONENTS                6
+
+#endif
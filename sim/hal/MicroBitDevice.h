@@ -0,0 +1,14 @@
+#ifndef MICROBIT_DEVICE_H
+#define MICROBIT_DEVICE_H
+
+#include "MicroBitConfig.h"
+
+/**
+  * Stops the program with a status code. On the device the code is scrolled on the
+  * display forever; the simulation prints it and aborts.
+  *
+  * @param statusCode the reason of the panic.
+  */
+void microbit_panic(int statusCode);
+
+#endif
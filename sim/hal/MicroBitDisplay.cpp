@@ -0,0 +1,128 @@
+#include "MicroBitConfig.h"
+#include "MicroBitDisplay.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitEvent.h"
+#include "MicroBitSimulator.h"
+
+MicroBitDisplay::MicroBitDisplay(uint16_t id)
+{
+    this->id = id;
+    this->status = MICROBIT_COMPONENT_RUNNING;
+    this->animationEnd = 0;
+    this->animating = false;
+    this->mode = DISPLAY_MODE_BLACK_AND_WHITE;
+
+    system_timer_add_component(this);
+}
+
+void MicroBitDisplay::enable()
+{
+    status |= MICROBIT_COMPONENT_RUNNING;
+}
+
+void MicroBitDisplay::disable()
+{
+    status &= ~MICROBIT_COMPONENT_RUNNING;
+}
+
+void MicroBitDisplay::clear()
+{
+}
+
+int MicroBitDisplay::animate(uint32_t duration)
+{
+    if (animating)
+        return MICROBIT_BUSY;
+
+    animating = true;
+    animationEnd = system_timer_current_time() + duration;
+
+    return MICROBIT_OK;
+}
+
+int MicroBitDisplay::scrollAsync(ManagedString s, int delay)
+{
+    if (delay <= 0)
+        return MICROBIT_INVALID_PARAMETER;
+
+    // The text scrolls in from the right and out to the left
+    return animate((s.length() * MICROBIT_DISPLAY_SCROLL_STEPS + 5) * delay);
+}
+
+int MicroBitDisplay::scrollAsync(int number, int delay)
+{
+    return scrollAsync(ManagedString(number), delay);
+}
+
+int MicroBitDisplay::printAsync(MicroBitImage, int, int, int, int delay)
+{
+    // Without a delay the image is just shown, and no animation completes
+    if (delay <= 0)
+        return animating ? MICROBIT_BUSY : MICROBIT_OK;
+
+    return animate(delay);
+}
+
+int MicroBitDisplay::printAsync(char, int delay)
+{
+    return printAsync(MicroBitImage(), 0, 0, 0, delay);
+}
+
+void MicroBitDisplay::stopAnimation()
+{
+    if (animating)
+    {
+        animating = false;
+        MicroBitEvent(id, MICROBIT_DISPLAY_EVT_ANIMATION_COMPLETE);
+    }
+}
+
+void MicroBitDisplay::setDisplayMode(DisplayMode mode)
+{
+    this->mode = mode;
+}
+
+int MicroBitDisplay::getDisplayMode()
+{
+    return mode;
+}
+
+int MicroBitDisplay::readLightLevel()
+{
+    int sum = 0;
+
+    mode = DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE;
+
+    for (int i = 0; i < MICROBIT_LIGHT_SENSOR_CHANNELS; i++)
+        sum += sim_environment().readAnalog(MICROBIT_LIGHT_SENSOR_COLUMN_START + i);
+
+    int value = sum / MICROBIT_LIGHT_SENSOR_CHANNELS;
+
+    if (value > MICROBIT_LIGHT_SENSOR_MAX_VALUE)
+        value = MICROBIT_LIGHT_SENSOR_MAX_VALUE;
+
+    if (value < MICROBIT_LIGHT_SENSOR_MIN_VALUE)
+        value = MICROBIT_LIGHT_SENSOR_MIN_VALUE;
+
+    // The more light, the lower the voltage left on the LEDs
+    return (MICROBIT_LIGHT_SENSOR_MAX_VALUE - value) * 255 / (MICROBIT_LIGHT_SENSOR_MAX_VALUE - MICROBIT_LIGHT_SENSOR_MIN_VALUE);
+}
+
+bool MicroBitDisplay::isAnimating()
+{
+    return animating;
+}
+
+void MicroBitDisplay::systemTick()
+{
+    if (animating && system_timer_current_time() >= animationEnd)
+    {
+        animating = false;
+        MicroBitEvent(id, MICROBIT_DISPLAY_EVT_ANIMATION_COMPLETE);
+    }
+}
+
+uint64_t MicroBitDisplay::getWakeupTime()
+{
+    return animating ? animationEnd : (uint64_t)-1;
+}
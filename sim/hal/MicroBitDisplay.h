@@ -0,0 +1,77 @@
+#ifndef MICROBIT_DISPLAY_H
+#define MICROBIT_DISPLAY_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "MicroBitImage.h"
+#include "ManagedString.h"
+
+#define MICROBIT_DISPLAY_EVT_ANIMATION_COMPLETE     1
+#define MICROBIT_DISPLAY_EVT_LIGHT_SENSE            2
+
+#define MICROBIT_DEFAULT_SCROLL_SPEED               120
+#define MICROBIT_DEFAULT_PRINT_SPEED                400
+
+// Columns a character takes while scrolling: its width and a space
+#define MICROBIT_DISPLAY_SCROLL_STEPS               6
+
+// Columns of the LEDs used as a light sensor, and their readings in the dark and in full light
+#define MICROBIT_LIGHT_SENSOR_COLUMN_START          4
+#define MICROBIT_LIGHT_SENSOR_CHANNELS              3
+#define MICROBIT_LIGHT_SENSOR_MAX_VALUE             338
+#define MICROBIT_LIGHT_SENSOR_MIN_VALUE             75
+
+enum DisplayMode
+{
+    DISPLAY_MODE_BLACK_AND_WHITE,
+    DISPLAY_MODE_GREYSCALE,
+    DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE
+};
+
+/**
+  * The LED matrix. Nothing is drawn: the simulation only keeps track of whether the
+  * display runs and of the animations, that end with MICROBIT_DISPLAY_EVT_ANIMATION_COMPLETE.
+  */
+class MicroBitDisplay : public MicroBitComponent
+{
+    uint64_t animationEnd;
+    bool animating;
+    DisplayMode mode;
+
+    public:
+
+    MicroBitDisplay(uint16_t id = MICROBIT_ID_DISPLAY);
+
+    void enable();
+    void disable();
+    void clear();
+
+    int scrollAsync(ManagedString s, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
+    int scrollAsync(int number, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
+    int printAsync(MicroBitImage image, int x = 0, int y = 0, int alpha = 0, int delay = 0);
+    int printAsync(char c, int delay = 0);
+    void stopAnimation();
+
+    void setDisplayMode(DisplayMode mode);
+    int getDisplayMode();
+
+    /**
+      * Light level, 0 - 255, from the LED columns read through the environment. The device
+      * refreshes it once per display frame; here it is read on each call.
+      */
+    int readLightLevel();
+
+    /**
+      * True while a scroll or a timed print runs.
+      */
+    bool isAnimating();
+
+    virtual void systemTick();
+    virtual uint64_t getWakeupTime();
+
+    private:
+
+    int animate(uint32_t duration);
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include "MicroBitConfig.h"
+#include "MicroBitEvent.h"
+#include "MicroBitSystemTimer.h"
+#include "EventModel.h"
+
+MicroBitEvent::MicroBitEvent(uint16_t source, uint16_t value, MicroBitEventLaunchMode mode)
+{
+    this->source = source;
+    this->value = value;
+    this->timestamp = system_timer_current_time_us();
+
+    if (mode == CREATE_AND_FIRE)
+        fire();
+}
+
+MicroBitEvent::MicroBitEvent()
+{
+    this->source = 0;
+    this->value = 0;
+    this->timestamp = system_timer_current_time_us();
+}
+
+void MicroBitEvent::fire()
+{
+    if (EventModel::defaultEventBus)
+        EventModel::defaultEventBus->send(*this);
+}
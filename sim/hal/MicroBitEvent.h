@@ -0,0 +1,48 @@
+#ifndef MICROBIT_EVENT_H
+#define MICROBIT_EVENT_H
+
+#include "MicroBitConfig.h"
+
+#define MICROBIT_ID_ANY                 0
+#define MICROBIT_EVT_ANY                0
+
+enum MicroBitEventLaunchMode
+{
+    CREATE_ONLY,
+    CREATE_AND_FIRE
+};
+
+#define MICROBIT_EVENT_DEFAULT_LAUNCH_MODE CREATE_AND_FIRE
+
+/**
+  * An event on the message bus: constructing it with an id and a value fires it.
+  */
+class MicroBitEvent
+{
+    public:
+
+    uint16_t source;
+    uint16_t value;
+    uint64_t timestamp;
+
+    /**
+      * Constructor.
+      *
+      * @param source the component id raising the event.
+      * @param value the component specific event code.
+      * @param mode CREATE_AND_FIRE sends the event to the default event bus at once.
+      */
+    MicroBitEvent(uint16_t source, uint16_t value, MicroBitEventLaunchMode mode = MICROBIT_EVENT_DEFAULT_LAUNCH_MODE);
+
+    /**
+      * Default constructor: an event from MICROBIT_ID_ANY that is not fired.
+      */
+    MicroBitEvent();
+
+    /**
+      * Send the event to the default event bus.
+      */
+    void fire();
+};
+
+#endif
@@ -0,0 +1,399 @@
+/**
+  * Cooperative fibers on ucontext, and the simulation loop that plays the idle fiber.
+  */
+#include <ucontext.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MicroBitConfig.h"
+#include "MicroBitFiber.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitSimulator.h"
+
+// Host stacks are cheap: large enough for printf and deep handler chains
+#define FIBER_STACK_SIZE        (256 * 1024)
+
+uint64_t system_timer_next_tick();
+void system_timer_tick();
+void system_timer_advance(uint64_t us);
+uint64_t system_timer_wakeup_time();
+void system_timer_skip_to(uint64_t us);
+
+struct Fiber
+{
+    ucontext_t context;
+    uint8_t *stack;
+
+    void (*entry)(void *);
+    void *param;
+    void (*completion)(void *);
+
+    // Entry point and completion without a parameter
+    void (*entryVoid)(void);
+    void (*completionVoid)(void);
+
+    // System time to wake up at, in ms, while sleeping
+    uint64_t wakeTime;
+
+    // Event waited for, see fiber_wait_for_event()
+    uint16_t waitId;
+    uint16_t waitValue;
+
+    // Fiber that forked this one and waits for it to return or block, see invoke()
+    Fiber *parent;
+
+    Fiber *next;
+};
+
+// The simulation loop itself
+static Fiber idleFiber;
+
+Fiber *currentFiber = &idleFiber;
+
+static Fiber *runQueue = NULL;
+static Fiber *sleepQueue = NULL;
+static Fiber *waitQueue = NULL;
+static Fiber *finishedFibers = NULL;
+static Fiber *freeFibers = NULL;
+
+static MicroBitComponent *idleComponents[MICROBIT_IDLE_COMPONENTS];
+
+static void enqueue(Fiber **queue, Fiber *f)
+{
+    f->next = NULL;
+
+    while (*queue != NULL)
+        queue = &(*queue)->next;
+
+    *queue = f;
+}
+
+static void switchTo(Fiber *to)
+{
+    Fiber *from = currentFiber;
+
+    currentFiber = to;
+    swapcontext(&from->context, &to->context);
+}
+
+/**
+  * Give the CPU back: to the fiber that forked the current one if it waits for it, or to
+  * the simulation loop.
+  */
+static void leave()
+{
+    Fiber *f = currentFiber;
+    Fiber *to = f->parent != NULL ? f->parent : &idleFiber;
+
+    f->parent = NULL;
+    switchTo(to);
+}
+
+static void launch()
+{
+    Fiber *f = currentFiber;
+
+    if (f->entryVoid != NULL)
+        f->entryVoid();
+    else
+        f->entry(f->param);
+
+    if (f->completionVoid != NULL)
+        f->completionVoid();
+    else if (f->completion != NULL)
+        f->completion(f->param);
+
+    release_fiber();
+}
+
+static Fiber *getFiber(void (*entry)(void *), void *param, void (*completion)(void *))
+{
+    Fiber *f = freeFibers;
+
+    if (f != NULL)
+    {
+        freeFibers = f->next;
+    }
+    else
+    {
+        f = new Fiber();
+        f->stack = (uint8_t *)malloc(FIBER_STACK_SIZE);
+    }
+
+    f->entry = entry;
+    f->param = param;
+    f->completion = completion;
+    f->entryVoid = NULL;
+    f->completionVoid = NULL;
+    f->wakeTime = 0;
+    f->waitId = 0;
+    f->waitValue = 0;
+    f->parent = NULL;
+    f->next = NULL;
+
+    getcontext(&f->context);
+    f->context.uc_stack.ss_sp = f->stack;
+    f->context.uc_stack.ss_size = FIBER_STACK_SIZE;
+    f->context.uc_link = NULL;
+    makecontext(&f->context, launch, 0);
+
+    return f;
+}
+
+/**
+  * Recycle the fibers that are over. Only called from the simulation loop, off their stacks.
+  */
+static void recycle()
+{
+    while (finishedFibers != NULL)
+    {
+        Fiber *f = finishedFibers;
+        finishedFibers = f->next;
+
+        f->next = freeFibers;
+        freeFibers = f;
+    }
+}
+
+static void runQueued()
+{
+    while (runQueue != NULL)
+    {
+        Fiber *f = runQueue;
+        runQueue = f->next;
+
+        switchTo(f);
+        recycle();
+    }
+}
+
+int fiber_scheduler_running()
+{
+    return 1;
+}
+
+Fiber *create_fiber(void (*entry_fn)(void), void (*completion_fn)(void))
+{
+    Fiber *f = getFiber(NULL, NULL, NULL);
+
+    f->entryVoid = entry_fn;
+    f->completionVoid = completion_fn;
+
+    enqueue(&runQueue, f);
+
+    return f;
+}
+
+Fiber *create_fiber(void (*entry_fn)(void *), void *param, void (*completion_fn)(void *))
+{
+    Fiber *f = getFiber(entry_fn, param, completion_fn);
+
+    enqueue(&runQueue, f);
+
+    return f;
+}
+
+int invoke(void (*entry_fn)(void *), void *param)
+{
+    Fiber *f = getFiber(entry_fn, param, NULL);
+
+    f->parent = currentFiber;
+    switchTo(f);
+
+    if (currentFiber == &idleFiber)
+        recycle();
+
+    return MICROBIT_OK;
+}
+
+void release_fiber()
+{
+    if (currentFiber == &idleFiber)
+        return;
+
+    currentFiber->next = finishedFibers;
+    finishedFibers = currentFiber;
+
+    leave();
+}
+
+void fiber_sleep(unsigned long t)
+{
+    // The simulation loop cannot block: busy wait, as microbit-dal does without a scheduler
+    if (currentFiber == &idleFiber)
+    {
+        system_timer_advance((uint64_t)t * 1000);
+        return;
+    }
+
+    currentFiber->wakeTime = system_timer_current_time() + t;
+    enqueue(&sleepQueue, currentFiber);
+
+    leave();
+}
+
+void schedule()
+{
+    if (currentFiber == &idleFiber)
+        return;
+
+    enqueue(&runQueue, currentFiber);
+
+    leave();
+}
+
+int fiber_wait_for_event(uint16_t id, uint16_t value)
+{
+    if (currentFiber == &idleFiber)
+        return MICROBIT_NOT_SUPPORTED;
+
+    currentFiber->waitId = id;
+    currentFiber->waitValue = value;
+    enqueue(&waitQueue, currentFiber);
+
+    leave();
+
+    return MICROBIT_OK;
+}
+
+void scheduler_event(MicroBitEvent evt)
+{
+    Fiber **p = &waitQueue;
+
+    while (*p != NULL)
+    {
+        Fiber *f = *p;
+
+        if ((f->waitId == evt.source || f->waitId == MICROBIT_ID_ANY) && (f->waitValue == evt.value || f->waitValue == MICROBIT_EVT_ANY))
+        {
+            *p = f->next;
+            enqueue(&runQueue, f);
+        }
+        else
+        {
+            p = &f->next;
+        }
+    }
+}
+
+int fiber_add_idle_component(MicroBitComponent *component)
+{
+    int free = -1;
+
+    for (int i = 0; i < MICROBIT_IDLE_COMPONENTS; i++)
+    {
+        if (idleComponents[i] == component)
+            return MICROBIT_OK;
+
+        if (idleComponents[i] == NULL && free < 0)
+            free = i;
+    }
+
+    if (free < 0)
+    {
+        fprintf(stderr, "sim: no room for idle component %d, raise MICROBIT_IDLE_COMPONENTS\n", component->id);
+        return MICROBIT_NO_RESOURCES;
+    }
+
+    idleComponents[free] = component;
+
+    return MICROBIT_OK;
+}
+
+int fiber_remove_idle_component(MicroBitComponent *component)
+{
+    for (int i = 0; i < MICROBIT_IDLE_COMPONENTS; i++)
+    {
+        if (idleComponents[i] == component)
+        {
+            idleComponents[i] = NULL;
+            return MICROBIT_OK;
+        }
+    }
+
+    return MICROBIT_INVALID_PARAMETER;
+}
+
+/**
+  * Move the sleeping fibers that are due to the run queue, in the order they went to sleep.
+  */
+static void wakeSleepers()
+{
+    uint64_t now = system_timer_current_time();
+    Fiber **p = &sleepQueue;
+
+    while (*p != NULL)
+    {
+        Fiber *f = *p;
+
+        if (f->wakeTime <= now)
+        {
+            *p = f->next;
+            enqueue(&runQueue, f);
+        }
+        else
+        {
+            p = &f->next;
+        }
+    }
+}
+
+/**
+  * Earliest time something has to run, in ms: a sleeping fiber or a component, see
+  * MicroBitComponent::getWakeupTime().
+  */
+static uint64_t wakeupTime()
+{
+    uint64_t wakeup = system_timer_wakeup_time();
+
+    for (Fiber *f = sleepQueue; f != NULL; f = f->next)
+        if (f->wakeTime < wakeup)
+            wakeup = f->wakeTime;
+
+    for (int i = 0; i < MICROBIT_IDLE_COMPONENTS; i++)
+        if (idleComponents[i] != NULL && idleComponents[i]->getWakeupTime() < wakeup)
+            wakeup = idleComponents[i]->getWakeupTime();
+
+    return wakeup;
+}
+
+void sim_start(void (*entry)(void))
+{
+    create_fiber(entry);
+    runQueued();
+}
+
+void sim_run(uint32_t ms)
+{
+    uint64_t end = system_timer_current_time_us() + (uint64_t)ms * 1000;
+
+    while (system_timer_next_tick() <= end)
+    {
+        // Nothing runnable: the ticks before the earliest wakeup would have nothing to do
+        if (runQueue == NULL)
+        {
+            uint64_t wakeup = wakeupTime();
+
+            system_timer_skip_to(wakeup <= end / 1000 ? wakeup * 1000 : end);
+
+            if (system_timer_next_tick() > end)
+                break;
+        }
+
+        system_timer_tick();
+
+        wakeSleepers();
+        runQueued();
+
+        // Nothing else to run: the idle fiber calls back the idle components
+        for (int i = 0; i < MICROBIT_IDLE_COMPONENTS; i++)
+            if (idleComponents[i] != NULL)
+                idleComponents[i]->idleTick();
+
+        recycle();
+        runQueued();
+    }
+
+    if (system_timer_current_time_us() < end)
+        system_timer_advance(end - system_timer_current_time_us());
+}
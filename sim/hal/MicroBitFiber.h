@@ -0,0 +1,48 @@
+#ifndef MICROBIT_FIBER_H
+#define MICROBIT_FIBER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "EventModel.h"
+#include "MicroBitEvent.h"
+
+/**
+  * Cooperative fibers of the simulation, with the API of microbit-dal. Fibers run until
+  * they block (fiber_sleep(), schedule(), release_fiber() or returning); the idle fiber is
+  * the simulation loop itself, see sim_run().
+  */
+struct Fiber;
+
+extern Fiber *currentFiber;
+
+int fiber_scheduler_running();
+
+Fiber *create_fiber(void (*entry_fn)(void), void (*completion_fn)(void) = NULL);
+Fiber *create_fiber(void (*entry_fn)(void *), void *param, void (*completion_fn)(void *) = NULL);
+
+/**
+  * Run a function in a new fiber at once: the caller goes on when it returns or blocks.
+  */
+int invoke(void (*entry_fn)(void *), void *param);
+
+void release_fiber();
+
+void fiber_sleep(unsigned long t);
+
+void schedule();
+
+/**
+  * Block the current fiber until an event with this source and value is sent. Either can
+  * be MICROBIT_ID_ANY / MICROBIT_EVT_ANY.
+  */
+int fiber_wait_for_event(uint16_t id, uint16_t value);
+
+/**
+  * Wake the fibers waiting for this event. Called by the message bus on every event.
+  */
+void scheduler_event(MicroBitEvent evt);
+
+int fiber_add_idle_component(MicroBitComponent *component);
+int fiber_remove_idle_component(MicroBitComponent *component);
+
+#endif
@@ -0,0 +1,86 @@
+#include <map>
+
+#include "MicroBitConfig.h"
+#include "MicroBitFlash.h"
+
+alignas(PAGE_SIZE) static uint32_t flash[MICROBIT_SIM_FLASH_PAGES * PAGE_SIZE / 4];
+static bool erased = false;
+
+// Erases per page, by page address
+static std::map<uintptr_t, int> erases;
+
+static uintptr_t pageOf(void *address)
+{
+    return (uintptr_t)address & ~(uintptr_t)(PAGE_SIZE - 1);
+}
+
+MicroBitFlash::MicroBitFlash()
+{
+}
+
+int MicroBitFlash::flash_write(void *address, void *buffer, int length, void *)
+{
+    uint8_t *to = (uint8_t *)address;
+    uint8_t *from = (uint8_t *)buffer;
+
+    if (address == NULL || buffer == NULL || length <= 0 || pageOf(to) != pageOf(to + length - 1))
+        return MICROBIT_INVALID_PARAMETER;
+
+    bool needErase = false;
+
+    for (int i = 0; i < length; i++)
+        if (from[i] & ~to[i])
+            needErase = true;
+
+    if (needErase)
+    {
+        uint8_t copy[PAGE_SIZE];
+        uint8_t *page = (uint8_t *)pageOf(to);
+
+        memcpy(copy, page, PAGE_SIZE);
+        memcpy(copy + (to - page), from, length);
+
+        erase_page((uint32_t *)page);
+        memcpy(page, copy, PAGE_SIZE);
+    }
+    else
+    {
+        for (int i = 0; i < length; i++)
+            to[i] &= from[i];
+    }
+
+    return MICROBIT_OK;
+}
+
+void MicroBitFlash::erase_page(uint32_t *page_address)
+{
+    memset((void *)pageOf(page_address), 0xFF, PAGE_SIZE);
+    erases[pageOf(page_address)]++;
+}
+
+void MicroBitFlash::flash_burn(uint32_t *page_address, uint32_t *buffer, int size_in_words)
+{
+    for (int i = 0; i < size_in_words; i++)
+        page_address[i] &= buffer[i];
+}
+
+int MicroBitFlash::getEraseCount(void *address)
+{
+    std::map<uintptr_t, int>::iterator i = erases.find(pageOf(address));
+
+    return i == erases.end() ? 0 : i->second;
+}
+
+uint32_t *sim_flash_page(int offset)
+{
+    if (!erased)
+    {
+        memset(flash, 0xFF, sizeof(flash));
+        erased = true;
+    }
+
+    if (offset < 1 || offset > MICROBIT_SIM_FLASH_PAGES)
+        return NULL;
+
+    return flash + (MICROBIT_SIM_FLASH_PAGES - offset) * PAGE_SIZE / 4;
+}
@@ -0,0 +1,44 @@
+#ifndef MICROBIT_FLASH_H
+#define MICROBIT_FLASH_H
+
+#include "MicroBitConfig.h"
+
+// Flash page of the nRF51, in bytes
+#define PAGE_SIZE                       1024
+
+// Pages at the end of the flash the simulation holds, see sim_flash_page()
+#define MICROBIT_SIM_FLASH_PAGES        32
+
+/**
+  * Flash writes, on any memory: a write can only clear bits, and an erase sets a whole
+  * page back to 0xFF, as on the nRF51. Erases are counted per page, to check the wear.
+  */
+class MicroBitFlash
+{
+    public:
+
+    MicroBitFlash();
+
+    /**
+      * Write to flash. If bits must be set, the page is saved, erased and written back
+      * with the new data, as microbit-dal does through its scratch page.
+      */
+    int flash_write(void *address, void *buffer, int length, void *scratch_addr = NULL);
+
+    void erase_page(uint32_t *page_address);
+    void flash_burn(uint32_t *page_address, uint32_t *buffer, int size_in_words);
+
+    /**
+      * Number of erases of the page holding an address, since the start of the program.
+      */
+    static int getEraseCount(void *address);
+};
+
+/**
+  * Page at an offset from the end of the flash, as microbit-dal places its pages: held in
+  * RAM, erased at the start. Offsets run from 1 to MICROBIT_SIM_FLASH_PAGES, and pages of
+  * consecutive offsets are contiguous, the higher offset first.
+  */
+uint32_t *sim_flash_page(int offset);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef MICROBIT_IMAGE_H
+#define MICROBIT_IMAGE_H
+
+#include <string>
+
+#include "MicroBitConfig.h"
+
+/**
+  * Host simulation stand-in for MicroBitImage: keeps the source text of the image.
+  */
+class MicroBitImage
+{
+    std::string s;
+
+    public:
+
+    MicroBitImage();
+    MicroBitImage(const char *s);
+
+    const char *toString() const;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "MicroBitConfig.h"
+#include "MicroBitMessageBus.h"
+#include "MicroBitFiber.h"
+
+EventModel *EventModel::defaultEventBus = NULL;
+
+/**
+  * A listener run in its own fiber, with the event it was called for.
+  */
+struct MicroBitInvocation
+{
+    void *listener;
+    MicroBitEvent evt;
+};
+
+MicroBitMessageBus::MicroBitMessageBus()
+{
+    this->id = MICROBIT_ID_MESSAGE_BUS_LISTENER;
+
+    if (EventModel::defaultEventBus == NULL)
+        EventModel::defaultEventBus = this;
+}
+
+MicroBitMessageBus::~MicroBitMessageBus()
+{
+    if (EventModel::defaultEventBus == this)
+        EventModel::defaultEventBus = NULL;
+
+    for (size_t i = 0; i < listeners.size(); i++)
+        delete listeners[i];
+}
+
+int MicroBitMessageBus::send(MicroBitEvent evt)
+{
+    scheduler_event(evt);
+
+    // Listeners added by the handlers only get the next events
+    size_t n = listeners.size();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        Listener *l = listeners[i];
+
+        if (l->flags & MESSAGE_BUS_LISTENER_DELETING)
+            continue;
+
+        if ((l->id != evt.source && l->id != MICROBIT_ID_ANY) || (l->value != evt.value && l->value != MICROBIT_EVT_ANY))
+            continue;
+
+        if ((l->flags & MESSAGE_BUS_LISTENER_IMMEDIATE) == MESSAGE_BUS_LISTENER_IMMEDIATE)
+        {
+            l->handler(evt);
+            continue;
+        }
+
+        if (l->busy && !(l->flags & MESSAGE_BUS_LISTENER_REENTRANT))
+        {
+            if (l->flags & MESSAGE_BUS_LISTENER_QUEUE_IF_BUSY)
+                l->queue.push_back(evt);
+
+            continue;
+        }
+
+        invoke(&MicroBitMessageBus::run, new MicroBitInvocation{l, evt});
+    }
+
+    return MICROBIT_OK;
+}
+
+void MicroBitMessageBus::run(void *param)
+{
+    MicroBitInvocation *invocation = (MicroBitInvocation *)param;
+    Listener *l = (Listener *)invocation->listener;
+    MicroBitEvent evt = invocation->evt;
+
+    delete invocation;
+
+    process(l, evt);
+}
+
+void MicroBitMessageBus::process(Listener *l, MicroBitEvent evt)
+{
+    l->busy = true;
+    l->handler(evt);
+
+    while (!l->queue.empty() && !(l->flags & MESSAGE_BUS_LISTENER_DELETING))
+    {
+        MicroBitEvent next = l->queue.front();
+        l->queue.pop_front();
+        l->handler(next);
+    }
+
+    l->busy = false;
+}
+
+int MicroBitMessageBus::add(uint16_t id, uint16_t value, const std::function<void(MicroBitEvent)> &handler, const void *object, const void *key, int keySize, uint16_t flags)
+{
+    if (keySize > MICROBIT_MESSAGE_BUS_KEY_SIZE)
+        return MICROBIT_INVALID_PARAMETER;
+
+    // The same handler listening twice to the same events is ignored, as on the device
+    for (size_t i = 0; i < listeners.size(); i++)
+    {
+        Listener *l = listeners[i];
+
+        if (!(l->flags & MESSAGE_BUS_LISTENER_DELETING) && l->id == id && l->value == value && l->object == object &&
+            l->keySize == keySize && memcmp(l->key, key, keySize) == 0)
+            return MICROBIT_NOT_SUPPORTED;
+    }
+
+    Listener *l = new Listener();
+
+    l->id = id;
+    l->value = value;
+    l->flags = flags;
+    l->busy = false;
+    l->object = object;
+    memcpy(l->key, key, keySize);
+    l->keySize = keySize;
+    l->handler = handler;
+
+    listeners.push_back(l);
+
+    return MICROBIT_OK;
+}
+
+int MicroBitMessageBus::remove(uint16_t id, uint16_t value, const void *object, const void *key, int keySize)
+{
+    int removed = 0;
+
+    for (size_t i = 0; i < listeners.size(); i++)
+    {
+        Listener *l = listeners[i];
+
+        if ((id == MICROBIT_ID_ANY || l->id == id) && (value == MICROBIT_EVT_ANY || l->value == value) && l->object == object &&
+            l->keySize == keySize && memcmp(l->key, key, keySize) == 0)
+        {
+            // Freed with the bus: a fiber may still be running it
+            l->flags |= MESSAGE_BUS_LISTENER_DELETING;
+            removed++;
+        }
+    }
+
+    return removed ? MICROBIT_OK : MICROBIT_INVALID_PARAMETER;
+}
+
+int MicroBitMessageBus::count()
+{
+    int n = 0;
+
+    for (size_t i = 0; i < listeners.size(); i++)
+        if (!(listeners[i]->flags & MESSAGE_BUS_LISTENER_DELETING))
+            n++;
+
+    return n;
+}
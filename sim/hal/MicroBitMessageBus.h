@@ -0,0 +1,67 @@
+#ifndef MICROBIT_MESSAGE_BUS_H
+#define MICROBIT_MESSAGE_BUS_H
+
+#include <vector>
+#include <deque>
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "EventModel.h"
+
+// Largest handler (member function pointer) told apart by ignore()
+#define MICROBIT_MESSAGE_BUS_KEY_SIZE   16
+
+/**
+  * Event bus of the simulation, with the delivery rules of microbit-dal:
+  *
+  * - a listener runs in its own fiber, started at once: the code firing the event goes on
+  *   when the listener returns or blocks (fork on block);
+  * - a listener still running when another event arrives gets it queued
+  *   (MESSAGE_BUS_LISTENER_QUEUE_IF_BUSY) or dropped (MESSAGE_BUS_LISTENER_DROP_IF_BUSY);
+  * - MESSAGE_BUS_LISTENER_IMMEDIATE listeners are called in the context of the sender.
+  */
+class MicroBitMessageBus : public EventModel, public MicroBitComponent
+{
+    struct Listener
+    {
+        uint16_t id;
+        uint16_t value;
+        uint16_t flags;
+        bool busy;
+        const void *object;
+        uint8_t key[MICROBIT_MESSAGE_BUS_KEY_SIZE];
+        int keySize;
+        std::function<void(MicroBitEvent)> handler;
+        std::deque<MicroBitEvent> queue;
+    };
+
+    std::vector<Listener *> listeners;
+
+    public:
+
+    /**
+      * Constructor. Becomes the default event bus if there is none yet.
+      */
+    MicroBitMessageBus();
+
+    ~MicroBitMessageBus();
+
+    virtual int send(MicroBitEvent evt);
+
+    virtual int add(uint16_t id, uint16_t value, const std::function<void(MicroBitEvent)> &handler, const void *object, const void *key, int keySize, uint16_t flags);
+
+    virtual int remove(uint16_t id, uint16_t value, const void *object, const void *key, int keySize);
+
+    /**
+      * Number of listeners registered.
+      */
+    int count();
+
+    private:
+
+    static void run(void *param);
+
+    static void process(Listener *l, MicroBitEvent evt);
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "MicroBitConfig.h"
+#include "MicroBitPin.h"
+#include "MicroBitSimulator.h"
+
+MicroBitPin::MicroBitPin(int id, PinName name, PinCapability capability)
+{
+    this->id = id;
+    this->name = name;
+    this->capability = capability;
+}
+
+int MicroBitPin::setDigitalValue(int value)
+{
+    if (value < 0 || value > 1)
+        return MICROBIT_INVALID_PARAMETER;
+
+    sim_environment().writeDigital(name, value);
+
+    return MICROBIT_OK;
+}
+
+int MicroBitPin::getDigitalValue()
+{
+    return sim_environment().readDigital(name);
+}
+
+int MicroBitPin::setAnalogValue(int value)
+{
+    if (!(capability & PIN_CAPABILITY_ANALOG))
+        return MICROBIT_NOT_SUPPORTED;
+
+    if (value < 0 || value > MICROBIT_PIN_MAX_OUTPUT)
+        return MICROBIT_INVALID_PARAMETER;
+
+    sim_environment().writeAnalog(name, value);
+
+    return MICROBIT_OK;
+}
+
+int MicroBitPin::getAnalogValue()
+{
+    if (!(capability & PIN_CAPABILITY_ANALOG))
+        return MICROBIT_NOT_SUPPORTED;
+
+    int value = sim_environment().readAnalog(name);
+
+    if (value < 0)
+        return 0;
+
+    if (value > 1023)
+        return 1023;
+
+    return value;
+}
+
+int MicroBitPin::setPull(PinMode)
+{
+    return MICROBIT_OK;
+}
@@ -0,0 +1,60 @@
+#ifndef MICROBIT_PIN_H
+#define MICROBIT_PIN_H
+
+#include "mbed.h"
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+
+// Edge connector pins, as nRF51 GPIO numbers
+#define MICROBIT_PIN_P0                 p3
+#define MICROBIT_PIN_P1                 p2
+#define MICROBIT_PIN_P2                 p1
+#define MICROBIT_PIN_P3                 p4
+#define MICROBIT_PIN_P4                 p5
+#define MICROBIT_PIN_P5                 p17
+#define MICROBIT_PIN_P6                 p12
+#define MICROBIT_PIN_P7                 p11
+#define MICROBIT_PIN_P8                 p18
+#define MICROBIT_PIN_P9                 p10
+#define MICROBIT_PIN_P10                p6
+#define MICROBIT_PIN_P11                p26
+#define MICROBIT_PIN_P12                p20
+#define MICROBIT_PIN_P13                p23
+#define MICROBIT_PIN_P14                p22
+#define MICROBIT_PIN_P15                p21
+#define MICROBIT_PIN_P16                p16
+#define MICROBIT_PIN_P19                p0
+#define MICROBIT_PIN_P20                p30
+
+// Largest value of the analog inputs and outputs
+#define MICROBIT_PIN_MAX_OUTPUT         1023
+
+enum PinCapability
+{
+    PIN_CAPABILITY_DIGITAL = 0x01,
+    PIN_CAPABILITY_ANALOG = 0x02,
+    PIN_CAPABILITY_AD = PIN_CAPABILITY_DIGITAL | PIN_CAPABILITY_ANALOG,
+    PIN_CAPABILITY_ALL = PIN_CAPABILITY_AD
+};
+
+/**
+  * An edge connector pin, read from and written to the simulated environment.
+  */
+class MicroBitPin : public MicroBitComponent
+{
+    PinCapability capability;
+
+    public:
+
+    PinName name;
+
+    MicroBitPin(int id, PinName name, PinCapability capability);
+
+    int setDigitalValue(int value);
+    int getDigitalValue();
+    int setAnalogValue(int value);
+    int getAnalogValue();
+    int setPull(PinMode pull);
+};
+
+#endif
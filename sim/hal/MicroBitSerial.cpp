@@ -0,0 +1,35 @@
+#include <stdarg.h>
+
+#include "MicroBitSerial.h"
+
+MicroBitSerial::MicroBitSerial()
+{
+    output = stdout;
+}
+
+int MicroBitSerial::printf(const char *format, ...)
+{
+    if (output == NULL)
+        return MICROBIT_OK;
+
+    va_list args;
+
+    va_start(args, format);
+    vfprintf(output, format, args);
+    va_end(args);
+
+    return MICROBIT_OK;
+}
+
+int MicroBitSerial::send(ManagedString s)
+{
+    if (output != NULL)
+        fputs(s.toCharArray(), output);
+
+    return s.length();
+}
+
+void MicroBitSerial::setOutput(FILE *output)
+{
+    this->output = output;
+}
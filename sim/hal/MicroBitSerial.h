@@ -0,0 +1,29 @@
+#ifndef MICROBIT_SERIAL_H
+#define MICROBIT_SERIAL_H
+
+#include <stdio.h>
+
+#include "MicroBitConfig.h"
+#include "ManagedString.h"
+
+/**
+  * The USB serial port: what is sent is written to a host stream, stdout by default.
+  */
+class MicroBitSerial
+{
+    FILE *output;
+
+    public:
+
+    MicroBitSerial();
+
+    int printf(const char *format, ...);
+    int send(ManagedString s);
+
+    /**
+      * Redirect the output, NULL to discard it.
+      */
+    void setOutput(FILE *output);
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MicroBitConfig.h"
+#include "MicroBitSimulator.h"
+#include "MicroBitDevice.h"
+
+// The firmware drives its pins from static constructors: the default environment is
+// built on first use
+static MicroBitSimEnvironment *environment = NULL;
+
+static MicroBitSimEnvironment &defaultEnvironment()
+{
+    static MicroBitSimEnvironment e;
+    return e;
+}
+
+MicroBitSimEnvironment::MicroBitSimEnvironment()
+{
+    for (int i = 0; i < MICROBIT_SIM_PIN_COUNT; i++)
+    {
+        analogIn[i] = 0;
+        digitalIn[i] = 0;
+        digitalOut[i] = 0;
+        analogOut[i] = 0;
+    }
+
+    temperature = 20;
+}
+
+int MicroBitSimEnvironment::readAnalog(int pin)
+{
+    return analogIn[pin];
+}
+
+int MicroBitSimEnvironment::readDigital(int pin)
+{
+    return digitalIn[pin];
+}
+
+void MicroBitSimEnvironment::writeDigital(int pin, int value)
+{
+    digitalOut[pin] = value;
+}
+
+void MicroBitSimEnvironment::writeAnalog(int pin, int value)
+{
+    analogOut[pin] = value;
+}
+
+int MicroBitSimEnvironment::readTemperature()
+{
+    return temperature;
+}
+
+void MicroBitSimEnvironment::update(uint64_t)
+{
+}
+
+void sim_set_environment(MicroBitSimEnvironment *e)
+{
+    environment = e;
+}
+
+MicroBitSimEnvironment &sim_environment()
+{
+    return environment != NULL ? *environment : defaultEnvironment();
+}
+
+void microbit_panic(int statusCode)
+{
+    fprintf(stderr, "microbit_panic(%d)\n", statusCode);
+    abort();
+}
@@ -0,0 +1,79 @@
+#ifndef MICROBIT_SIMULATOR_H
+#define MICROBIT_SIMULATOR_H
+
+#include "MicroBitConfig.h"
+
+// GPIO of the nRF51
+#define MICROBIT_SIM_PIN_COUNT          32
+
+/**
+  * The world around the simulated micro:bit. The default keeps the values set in its
+  * fields; models derive from it to compute them, e.g. a probe reading that follows the
+  * water given by a pump.
+  */
+class MicroBitSimEnvironment
+{
+    public:
+
+    // Value read by an analog input, 0 - 1023
+    int analogIn[MICROBIT_SIM_PIN_COUNT];
+
+    // Level read by a digital input
+    int digitalIn[MICROBIT_SIM_PIN_COUNT];
+
+    // Last level or PWM value written by an output
+    int digitalOut[MICROBIT_SIM_PIN_COUNT];
+    int analogOut[MICROBIT_SIM_PIN_COUNT];
+
+    // Die temperature, in degrees Celsius
+    int temperature;
+
+    MicroBitSimEnvironment();
+
+    virtual ~MicroBitSimEnvironment()
+    {
+    }
+
+    virtual int readAnalog(int pin);
+    virtual int readDigital(int pin);
+    virtual void writeDigital(int pin, int value);
+    virtual void writeAnalog(int pin, int value);
+    virtual int readTemperature();
+
+    /**
+      * Called on every system tick that is run, before the components, to move the world
+      * forward. Skipped ticks make longer steps.
+      *
+      * @param now the system time, in ms.
+      */
+    virtual void update(uint64_t now);
+};
+
+/**
+  * Replace the environment, NULL for the default one.
+  */
+void sim_set_environment(MicroBitSimEnvironment *environment);
+
+MicroBitSimEnvironment &sim_environment();
+
+/**
+  * Run a function in a fiber, as main() on the device. It runs until it blocks.
+  */
+void sim_start(void (*entry)(void));
+
+/**
+  * Run the simulation for a time: on every system tick the environment, the system
+  * timer components, the fibers that are due and the idle components are run in turn.
+  * While no fiber is runnable, the ticks before the earliest wakeup of the sleeping fibers
+  * and the components are skipped, see MicroBitComponent::getWakeupTime().
+  *
+  * @param ms the virtual time to run for, in milliseconds.
+  */
+void sim_run(uint32_t ms);
+
+/**
+  * Number of system ticks run so far.
+  */
+uint64_t sim_ticks();
+
+#endif
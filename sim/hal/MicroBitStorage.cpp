@@ -0,0 +1,54 @@
+#include "MicroBitConfig.h"
+#include "MicroBitStorage.h"
+
+MicroBitStorage::MicroBitStorage()
+{
+    writes = 0;
+}
+
+int MicroBitStorage::put(const char *key, uint8_t *data, int dataSize)
+{
+    if (key == NULL || data == NULL || dataSize < 0 || dataSize > MICROBIT_STORAGE_VALUE_SIZE || strlen(key) >= MICROBIT_STORAGE_KEY_SIZE)
+        return MICROBIT_INVALID_PARAMETER;
+
+    KeyValuePair pair;
+
+    memset(&pair, 0, sizeof(pair));
+    memcpy(pair.key, key, strlen(key));
+    memcpy(pair.value, data, dataSize);
+
+    pairs[key] = pair;
+    writes++;
+
+    return MICROBIT_OK;
+}
+
+KeyValuePair *MicroBitStorage::get(const char *key)
+{
+    std::map<std::string, KeyValuePair>::iterator i = pairs.find(key);
+
+    if (i == pairs.end())
+        return NULL;
+
+    return new KeyValuePair(i->second);
+}
+
+int MicroBitStorage::remove(const char *key)
+{
+    if (pairs.erase(key) == 0)
+        return MICROBIT_NO_DATA;
+
+    writes++;
+
+    return MICROBIT_OK;
+}
+
+int MicroBitStorage::size()
+{
+    return pairs.size();
+}
+
+int MicroBitStorage::getWriteCount()
+{
+    return writes;
+}
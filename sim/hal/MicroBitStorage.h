@@ -0,0 +1,43 @@
+#ifndef MICROBIT_STORAGE_H
+#define MICROBIT_STORAGE_H
+
+#include <map>
+#include <string>
+
+#include "MicroBitConfig.h"
+
+#define MICROBIT_STORAGE_KEY_SIZE           16
+#define MICROBIT_STORAGE_VALUE_SIZE         32
+#define MICROBIT_STORAGE_STORE_PAGE_OFFSET  17
+
+struct KeyValuePair
+{
+    uint8_t key[MICROBIT_STORAGE_KEY_SIZE];
+    uint8_t value[MICROBIT_STORAGE_VALUE_SIZE];
+};
+
+/**
+  * Key value store, held in RAM instead of the flash page. get() returns a copy that the
+  * caller deletes, as on the device.
+  */
+class MicroBitStorage
+{
+    std::map<std::string, KeyValuePair> pairs;
+    int writes;
+
+    public:
+
+    MicroBitStorage();
+
+    int put(const char *key, uint8_t *data, int dataSize);
+    KeyValuePair *get(const char *key);
+    int remove(const char *key);
+    int size();
+
+    /**
+      * Number of put() and remove() calls, each one a flash page rewrite on the device.
+      */
+    int getWriteCount();
+};
+
+#endif
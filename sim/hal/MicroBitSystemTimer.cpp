@@ -0,0 +1,163 @@
+/**
+  * Virtual time of the simulation, and the components called on every system tick.
+  */
+#include "MicroBitConfig.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitSimulator.h"
+#include "mbed.h"
+
+static uint64_t current_time_us = 0;
+static uint64_t next_tick_us = SYSTEM_TICK_PERIOD_MS * 1000;
+static uint64_t ticks = 0;
+static int tick_period_ms = SYSTEM_TICK_PERIOD_MS;
+
+static MicroBitComponent *systemTickComponents[MICROBIT_SYSTEM_COMPONENTS];
+
+uint64_t system_timer_current_time()
+{
+    return current_time_us / 1000;
+}
+
+uint64_t system_timer_current_time_us()
+{
+    return current_time_us;
+}
+
+int system_timer_set_period(int period)
+{
+    if (period < 1)
+        return MICROBIT_INVALID_PARAMETER;
+
+    next_tick_us += ((int64_t)period - tick_period_ms) * 1000;
+    tick_period_ms = period;
+
+    return MICROBIT_OK;
+}
+
+int system_timer_get_period()
+{
+    return tick_period_ms;
+}
+
+int system_timer_add_component(MicroBitComponent *component)
+{
+    int free = -1;
+
+    for (int i = 0; i < MICROBIT_SYSTEM_COMPONENTS; i++)
+    {
+        if (systemTickComponents[i] == component)
+            return MICROBIT_OK;
+
+        if (systemTickComponents[i] == NULL && free < 0)
+            free = i;
+    }
+
+    if (free < 0)
+        return MICROBIT_NO_RESOURCES;
+
+    systemTickComponents[free] = component;
+
+    return MICROBIT_OK;
+}
+
+int system_timer_remove_component(MicroBitComponent *component)
+{
+    for (int i = 0; i < MICROBIT_SYSTEM_COMPONENTS; i++)
+    {
+        if (systemTickComponents[i] == component)
+        {
+            systemTickComponents[i] = NULL;
+            return MICROBIT_OK;
+        }
+    }
+
+    return MICROBIT_INVALID_PARAMETER;
+}
+
+/**
+  * Time of the next system tick, in us.
+  */
+uint64_t system_timer_next_tick()
+{
+    return next_tick_us;
+}
+
+/**
+  * Run the next system tick: time moves to it (or it runs late, if a busy wait went past it), then
+  * the environment and the system timer components are updated.
+  */
+void system_timer_tick()
+{
+    if (current_time_us < next_tick_us)
+        current_time_us = next_tick_us;
+
+    next_tick_us = current_time_us + tick_period_ms * 1000;
+    ticks++;
+
+    sim_environment().update(system_timer_current_time());
+
+    for (int i = 0; i < MICROBIT_SYSTEM_COMPONENTS; i++)
+        if (systemTickComponents[i] != NULL)
+            systemTickComponents[i]->systemTick();
+}
+
+/**
+  * Earliest wakeup time of the system timer components, in ms, see
+  * MicroBitComponent::getWakeupTime().
+  */
+uint64_t system_timer_wakeup_time()
+{
+    uint64_t wakeup = (uint64_t)-1;
+
+    for (int i = 0; i < MICROBIT_SYSTEM_COMPONENTS; i++)
+        if (systemTickComponents[i] != NULL && systemTickComponents[i]->getWakeupTime() < wakeup)
+            wakeup = systemTickComponents[i]->getWakeupTime();
+
+    return wakeup;
+}
+
+/**
+  * Skip the system ticks before a time: the next tick is the first one at or after it.
+  * Neither the environment nor the components are called for the skipped ticks.
+  */
+void system_timer_skip_to(uint64_t us)
+{
+    uint64_t period = (uint64_t)tick_period_ms * 1000;
+
+    if (us > next_tick_us)
+        next_tick_us += (us - next_tick_us + period - 1) / period * period;
+}
+
+/**
+  * Move the time forward without running the system tick.
+  */
+void system_timer_advance(uint64_t us)
+{
+    current_time_us += us;
+}
+
+uint64_t sim_ticks()
+{
+    return ticks;
+}
+
+void wait_us(int us)
+{
+    if (us > 0)
+        system_timer_advance(us);
+}
+
+void wait_ms(int ms)
+{
+    wait_us(ms * 1000);
+}
+
+void wait(float s)
+{
+    wait_us((int)(s * 1000000));
+}
+
+uint32_t us_ticker_read()
+{
+    return (uint32_t)current_time_us;
+}
@@ -0,0 +1,20 @@
+#ifndef MICROBIT_SYSTEM_TIMER_H
+#define MICROBIT_SYSTEM_TIMER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+
+/**
+  * Virtual system time: it only advances when the simulation runs, see sim_run(), and
+  * during busy waits.
+  */
+uint64_t system_timer_current_time();
+uint64_t system_timer_current_time_us();
+
+int system_timer_set_period(int period);
+int system_timer_get_period();
+
+int system_timer_add_component(MicroBitComponent *component);
+int system_timer_remove_component(MicroBitComponent *component);
+
+#endif
@@ -0,0 +1,39 @@
+#include "MicroBitConfig.h"
+#include "MicroBitTemperatureService.h"
+#include "EventModel.h"
+
+MicroBitTemperatureService::MicroBitTemperatureService(BLEDevice &_ble, MicroBitThermometer &_thermometer) :
+        ble(_ble), thermometer(_thermometer)
+{
+    GattCharacteristic  temperatureDataCharacteristic(MicroBitTemperatureServiceDataUUID, (uint8_t *)&temperatureDataCharacteristicBuffer, 0,
+    sizeof(temperatureDataCharacteristicBuffer), GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+
+    temperatureDataCharacteristicBuffer = 0;
+
+    GattCharacteristic *characteristics[] = {&temperatureDataCharacteristic};
+    GattService         service(MicroBitTemperatureServiceUUID, characteristics, sizeof(characteristics) / sizeof(GattCharacteristic *));
+
+    ble.addService(service);
+
+    temperatureDataCharacteristicHandle = temperatureDataCharacteristic.getValueHandle();
+
+    if (EventModel::defaultEventBus)
+        EventModel::defaultEventBus->listen(MICROBIT_ID_THERMOMETER, MICROBIT_THERMOMETER_EVT_UPDATE, this, &MicroBitTemperatureService::temperatureUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+}
+
+void MicroBitTemperatureService::temperatureUpdate(MicroBitEvent)
+{
+    if (ble.getGapState().connected)
+    {
+        temperatureDataCharacteristicBuffer = thermometer.getTemperature();
+        ble.gattServer().notify(temperatureDataCharacteristicHandle, (uint8_t *)&temperatureDataCharacteristicBuffer, sizeof(temperatureDataCharacteristicBuffer));
+    }
+}
+
+const uint8_t  MicroBitTemperatureServiceUUID[] = {
+    0xe9,0x5d,0x61,0x00,0x25,0x1d,0x47,0x0a,0xa0,0x62,0xfa,0x19,0x22,0xdf,0xa9,0xa8
+};
+
+const uint8_t  MicroBitTemperatureServiceDataUUID[] = {
+    0xe9,0x5d,0x92,0x50,0x25,0x1d,0x47,0x0a,0xa0,0x62,0xfa,0x19,0x22,0xdf,0xa9,0xa8
+};
@@ -0,0 +1,33 @@
+#ifndef MICROBIT_TEMPERATURE_SERVICE_H
+#define MICROBIT_TEMPERATURE_SERVICE_H
+
+#include "MicroBitConfig.h"
+#include "ble/BLE.h"
+#include "MicroBitThermometer.h"
+#include "MicroBitEvent.h"
+
+/**
+  * The temperature service of microbit-dal: notifies every thermometer update.
+  */
+class MicroBitTemperatureService
+{
+    public:
+
+    MicroBitTemperatureService(BLEDevice &_ble, MicroBitThermometer &_thermometer);
+
+    private:
+
+    void temperatureUpdate(MicroBitEvent e);
+
+    BLEDevice &ble;
+    MicroBitThermometer &thermometer;
+
+    int8_t temperatureDataCharacteristicBuffer;
+
+    GattAttribute::Handle_t temperatureDataCharacteristicHandle;
+};
+
+extern const uint8_t MicroBitTemperatureServiceUUID[];
+extern const uint8_t MicroBitTemperatureServiceDataUUID[];
+
+#endif
@@ -0,0 +1,74 @@
+#include "MicroBitConfig.h"
+#include "MicroBitThermometer.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitFiber.h"
+#include "MicroBitEvent.h"
+#include "MicroBitSimulator.h"
+
+MicroBitThermometer::MicroBitThermometer(uint16_t id)
+{
+    this->id = id;
+    this->samplePeriod = MICROBIT_THERMOMETER_PERIOD;
+    this->sampleTime = 0;
+    this->temperature = 0;
+    this->offset = 0;
+}
+
+void MicroBitThermometer::setPeriod(int period)
+{
+    updateSample();
+    samplePeriod = period;
+}
+
+int MicroBitThermometer::getPeriod()
+{
+    return samplePeriod;
+}
+
+int MicroBitThermometer::setCalibration(int calibrationTemp)
+{
+    updateSample();
+    offset = temperature - calibrationTemp;
+
+    return MICROBIT_OK;
+}
+
+int MicroBitThermometer::getCalibration()
+{
+    return offset;
+}
+
+int MicroBitThermometer::getTemperature()
+{
+    updateSample();
+    return temperature - offset;
+}
+
+int MicroBitThermometer::updateSample()
+{
+    if (!(status & MICROBIT_THERMOMETER_ADDED_TO_IDLE))
+    {
+        fiber_add_idle_component(this);
+        status |= MICROBIT_THERMOMETER_ADDED_TO_IDLE;
+    }
+
+    if (system_timer_current_time() >= sampleTime)
+    {
+        temperature = sim_environment().readTemperature();
+        sampleTime = system_timer_current_time() + samplePeriod;
+
+        MicroBitEvent e(id, MICROBIT_THERMOMETER_EVT_UPDATE);
+    }
+
+    return MICROBIT_OK;
+}
+
+void MicroBitThermometer::idleTick()
+{
+    updateSample();
+}
+
+uint64_t MicroBitThermometer::getWakeupTime()
+{
+    return sampleTime;
+}
@@ -0,0 +1,39 @@
+#ifndef MICROBIT_THERMOMETER_H
+#define MICROBIT_THERMOMETER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+
+#define MICROBIT_THERMOMETER_PERIOD             1000
+
+#define MICROBIT_THERMOMETER_EVT_UPDATE         1
+
+#define MICROBIT_THERMOMETER_ADDED_TO_IDLE      2
+
+/**
+  * The temperature sensor of the nRF51, read from the simulated environment. Sampled in
+  * the background once read, firing MICROBIT_THERMOMETER_EVT_UPDATE with every sample.
+  */
+class MicroBitThermometer : public MicroBitComponent
+{
+    uint64_t sampleTime;
+    uint32_t samplePeriod;
+    int16_t temperature;
+    int16_t offset;
+
+    public:
+
+    MicroBitThermometer(uint16_t id = MICROBIT_ID_THERMOMETER);
+
+    void setPeriod(int period);
+    int getPeriod();
+    int setCalibration(int calibrationTemp);
+    int getCalibration();
+    int getTemperature();
+    int updateSample();
+
+    virtual void idleTick();
+    virtual uint64_t getWakeupTime();
+};
+
+#endif
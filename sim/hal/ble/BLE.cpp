@@ -0,0 +1,240 @@
+#include "ble/BLE.h"
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "MicroBitEvent.h"
+#include "MicroBitBLEManager.h"
+
+GattCharacteristic::GattCharacteristic(const UUID &uuid, uint8_t *valuePtr, uint16_t len, uint16_t maxLen, uint8_t props,
+                                       GattAttribute *[], unsigned, bool) :
+    uuid(uuid), valuePtr(valuePtr), len(len), maxLen(maxLen), props(props), valueHandle(0)
+{
+}
+
+void GattCharacteristic::requireSecurity(SecurityManager::SecurityMode_t)
+{
+}
+
+GattAttribute::Handle_t GattCharacteristic::getValueHandle() const
+{
+    return valueHandle;
+}
+
+GattService::GattService(const UUID &uuid, GattCharacteristic *characteristics[], unsigned numCharacteristics) :
+    uuid(uuid), characteristics(characteristics), numCharacteristics(numCharacteristics)
+{
+}
+
+GattServer::GattServer()
+{
+    pending = 0;
+    connected = false;
+
+    // Attributes of the runtime services
+    attributes.resize(BLE_SIM_FIRST_HANDLE);
+}
+
+/**
+  * Lay the service out as in a GATT table: a service declaration, then for each
+  * characteristic a declaration, the value, and a descriptor to enable notifications.
+  */
+ble_error_t GattServer::addService(GattService &service)
+{
+    Attribute declaration = { service.uuid, 0, std::vector<uint8_t>(), 0 };
+
+    attributes.push_back(declaration);
+
+    for (unsigned i = 0; i < service.numCharacteristics; i++)
+    {
+        GattCharacteristic *c = service.characteristics[i];
+
+        attributes.push_back(declaration);
+
+        c->valueHandle = attributes.size() + 1;
+
+        Attribute value = { c->uuid, c->props, std::vector<uint8_t>(c->valuePtr, c->valuePtr + c->len), c->maxLen };
+        attributes.push_back(value);
+
+        if (c->props & (GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_INDICATE))
+            attributes.push_back(declaration);
+    }
+
+    return BLE_ERROR_NONE;
+}
+
+GattServer::Attribute *GattServer::find(GattAttribute::Handle_t handle)
+{
+    if (handle == 0 || handle > attributes.size())
+        return NULL;
+
+    return &attributes[handle - 1];
+}
+
+ble_error_t GattServer::write(GattAttribute::Handle_t handle, const uint8_t *value, uint16_t size, bool localOnly)
+{
+    Attribute *a = find(handle);
+
+    if (a == NULL)
+        return BLE_ERROR_INVALID_PARAM;
+
+    if (size > a->maxLen)
+        return BLE_ERROR_BUFFER_OVERFLOW;
+
+    // As the stack does, the new value is also notified to the connected peer
+    if (!localOnly && connected && (a->props & GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY))
+        return notify(handle, value, size);
+
+    a->value.assign(value, value + size);
+
+    return BLE_ERROR_NONE;
+}
+
+ble_error_t GattServer::read(GattAttribute::Handle_t handle, uint8_t *buffer, uint16_t *lengthP)
+{
+    Attribute *a = find(handle);
+
+    if (a == NULL)
+        return BLE_ERROR_INVALID_PARAM;
+
+    if (a->value.size() > *lengthP)
+        return BLE_ERROR_BUFFER_OVERFLOW;
+
+    memcpy(buffer, a->value.data(), a->value.size());
+    *lengthP = a->value.size();
+
+    return BLE_ERROR_NONE;
+}
+
+ble_error_t GattServer::notify(GattAttribute::Handle_t handle, const uint8_t *value, uint16_t size)
+{
+    Attribute *a = find(handle);
+
+    if (a == NULL || !(a->props & GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY))
+        return BLE_ERROR_INVALID_PARAM;
+
+    if (pending >= BLE_SIM_TX_BUFFERS)
+        return BLE_ERROR_NO_MEM;
+
+    if (size > a->maxLen)
+        return BLE_ERROR_BUFFER_OVERFLOW;
+
+    a->value.assign(value, value + size);
+
+    Notification n = { handle, a->value };
+    notifications.push_back(n);
+    pending++;
+
+    return BLE_ERROR_NONE;
+}
+
+void GattServer::onDataWritten(void (*callback)(const GattWriteCallbackParams *params))
+{
+    dataWrittenCallbacks.push_back(callback);
+}
+
+void GattServer::onDataSent(void (*callback)(unsigned count))
+{
+    dataSentCallbacks.push_back(callback);
+}
+
+GattAttribute::Handle_t GattServer::findCharacteristic(const UUID &uuid)
+{
+    for (size_t i = BLE_SIM_FIRST_HANDLE; i < attributes.size(); i++)
+        if (attributes[i].props != 0 && attributes[i].uuid == uuid)
+            return i + 1;
+
+    return 0;
+}
+
+std::vector<GattServer::Notification> &GattServer::getNotifications()
+{
+    return notifications;
+}
+
+BLE::BLE()
+{
+    state.advertising = 1;
+    state.connected = 0;
+}
+
+ble_error_t BLE::addService(GattService &service)
+{
+    return server.addService(service);
+}
+
+GattServer &BLE::gattServer()
+{
+    return server;
+}
+
+Gap::GapState_t BLE::getGapState() const
+{
+    return state;
+}
+
+void BLE::onDataWritten(void (*callback)(const GattWriteCallbackParams *params))
+{
+    server.onDataWritten(callback);
+}
+
+void BLE::simulateConnect()
+{
+    state.connected = 1;
+    state.advertising = 0;
+    server.connected = true;
+
+    MicroBitEvent(MICROBIT_ID_BLE, MICROBIT_BLE_EVT_CONNECTED);
+}
+
+void BLE::simulateDisconnect()
+{
+    state.connected = 0;
+    state.advertising = 1;
+    server.connected = false;
+    server.pending = 0;
+
+    MicroBitEvent(MICROBIT_ID_BLE, MICROBIT_BLE_EVT_DISCONNECTED);
+}
+
+ble_error_t BLE::simulateWrite(GattAttribute::Handle_t handle, const uint8_t *data, uint16_t len)
+{
+    GattServer::Attribute *a = server.find(handle);
+
+    if (a == NULL || !(a->props & (GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE_WITHOUT_RESPONSE)))
+        return BLE_ERROR_INVALID_PARAM;
+
+    if (len > a->maxLen)
+        return BLE_ERROR_BUFFER_OVERFLOW;
+
+    a->value.assign(data, data + len);
+
+    // The handlers may write the attribute: hand them a copy
+    std::vector<uint8_t> written(data, data + len);
+    GattWriteCallbackParams params;
+
+    params.connHandle = 0;
+    params.handle = handle;
+    params.writeOp = GattWriteCallbackParams::OP_WRITE_REQ;
+    params.offset = 0;
+    params.len = len;
+    params.data = written.data();
+
+    for (size_t i = 0; i < server.dataWrittenCallbacks.size(); i++)
+        server.dataWrittenCallbacks[i](&params);
+
+    return BLE_ERROR_NONE;
+}
+
+unsigned BLE::simulateDataSent()
+{
+    unsigned count = server.pending;
+
+    if (count == 0)
+        return 0;
+
+    server.pending = 0;
+
+    for (size_t i = 0; i < server.dataSentCallbacks.size(); i++)
+        server.dataSentCallbacks[i](count);
+
+    return count;
+}
@@ -0,0 +1,272 @@
+#ifndef BLE_H
+#define BLE_H
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#include "ble/UUID.h"
+
+/**
+  * Host simulation stand-in for the mbed BLE API: a GATT server keeping the attribute
+  * values in RAM, and a simulated peer that connects, writes and receives notifications.
+  */
+
+enum ble_error_t
+{
+    BLE_ERROR_NONE = 0,
+    BLE_ERROR_BUFFER_OVERFLOW = 1,
+    BLE_ERROR_NOT_IMPLEMENTED = 2,
+    BLE_ERROR_PARAM_OUT_OF_RANGE = 3,
+    BLE_ERROR_INVALID_PARAM = 4,
+    BLE_STACK_BUSY = 5,
+    BLE_ERROR_INVALID_STATE = 6,
+    BLE_ERROR_NO_MEM = 7,
+    BLE_ERROR_OPERATION_NOT_PERMITTED = 8,
+    BLE_ERROR_INITIALIZATION_INCOMPLETE = 9,
+    BLE_ERROR_ALREADY_INITIALIZED = 10,
+    BLE_ERROR_UNSPECIFIED = 11,
+    BLE_ERROR_INTERNAL_STACK_FAILURE = 12
+};
+
+// Notifications the radio can hold until they are sent
+#define BLE_SIM_TX_BUFFERS              6
+
+// First handle of the application services, after the ones of the runtime
+#define BLE_SIM_FIRST_HANDLE            0x000C
+
+struct GattAttribute
+{
+    typedef uint16_t Handle_t;
+};
+
+struct GattWriteCallbackParams
+{
+    enum WriteOp_t
+    {
+        OP_INVALID = 0x00,
+        OP_WRITE_REQ = 0x01,
+        OP_WRITE_CMD = 0x02
+    };
+
+    uint16_t connHandle;
+    GattAttribute::Handle_t handle;
+    WriteOp_t writeOp;
+    uint16_t offset;
+    uint16_t len;
+    const uint8_t *data;
+};
+
+class SecurityManager
+{
+    public:
+
+    enum SecurityMode_t
+    {
+        SECURITY_MODE_NO_ACCESS,
+        SECURITY_MODE_ENCRYPTION_OPEN_LINK,
+        SECURITY_MODE_ENCRYPTION_NO_MITM,
+        SECURITY_MODE_ENCRYPTION_WITH_MITM,
+        SECURITY_MODE_SIGNED_NO_MITM,
+        SECURITY_MODE_SIGNED_WITH_MITM
+    };
+};
+
+class GattCharacteristic
+{
+    public:
+
+    enum Properties_t
+    {
+        BLE_GATT_CHAR_PROPERTIES_NONE = 0x00,
+        BLE_GATT_CHAR_PROPERTIES_BROADCAST = 0x01,
+        BLE_GATT_CHAR_PROPERTIES_READ = 0x02,
+        BLE_GATT_CHAR_PROPERTIES_WRITE_WITHOUT_RESPONSE = 0x04,
+        BLE_GATT_CHAR_PROPERTIES_WRITE = 0x08,
+        BLE_GATT_CHAR_PROPERTIES_NOTIFY = 0x10,
+        BLE_GATT_CHAR_PROPERTIES_INDICATE = 0x20,
+        BLE_GATT_CHAR_PROPERTIES_AUTHENTICATED_SIGNED_WRITES = 0x40,
+        BLE_GATT_CHAR_PROPERTIES_EXTENDED_PROPERTIES = 0x80
+    };
+
+    GattCharacteristic(const UUID &uuid, uint8_t *valuePtr = NULL, uint16_t len = 0, uint16_t maxLen = 0,
+                       uint8_t props = BLE_GATT_CHAR_PROPERTIES_NONE, GattAttribute *descriptors[] = NULL,
+                       unsigned numDescriptors = 0, bool hasVariableLen = true);
+
+    void requireSecurity(SecurityManager::SecurityMode_t securityMode);
+
+    GattAttribute::Handle_t getValueHandle() const;
+
+    private:
+
+    friend class GattServer;
+
+    UUID uuid;
+    uint8_t *valuePtr;
+    uint16_t len;
+    uint16_t maxLen;
+    uint8_t props;
+    GattAttribute::Handle_t valueHandle;
+};
+
+class GattService
+{
+    public:
+
+    GattService(const UUID &uuid, GattCharacteristic *characteristics[], unsigned numCharacteristics);
+
+    private:
+
+    friend class GattServer;
+
+    UUID uuid;
+    GattCharacteristic **characteristics;
+    unsigned numCharacteristics;
+};
+
+class Gap
+{
+    public:
+
+    struct GapState_t
+    {
+        unsigned advertising : 1;
+        unsigned connected : 1;
+    };
+};
+
+/**
+  * Attribute table and notification queue.
+  */
+class GattServer
+{
+    public:
+
+    /**
+      * A notification taken by the radio.
+      */
+    struct Notification
+    {
+        GattAttribute::Handle_t handle;
+        std::vector<uint8_t> value;
+    };
+
+    GattServer();
+
+    ble_error_t addService(GattService &service);
+
+    /**
+      * Set the value of an attribute. Unless localOnly is set, a value that can be notified
+      * is notified as well while a peer is connected.
+      */
+    ble_error_t write(GattAttribute::Handle_t handle, const uint8_t *value, uint16_t size, bool localOnly = false);
+    ble_error_t read(GattAttribute::Handle_t handle, uint8_t *buffer, uint16_t *lengthP);
+
+    /**
+      * Queue a notification. Fails with BLE_ERROR_NO_MEM once BLE_SIM_TX_BUFFERS are
+      * waiting to be sent, see BLE::simulateDataSent().
+      */
+    ble_error_t notify(GattAttribute::Handle_t handle, const uint8_t *value, uint16_t size);
+
+    void onDataWritten(void (*callback)(const GattWriteCallbackParams *params));
+
+    template <typename T>
+    void onDataWritten(T *objPtr, void (T::*memberPtr)(const GattWriteCallbackParams *params))
+    {
+        dataWrittenCallbacks.push_back([objPtr, memberPtr](const GattWriteCallbackParams *params) { (objPtr->*memberPtr)(params); });
+    }
+
+    void onDataSent(void (*callback)(unsigned count));
+
+    template <typename T>
+    void onDataSent(T *objPtr, void (T::*memberPtr)(unsigned count))
+    {
+        dataSentCallbacks.push_back([objPtr, memberPtr](unsigned count) { (objPtr->*memberPtr)(count); });
+    }
+
+    /**
+      * Value handle of the first characteristic with a UUID, or 0 if there is none.
+      */
+    GattAttribute::Handle_t findCharacteristic(const UUID &uuid);
+
+    /**
+      * Notifications taken so far, oldest first.
+      */
+    std::vector<Notification> &getNotifications();
+
+    private:
+
+    friend class BLE;
+
+    struct Attribute
+    {
+        UUID uuid;
+        uint8_t props;
+        std::vector<uint8_t> value;
+        uint16_t maxLen;
+    };
+
+    std::vector<Attribute> attributes;
+    std::vector<Notification> notifications;
+    std::vector<std::function<void(const GattWriteCallbackParams *)> > dataWrittenCallbacks;
+    std::vector<std::function<void(unsigned)> > dataSentCallbacks;
+    unsigned pending;
+    bool connected;
+
+    Attribute *find(GattAttribute::Handle_t handle);
+};
+
+/**
+  * The BLE device, and the peer it may be connected to.
+  */
+class BLE
+{
+    GattServer server;
+    Gap::GapState_t state;
+
+    public:
+
+    BLE();
+
+    ble_error_t addService(GattService &service);
+    GattServer &gattServer();
+    Gap::GapState_t getGapState() const;
+
+    void onDataWritten(void (*callback)(const GattWriteCallbackParams *params));
+
+    template <typename T>
+    void onDataWritten(T *objPtr, void (T::*memberPtr)(const GattWriteCallbackParams *params))
+    {
+        server.onDataWritten(objPtr, memberPtr);
+    }
+
+    /**
+      * The peer connects, firing MICROBIT_BLE_EVT_CONNECTED.
+      */
+    void simulateConnect();
+
+    /**
+      * The peer disconnects, firing MICROBIT_BLE_EVT_DISCONNECTED. Pending notifications are lost.
+      */
+    void simulateDisconnect();
+
+    /**
+      * The peer writes an attribute. The write callbacks are called at once, as from the
+      * radio interrupt.
+      *
+      * @return BLE_ERROR_NONE, or BLE_ERROR_INVALID_PARAM if the attribute is not writable.
+      */
+    ble_error_t simulateWrite(GattAttribute::Handle_t handle, const uint8_t *data, uint16_t len);
+
+    /**
+      * The radio sends the pending notifications, and calls the data sent callbacks with
+      * their number.
+      *
+      * @return the number of notifications sent.
+      */
+    unsigned simulateDataSent();
+};
+
+typedef BLE BLEDevice;
+
+#endif
@@ -0,0 +1,31 @@
+#include "ble/UUID.h"
+
+UUID::UUID(const LongUUIDBytes_t longUUID)
+{
+    isShort = false;
+    shortUUID = (longUUID[2] << 8) | longUUID[3];
+    memcpy(baseUUID, longUUID, LENGTH_OF_LONG_UUID);
+}
+
+UUID::UUID(ShortUUIDBytes_t shortUUID)
+{
+    isShort = true;
+    this->shortUUID = shortUUID;
+    memset(baseUUID, 0, LENGTH_OF_LONG_UUID);
+}
+
+bool UUID::operator==(const UUID &other) const
+{
+    if (isShort != other.isShort)
+        return false;
+
+    if (isShort)
+        return shortUUID == other.shortUUID;
+
+    return memcmp(baseUUID, other.baseUUID, LENGTH_OF_LONG_UUID) == 0;
+}
+
+bool UUID::operator!=(const UUID &other) const
+{
+    return !(*this == other);
+}
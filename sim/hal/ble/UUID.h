@@ -0,0 +1,32 @@
+#ifndef BLE_UUID_H
+#define BLE_UUID_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+  * A 16 bit or 128 bit UUID, with the constructors of the mbed BLE API.
+  */
+class UUID
+{
+    public:
+
+    static const unsigned LENGTH_OF_LONG_UUID = 16;
+
+    typedef uint16_t ShortUUIDBytes_t;
+    typedef uint8_t LongUUIDBytes_t[LENGTH_OF_LONG_UUID];
+
+    UUID(const LongUUIDBytes_t longUUID);
+    UUID(ShortUUIDBytes_t shortUUID = 0);
+
+    bool operator==(const UUID &other) const;
+    bool operator!=(const UUID &other) const;
+
+    private:
+
+    bool isShort;
+    ShortUUIDBytes_t shortUUID;
+    LongUUIDBytes_t baseUUID;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#include "mbed.h"
+#include "MicroBitSimulator.h"
+
+DigitalOut::DigitalOut(PinName pin) : pin(pin)
+{
+}
+
+DigitalOut::DigitalOut(PinName pin, int value) : pin(pin)
+{
+    write(value);
+}
+
+void DigitalOut::write(int value)
+{
+    sim_environment().writeDigital(pin, value ? 1 : 0);
+}
+
+int DigitalOut::read()
+{
+    return sim_environment().digitalOut[pin];
+}
+
+DigitalOut &DigitalOut::operator=(int value)
+{
+    write(value);
+    return *this;
+}
+
+DigitalIn::DigitalIn(PinName pin) : pin(pin)
+{
+}
+
+DigitalIn::DigitalIn(PinName pin, PinMode) : pin(pin)
+{
+}
+
+int DigitalIn::read()
+{
+    return sim_environment().readDigital(pin);
+}
+
+void DigitalIn::mode(PinMode)
+{
+}
+
+AnalogIn::AnalogIn(PinName pin) : pin(pin)
+{
+}
+
+unsigned short AnalogIn::read_u16()
+{
+    // 10 bit conversions, scaled to 16 bits as by mbed
+    int value = sim_environment().readAnalog(pin);
+
+    if (value < 0)
+        value = 0;
+
+    if (value > 1023)
+        value = 1023;
+
+    return (value << 6) | (value >> 4);
+}
+
+float AnalogIn::read()
+{
+    return read_u16() / 65535.0f;
+}
@@ -0,0 +1,86 @@
+#ifndef MBED_H
+#define MBED_H
+
+/**
+  * Host simulation stand-in for the parts of mbed used by the SmartVase firmware.
+  * Pins are read from and written to the simulated environment, see MicroBitSimulator.h.
+  */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef enum
+{
+    p0 = 0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15,
+    p16, p17, p18, p19, p20, p21, p22, p23, p24, p25, p26, p27, p28, p29, p30,
+    NC = -1
+} PinName;
+
+typedef enum
+{
+    PullNone = 0,
+    PullDown = 1,
+    PullUp = 3
+} PinMode;
+
+/**
+  * Busy waits, in virtual time: the time advances without running the system tick.
+  */
+void wait_us(int us);
+void wait_ms(int ms);
+void wait(float s);
+
+/**
+  * Free running microsecond counter.
+  */
+uint32_t us_ticker_read();
+
+/**
+  * The simulation is single threaded, and the system tick only runs between fiber
+  * switches: nothing to mask.
+  */
+static inline void __disable_irq()
+{
+}
+
+static inline void __enable_irq()
+{
+}
+
+class DigitalOut
+{
+    PinName pin;
+
+    public:
+
+    DigitalOut(PinName pin);
+    DigitalOut(PinName pin, int value);
+    void write(int value);
+    int read();
+    DigitalOut &operator=(int value);
+};
+
+class DigitalIn
+{
+    PinName pin;
+
+    public:
+
+    DigitalIn(PinName pin);
+    DigitalIn(PinName pin, PinMode mode);
+    int read();
+    void mode(PinMode mode);
+};
+
+class AnalogIn
+{
+    PinName pin;
+
+    public:
+
+    AnalogIn(PinName pin);
+    unsigned short read_u16();
+    float read();
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include <math.h>
+
+#include "VaseEnvironment.h"
+#include "MicroBitSystemTimer.h"
+
+// Soil held by the pot, in ml: 10 ml of water raise the water content by 1%
+#define VASE_SOIL_VOLUME            1000.0
+
+// Pump flow, in ml per ms (25 ml/s, MICROBIT_RESERVOIR_FLOW_RATE)
+#define VASE_PUMP_FLOW              (25.0 / 1000)
+
+// Time for the poured water to soak in, in ms
+#define VASE_SOAK_TIME              180000.0
+
+// Size of the tank, in ml (MICROBIT_RESERVOIR_CAPACITY)
+#define VASE_TANK_SIZE              1000.0
+
+// Water content lost per hour in full sun at 20°C, at 30%
+#define VASE_DRYING_RATE            1.5
+
+// Probe readings in dry and saturated soil, and settling time once powered, in us
+#define VASE_PROBE_DRY              245
+#define VASE_PROBE_WET              1023
+#define VASE_PROBE_SETTLE           150.0
+
+#define VASE_DAY                    86400000.0
+
+VaseEnvironment::VaseEnvironment(double vwc)
+{
+    this->vwc = vwc;
+    this->surface = 0;
+    this->poured = 0;
+    this->tank = VASE_TANK_SIZE;
+    this->light = 0;
+    this->excitedAt = 0;
+    this->lastUpdate = 0;
+    this->seed = 12345;
+}
+
+/**
+  * Conversion noise, -2 to 2 ADC steps.
+  */
+int VaseEnvironment::noise()
+{
+    seed = seed * 1103515245 + 12345;
+
+    return (int)((seed >> 16) % 5) - 2;
+}
+
+int VaseEnvironment::readAnalog(int pin)
+{
+    if (pin == VASE_PROBE_PIN)
+    {
+        if (!digitalOut[VASE_EXCITATION_PIN])
+            return 0;
+
+        double target = VASE_PROBE_DRY + (VASE_PROBE_WET - VASE_PROBE_DRY) * vwc / 50;
+        double settled = 1 - exp(-(double)(system_timer_current_time_us() - excitedAt) / (VASE_PROBE_SETTLE / 3));
+        int value = (int)(target * settled) + noise();
+
+        return value < 0 ? 0 : value > 1023 ? 1023 : value;
+    }
+
+    // The LEDs of the light sensor: the brighter the light, the lower the voltage left
+    if (pin >= VASE_LIGHT_COLUMN_START && pin < VASE_LIGHT_COLUMN_START + VASE_LIGHT_COLUMNS)
+        return (int)(338 - light * (338 - 75) / 255);
+
+    return MicroBitSimEnvironment::readAnalog(pin);
+}
+
+/**
+  * Fill the tank up.
+  */
+void VaseEnvironment::refill()
+{
+    tank = VASE_TANK_SIZE;
+}
+
+void VaseEnvironment::writeDigital(int pin, int value)
+{
+    if (pin == VASE_EXCITATION_PIN && value && !digitalOut[pin])
+        excitedAt = system_timer_current_time_us();
+
+    MicroBitSimEnvironment::writeDigital(pin, value);
+}
+
+void VaseEnvironment::writeAnalog(int pin, int value)
+{
+    // A full duty PWM output powers the probe as a high digital output does
+    if (pin == VASE_EXCITATION_PIN)
+        writeDigital(pin, value >= 1023);
+
+    MicroBitSimEnvironment::writeAnalog(pin, value);
+}
+
+void VaseEnvironment::update(uint64_t now)
+{
+    double dt = (double)(now - lastUpdate);
+    lastUpdate = now;
+
+    // Day from 6:00 to 18:00, warmest at 15:00
+    double day = fmod((double)now, VASE_DAY) / VASE_DAY;
+    double sun = sin((day - 0.25) * 2 * M_PI);
+
+    light = 5 + (sun > 0 ? 225 * sun : 0);
+    temperature = (int)lround(20 + 4 * sin((day - 0.375) * 2 * M_PI));
+
+    if (digitalOut[VASE_PUMP_PIN])
+    {
+        double flow = VASE_PUMP_FLOW * dt;
+
+        if (flow > tank)
+            flow = tank;
+
+        tank -= flow;
+        surface += flow;
+        poured += flow;
+    }
+
+    double soaked = surface * (1 - exp(-dt / VASE_SOAK_TIME));
+    surface -= soaked;
+    vwc += soaked / VASE_SOIL_VOLUME * 100;
+
+    // Evaporation follows the light and the warmth, and slows down as the soil dries
+    double demand = (0.1 + light / 255) * (1 + (temperature - 20) * 0.05);
+    vwc -= VASE_DRYING_RATE * demand * (vwc / 30) * dt / 3600000;
+
+    if (vwc < 0)
+        vwc = 0;
+
+    if (vwc > 50)
+        vwc = 50;
+}
@@ -0,0 +1,59 @@
+#ifndef VASE_ENVIRONMENT_H
+#define VASE_ENVIRONMENT_H
+
+#include "MicroBitSimulator.h"
+#include "MicroBitPin.h"
+
+// Wiring of zone 0, see the zone table in main.cpp
+#define VASE_PROBE_PIN              MICROBIT_PIN_P0
+#define VASE_EXCITATION_PIN         MICROBIT_PIN_P1
+#define VASE_PUMP_PIN               MICROBIT_PIN_P2
+
+// Display columns read by MicroBitAmbientLightSensor
+#define VASE_LIGHT_COLUMN_START     4
+#define VASE_LIGHT_COLUMNS          3
+
+/**
+  * A pot on a window sill: the soil dries with the light and the warmth of the day, the
+  * pump pours water on it that soaks in over a few minutes, and the probe reads the water
+  * content once powered and settled.
+  */
+class VaseEnvironment : public MicroBitSimEnvironment
+{
+    public:
+
+    // Water content of the soil around the probe, in %
+    double vwc;
+
+    // Water poured but not soaked in yet, in ml
+    double surface;
+
+    // Water poured so far, in ml
+    double poured;
+
+    // Water left in the tank, in ml
+    double tank;
+
+    // Light level of the day, 0 - 255
+    double light;
+
+    VaseEnvironment(double vwc = 30);
+
+    void refill();
+
+    virtual int readAnalog(int pin);
+    virtual void writeDigital(int pin, int value);
+    virtual void writeAnalog(int pin, int value);
+    virtual void update(uint64_t now);
+
+    private:
+
+    // Time the probe was powered, in us
+    uint64_t excitedAt;
+    uint64_t lastUpdate;
+    uint32_t seed;
+
+    int noise();
+};
+
+#endif
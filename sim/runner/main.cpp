@@ -0,0 +1,133 @@
+/**
+  * Runs the SmartVase firmware on the host, against a simulated pot, and prints the
+  * readings once per simulated hour.
+  *
+  * vase-sim [--days N] [--step MS] [--connect] [--quiet]
+  *
+  * --days     simulated time, in days (default 7)
+  * --step     time between two checks of the peer, in ms (default 1000)
+  * --connect  a BLE peer is connected and takes every notification
+  * --quiet    only print the summary
+  *
+  * The tank is filled up, and button B pressed, once a day when it is below a quarter.
+  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "MicroBit.h"
+#include "VaseEnvironment.h"
+
+#include "sensors/moisture/MicroBitMoistureSensor.h"
+#include "actuators/watering/MicroBitWateringActuator.h"
+
+int vase_main();
+
+extern MicroBit uBit;
+extern MicroBitMoistureSensor moistureSensors[];
+extern MicroBitWateringActuator wateringActuators[];
+
+static uint32_t samples = 0;
+static uint32_t waterings = 0;
+static uint32_t notifications = 0;
+
+static void onSample(MicroBitEvent)
+{
+    samples++;
+}
+
+static void onWatering(MicroBitEvent)
+{
+    if (wateringActuators[0].isWatering())
+        waterings++;
+}
+
+static void boot()
+{
+    vase_main();
+}
+
+int main(int argc, char **argv)
+{
+    double days = 7;
+    uint32_t step = 1000;
+    bool connect = false;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--days") && i + 1 < argc)
+            days = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--step") && i + 1 < argc)
+            step = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--connect"))
+            connect = true;
+        else if (!strcmp(argv[i], "--quiet"))
+            quiet = true;
+        else
+        {
+            fprintf(stderr, "usage: %s [--days N] [--step MS] [--connect] [--quiet]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (step == 0 || step > 3600000 || 3600000 % step)
+    {
+        fprintf(stderr, "--step must divide an hour\n");
+        return 2;
+    }
+
+    VaseEnvironment pot;
+    sim_set_environment(&pot);
+
+    if (quiet)
+        uBit.serial.setOutput(NULL);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    sim_start(boot);
+
+    uBit.messageBus.listen(MICROBIT_ID_MOISTURE, MICROBIT_MOISTURE_EVT_UPDATE, onSample, MESSAGE_BUS_LISTENER_IMMEDIATE);
+    uBit.messageBus.listen(MICROBIT_ID_WATERING_ACTUATOR, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE, onWatering, MESSAGE_BUS_LISTENER_IMMEDIATE);
+
+    if (connect)
+        uBit.ble->simulateConnect();
+
+    if (!quiet)
+        printf("hour,soil_vwc,moisture,raw,light,temperature,tank_ml,poured_ml,samples,waterings\n");
+
+    uint32_t hours = (uint32_t)(days * 24);
+
+    for (uint32_t hour = 1; hour <= hours; hour++)
+    {
+        for (uint32_t t = 0; t < 3600000; t += step)
+        {
+            sim_run(step);
+
+            if (connect)
+                uBit.ble->simulateDataSent();
+        }
+
+        // Only the count is kept
+        notifications += uBit.ble->gattServer().getNotifications().size();
+        uBit.ble->gattServer().getNotifications().clear();
+
+        if (hour % 24 == 0 && pot.tank < 250)
+        {
+            pot.refill();
+            uBit.buttonB.click();
+        }
+
+        if (!quiet)
+            printf("%u,%.1f,%d,%d,%d,%d,%.0f,%.0f,%u,%u\n", hour, pot.vwc, (int)moistureSensors[0].getMoistureLevel(), moistureSensors[0].getRawLevel(),
+                   (int)pot.light, pot.temperature, pot.tank, pot.poured, samples, waterings);
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("simulated %.1f days in %.2f s (%.1f days/s): %u readings, %u waterings, %.0f ml poured, %u notifications\n",
+           hours / 24.0, wall, wall > 0 ? hours / 24.0 / wall : 0, samples, waterings, pot.poured, notifications);
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "SimTest.h"
+
+#include "utils/scheduling/MicroBitAdaptivePeriod.h"
+
+static void testDoubling()
+{
+    MicroBitAdaptivePeriod period(1000, 60000, 2);
+
+    CHECK_EQUAL(period.get(), 1000);
+
+    // Stable readings double the period, the last step is cut to the maximum
+    CHECK_EQUAL(period.update(100), 2000);
+    CHECK_EQUAL(period.update(101), 4000);
+    CHECK_EQUAL(period.update(99), 8000);
+    CHECK_EQUAL(period.update(100), 16000);
+    CHECK_EQUAL(period.update(102), 32000);
+    CHECK_EQUAL(period.update(100), 60000);
+    CHECK_EQUAL(period.update(100), 60000);
+    CHECK_EQUAL(period.get(), 60000);
+}
+
+static void testReset()
+{
+    MicroBitAdaptivePeriod period(500, 8000, 2);
+
+    for (int i = 0; i < 10; i++)
+        period.update(50);
+
+    CHECK_EQUAL(period.get(), 8000);
+
+    // A change beyond the threshold, either way, goes back to the minimum
+    CHECK_EQUAL(period.update(53), 500);
+    CHECK_EQUAL(period.update(53), 1000);
+    CHECK_EQUAL(period.update(50), 500);
+
+    // Compared with the previous reading, not the one the period started from
+    CHECK_EQUAL(period.update(52), 1000);
+    CHECK_EQUAL(period.update(54), 2000);
+
+    CHECK_EQUAL(period.boost(), 500);
+    CHECK_EQUAL(period.get(), 500);
+    CHECK_EQUAL(period.update(54), 1000);
+}
+
+static void testConfigure()
+{
+    MicroBitAdaptivePeriod period(1000, 60000, 2);
+
+    period.update(10);
+    period.update(10);
+
+    // Restarts from the minimum, and forgets the last reading
+    period.configure(2000, 16000, 5);
+    CHECK_EQUAL(period.get(), 2000);
+    CHECK_EQUAL(period.update(100), 4000);
+    CHECK_EQUAL(period.update(105), 8000);
+    CHECK_EQUAL(period.update(111), 2000);
+
+    // A maximum under the minimum is raised to it
+    period.configure(3000, 1000, 2);
+    CHECK_EQUAL(period.update(0), 3000);
+    CHECK_EQUAL(period.update(0), 3000);
+
+    // setMaxPeriod keeps the current period within the new bounds
+    period.configure(1000, 60000, 2);
+
+    for (int i = 0; i < 4; i++)
+        period.update(0);
+
+    CHECK_EQUAL(period.get(), 16000);
+
+    period.setMaxPeriod(30000);
+    CHECK_EQUAL(period.get(), 16000);
+
+    period.setMaxPeriod(10000);
+    CHECK_EQUAL(period.get(), 10000);
+    CHECK_EQUAL(period.update(0), 10000);
+
+    period.setMaxPeriod(500);
+    CHECK_EQUAL(period.get(), 1000);
+    CHECK_EQUAL(period.update(0), 1000);
+
+    // The readings go on from where they were
+    CHECK_EQUAL(period.update(3), 1000);
+    period.setMaxPeriod(4000);
+    CHECK_EQUAL(period.update(3), 2000);
+    CHECK_EQUAL(period.update(3), 4000);
+}
+
+int main()
+{
+    testDoubling();
+    testReset();
+    testConfigure();
+
+    return SIM_TEST_RESULT();
+}
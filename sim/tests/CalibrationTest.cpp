@@ -0,0 +1,95 @@
+#include "SimTest.h"
+
+#include "sensors/moisture/MicroBitMoistureCalibration.h"
+
+typedef MicroBitCurveTable<MicroBitLinearCurve> LinearTable;
+typedef MicroBitCurveTable<MicroBitResistiveCurve> ResistiveTable;
+
+static void testTables()
+{
+    const int full = MICROBIT_MOISTURE_VWC_WET << MICROBIT_MOISTURE_VWC_SHIFT;
+
+    CHECK_EQUAL(LinearTable::values[0], 0);
+    CHECK_EQUAL(LinearTable::values[MICROBIT_MOISTURE_CURVE_SEGMENTS], full);
+    CHECK_EQUAL(LinearTable::values[MICROBIT_MOISTURE_CURVE_SEGMENTS / 2], full / 2);
+
+    CHECK_EQUAL(ResistiveTable::values[0], 0);
+    CHECK_EQUAL(ResistiveTable::values[MICROBIT_MOISTURE_CURVE_SEGMENTS], full);
+    CHECK_EQUAL(ResistiveTable::values[MICROBIT_MOISTURE_CURVE_SEGMENTS / 2], full / 4);
+
+    for (int i = 0; i < MICROBIT_MOISTURE_CURVE_SEGMENTS; i++)
+    {
+        CHECK(LinearTable::values[i] < LinearTable::values[i + 1]);
+        CHECK(ResistiveTable::values[i] < ResistiveTable::values[i + 1]);
+    }
+}
+
+static void testApply()
+{
+    MicroBitMoistureCalibration calibration;
+
+    CHECK_EQUAL(calibration.getDry(), MICROBIT_MOISTURE_DRY_RAW);
+    CHECK_EQUAL(calibration.getWet(), MICROBIT_MOISTURE_WET_RAW);
+    CHECK_EQUAL(calibration.getCurve(), MICROBIT_MOISTURE_CURVE_LINEAR);
+
+    // Clamped outside the calibration points
+    CHECK_EQUAL(calibration.apply(0), 0);
+    CHECK_EQUAL(calibration.apply(MICROBIT_MOISTURE_DRY_RAW), 0);
+    CHECK_EQUAL(calibration.apply(MICROBIT_MOISTURE_WET_RAW), MICROBIT_MOISTURE_VWC_WET);
+
+    for (int curve = 0; curve < MICROBIT_MOISTURE_CURVE_COUNT; curve++)
+    {
+        const int spans[][2] = { { 245, 1023 }, { 0, 1023 }, { 300, 364 }, { 500, 900 } };
+
+        for (unsigned s = 0; s < sizeof(spans) / sizeof(spans[0]); s++)
+        {
+            int dry = spans[s][0];
+            int wet = spans[s][1];
+
+            CHECK_EQUAL(calibration.set(dry, wet, curve), MICROBIT_OK);
+            CHECK_EQUAL(calibration.apply(wet), MICROBIT_MOISTURE_VWC_WET);
+
+            // Monotonic, and within a point of the exact curve
+            int previous = 0;
+
+            for (int raw = 0; raw <= 1023; raw++)
+            {
+                int vwc = calibration.apply(raw);
+                double x = raw <= dry ? 0 : raw >= wet ? 1 : (double)(raw - dry) / (wet - dry);
+                double exact = MICROBIT_MOISTURE_VWC_WET * (curve == MICROBIT_MOISTURE_CURVE_LINEAR ? x : x * x);
+
+                if (!CHECK(vwc >= previous && vwc - exact <= 1 && exact - vwc <= 1))
+                {
+                    fprintf(stderr, "curve %d, %d - %d, raw %d: %d, expected %.2f\n", curve, dry, wet, raw, vwc, exact);
+                    break;
+                }
+
+                previous = vwc;
+            }
+        }
+    }
+}
+
+static void testInvalid()
+{
+    MicroBitMoistureCalibration calibration;
+
+    CHECK_EQUAL(calibration.set(-1, 800, MICROBIT_MOISTURE_CURVE_LINEAR), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(calibration.set(200, 1024, MICROBIT_MOISTURE_CURVE_LINEAR), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(calibration.set(500, 500 + MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN - 1, MICROBIT_MOISTURE_CURVE_LINEAR), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(calibration.set(800, 200, MICROBIT_MOISTURE_CURVE_LINEAR), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(calibration.set(200, 800, MICROBIT_MOISTURE_CURVE_COUNT), MICROBIT_INVALID_PARAMETER);
+
+    // A rejected calibration leaves the current one
+    CHECK_EQUAL(calibration.getDry(), MICROBIT_MOISTURE_DRY_RAW);
+    CHECK_EQUAL(calibration.getWet(), MICROBIT_MOISTURE_WET_RAW);
+}
+
+int main()
+{
+    testTables();
+    testApply();
+    testInvalid();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,178 @@
+#include <vector>
+
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "services/command/MicroBitCommandService.h"
+#include "storage/history/MicroBitHistory.h"
+
+static MicroBitMessageBus bus;
+static BLEDevice ble;
+static GattAttribute::Handle_t handle;
+static int received = 0;
+
+static void onReceived(MicroBitEvent)
+{
+    received++;
+}
+
+/**
+  * Write a batch as the peer does, and return the acknowledgement notified for it, if any:
+  * sequence << 16 | status << 8 | offset, or -1.
+  */
+static int write(std::vector<uint8_t> batch)
+{
+    std::vector<GattServer::Notification> &notifications = ble.gattServer().getNotifications();
+    notifications.clear();
+
+    ble.simulateWrite(handle, batch.data(), batch.size());
+    ble.simulateDataSent();
+
+    if (notifications.empty())
+        return -1;
+
+    std::vector<uint8_t> &ack = notifications.back().value;
+
+    return ack[0] << 16 | ack[1] << 8 | ack[2];
+}
+
+static int ack(int sequence, int status, int offset)
+{
+    return sequence << 16 | status << 8 | offset;
+}
+
+static void testValidBatch(MicroBitCommandService &service)
+{
+    int before = received;
+
+    const MicroBitCommandBatch &batch = service.getBatch();
+
+    // Threshold 15, pulse 4000 ms, periods 1000 - 60000 ms, start watering
+    CHECK_EQUAL(write({ 41,
+                        1, 1, 15,
+                        2, 2, 0xA0, 0x0F,
+                        3, 8, 0xE8, 0x03, 0, 0, 0x60, 0xEA, 0, 0,
+                        4, 0 }), -1);
+
+    CHECK_EQUAL(received, before + 1);
+    CHECK_EQUAL(batch.sequence, 41);
+    CHECK_EQUAL(batch.commands, MICROBIT_COMMAND_BIT(1) | MICROBIT_COMMAND_BIT(2) | MICROBIT_COMMAND_BIT(3) | MICROBIT_COMMAND_BIT(4));
+    CHECK_EQUAL(batch.treshold, 15);
+    CHECK_EQUAL(batch.pulse, 4000);
+    CHECK_EQUAL(batch.minPeriod, 1000);
+    CHECK_EQUAL(batch.maxPeriod, 60000);
+
+    service.acknowledge(MICROBIT_COMMAND_STATUS_OK);
+    ble.simulateDataSent();
+
+    // History from 7, calibration from the current reading, compensation -20
+    CHECK_EQUAL(write({ 42,
+                        7, 4, 7, 0, 0, 0,
+                        8, 5, 0xF5, 0, 0xFF, 0xFF, 1,
+                        9, 1, 0xEC }), -1);
+
+    CHECK_EQUAL(received, before + 2);
+    CHECK_EQUAL(batch.sequence, 42);
+    CHECK_EQUAL(batch.commands, MICROBIT_COMMAND_BIT(7) | MICROBIT_COMMAND_BIT(8) | MICROBIT_COMMAND_BIT(9));
+    CHECK_EQUAL(batch.historyFrom, 7);
+    CHECK_EQUAL(batch.historyCount, MICROBIT_HISTORY_CAPACITY);
+    CHECK_EQUAL(batch.calibrationDry, 245);
+    CHECK_EQUAL(batch.calibrationWet, MICROBIT_COMMAND_CALIBRATION_CURRENT);
+    CHECK_EQUAL(batch.calibrationCurve, MICROBIT_MOISTURE_CURVE_RESISTIVE);
+    CHECK_EQUAL(batch.compensation, -20);
+
+    // Nothing else is taken until the batch is acknowledged
+    CHECK_EQUAL(write({ 43, 1, 1, 20 }), ack(43, MICROBIT_COMMAND_STATUS_BUSY, 0));
+    CHECK_EQUAL(batch.sequence, 42);
+
+    ble.gattServer().getNotifications().clear();
+    service.acknowledge(MICROBIT_COMMAND_STATUS_OK);
+    CHECK_EQUAL(ble.gattServer().getNotifications().size(), 1);
+    CHECK_EQUAL(ble.gattServer().getNotifications().back().value[0], 42);
+    CHECK_EQUAL(ble.gattServer().getNotifications().back().value[1], MICROBIT_COMMAND_STATUS_OK);
+    ble.simulateDataSent();
+
+    // A second acknowledgement has no effect
+    ble.gattServer().getNotifications().clear();
+    service.acknowledge(MICROBIT_COMMAND_STATUS_OK);
+    CHECK(ble.gattServer().getNotifications().empty());
+
+    // An empty batch is valid, and the history count is optional
+    CHECK_EQUAL(write({ 44 }), -1);
+    service.acknowledge(MICROBIT_COMMAND_STATUS_OK);
+    ble.simulateDataSent();
+
+    CHECK_EQUAL(write({ 45, 7, 6, 1, 0, 0, 0, 10, 0 }), -1);
+    CHECK_EQUAL(batch.historyCount, 10);
+    service.acknowledge(MICROBIT_COMMAND_STATUS_OK);
+    ble.simulateDataSent();
+
+    // Watering extended by 2500 ms
+    CHECK_EQUAL(write({ 46, 10, 2, 0xC4, 0x09 }), -1);
+    CHECK_EQUAL(batch.commands, MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_EXTEND_WATERING));
+    CHECK_EQUAL(batch.extension, 2500);
+    service.acknowledge(MICROBIT_COMMAND_STATUS_OK);
+    ble.simulateDataSent();
+}
+
+static void testRejectedBatches()
+{
+    int before = received;
+
+    // Nothing at all
+    CHECK_EQUAL(write({}), ack(0, MICROBIT_COMMAND_STATUS_MALFORMED, 0));
+
+    // Truncated header and value, the offset points at the faulty command
+    CHECK_EQUAL(write({ 1, 1 }), ack(1, MICROBIT_COMMAND_STATUS_MALFORMED, 1));
+    CHECK_EQUAL(write({ 2, 1, 1, 10, 2, 2, 0x10 }), ack(2, MICROBIT_COMMAND_STATUS_MALFORMED, 4));
+
+    // Wrong length for the type
+    CHECK_EQUAL(write({ 3, 1, 2, 10, 0 }), ack(3, MICROBIT_COMMAND_STATUS_MALFORMED, 1));
+    CHECK_EQUAL(write({ 4, 4, 1, 0 }), ack(4, MICROBIT_COMMAND_STATUS_MALFORMED, 1));
+    CHECK_EQUAL(write({ 5, 7, 5, 0, 0, 0, 0, 0 }), ack(5, MICROBIT_COMMAND_STATUS_MALFORMED, 1));
+
+    // Unknown types
+    CHECK_EQUAL(write({ 6, 0, 0 }), ack(6, MICROBIT_COMMAND_STATUS_UNKNOWN, 1));
+    CHECK_EQUAL(write({ 7, 1, 1, 10, 11, 0 }), ack(7, MICROBIT_COMMAND_STATUS_UNKNOWN, 4));
+
+    // Out of range
+    CHECK_EQUAL(write({ 8, 1, 1, 0 }), ack(8, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 9, 1, 1, MICROBIT_COMMAND_TRESHOLD_MAX + 1 }), ack(9, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 10, 2, 2, 0, 0 }), ack(10, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 11, 2, 2, 0x31, 0x75 }), ack(11, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 12, 3, 8, 50, 0, 0, 0, 0xFF, 0, 0, 0 }), ack(12, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 13, 3, 8, 0, 2, 0, 0, 0xFF, 1, 0, 0 }), ack(13, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 14, 8, 5, 0, 4, 0xFF, 3, 0 }), ack(14, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 15, 8, 5, 0, 1, 0x20, 1, 0 }), ack(15, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 16, 8, 5, 0xF5, 0, 0xFF, 3, 2 }), ack(16, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 23, 10, 2, 0, 0 }), ack(23, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 24, 10, 2, 0x31, 0x75 }), ack(24, MICROBIT_COMMAND_STATUS_INVALID, 1));
+    CHECK_EQUAL(write({ 17, 9, 1, 101 }), ack(17, MICROBIT_COMMAND_STATUS_INVALID, 1));
+
+    // Repeated settings and several watering actions
+    CHECK_EQUAL(write({ 18, 1, 1, 10, 1, 1, 12 }), ack(18, MICROBIT_COMMAND_STATUS_CONFLICT, 4));
+    CHECK_EQUAL(write({ 19, 4, 0, 6, 0 }), ack(19, MICROBIT_COMMAND_STATUS_CONFLICT, 3));
+    CHECK_EQUAL(write({ 25, 5, 0, 10, 2, 0xE8, 0x03 }), ack(25, MICROBIT_COMMAND_STATUS_CONFLICT, 3));
+
+    // The faulty command fails the whole batch
+    CHECK_EQUAL(write({ 20, 1, 1, 20, 4, 0, 9, 1, 120 }), ack(20, MICROBIT_COMMAND_STATUS_INVALID, 6));
+
+    CHECK_EQUAL(received, before);
+}
+
+int main()
+{
+    bus.listen(MICROBIT_ID_COMMAND_SERVICE, COMMAND_EVT_RECEIVED, onReceived, MESSAGE_BUS_LISTENER_IMMEDIATE);
+
+    MicroBitCommandService service(ble);
+
+    handle = ble.gattServer().findCharacteristic(UUID(MicroBitCommandServiceDataUUID));
+    CHECK(handle != 0);
+
+    ble.simulateConnect();
+
+    testValidBatch(service);
+    testRejectedBatches();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,269 @@
+#include <string.h>
+
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "storage/config/MicroBitConfigStore.h"
+
+static MicroBitMessageBus bus;
+
+static MicroBitFlash flash;
+
+// Each test takes pages of its own, past the ones of the firmware
+static int nextOffset = MICROBIT_SIM_FLASH_PAGES;
+
+static uint32_t *takePages()
+{
+    nextOffset -= MICROBIT_CONFIG_STORE_PAGES;
+
+    return sim_flash_page(nextOffset + MICROBIT_CONFIG_STORE_PAGES);
+}
+
+static MicroBitConfigData *slot(uint32_t *pages, int i)
+{
+    return (MicroBitConfigData *)pages + i;
+}
+
+static bool isErased(uint32_t *pages, int i)
+{
+    const uint8_t *b = (const uint8_t *)slot(pages, i);
+
+    for (int j = 0; j < (int)sizeof(MicroBitConfigData); j++)
+        if (b[j] != 0xFF)
+            return false;
+
+    return true;
+}
+
+/**
+  * Number of records written, each one a flash write.
+  */
+static int writes(uint32_t *pages)
+{
+    int n = 0;
+
+    for (int i = 0; i < MICROBIT_CONFIG_STORE_SLOTS; i++)
+        if (!isErased(pages, i))
+            n++;
+
+    return n;
+}
+
+/**
+  * The last record written.
+  */
+static MicroBitConfigData saved(uint32_t *pages)
+{
+    int last = -1;
+
+    for (int i = 0; i < MICROBIT_CONFIG_STORE_SLOTS; i++)
+        if (!isErased(pages, i) && (last < 0 || (int8_t)(slot(pages, i)->sequence - slot(pages, last)->sequence) > 0))
+            last = i;
+
+    CHECK(last >= 0);
+
+    return *slot(pages, last < 0 ? 0 : last);
+}
+
+static void testDefaults()
+{
+    uint32_t *pages = takePages();
+    MicroBitConfigStore store(flash, pages);
+
+    CHECK_EQUAL(store.load(), MICROBIT_NO_DATA);
+
+    const MicroBitConfigData &data = store.get();
+
+    CHECK_EQUAL(data.moistureTreshold, MICROBIT_CONFIG_MOISTURE_TRESHOLD);
+    CHECK_EQUAL(data.moistureDry, MICROBIT_MOISTURE_DRY_RAW);
+    CHECK_EQUAL(data.moistureWet, MICROBIT_MOISTURE_WET_RAW);
+    CHECK_EQUAL(data.moistureCurve, MICROBIT_MOISTURE_CURVE_LINEAR);
+    CHECK_EQUAL(data.moistureCompensation, MICROBIT_CONFIG_MOISTURE_COMPENSATION);
+    CHECK_EQUAL(data.reservoir.capacity, MICROBIT_RESERVOIR_CAPACITY);
+
+    // Nothing to save
+    store.commit();
+    CHECK_EQUAL(writes(pages), 0);
+}
+
+static void testRoundTrip()
+{
+    uint32_t *pages = takePages();
+    MicroBitConfigStore store(flash, pages);
+
+    store.load();
+
+    MicroBitConfigData data = store.get();
+    data.moistureTreshold = 25;
+    data.moistureCompensation = -30;
+    data.moistureCurve = MICROBIT_MOISTURE_CURVE_RESISTIVE;
+    store.update(data);
+
+    // Batched until the commit
+    data.moistureDry = 300;
+    store.update(data);
+    CHECK_EQUAL(writes(pages), 0);
+
+    store.commit();
+    CHECK_EQUAL(writes(pages), 1);
+    CHECK_EQUAL(saved(pages).version, MICROBIT_CONFIG_STORE_VERSION);
+
+    // Nothing pending, and the same settings again are not a change
+    store.commit();
+    store.update(data);
+    store.commit();
+    CHECK_EQUAL(writes(pages), 1);
+
+    MicroBitConfigStore reloaded(flash, pages);
+    CHECK_EQUAL(reloaded.load(), MICROBIT_OK);
+    CHECK_EQUAL(memcmp(&reloaded.get(), &store.get(), sizeof(data)), 0);
+    CHECK_EQUAL(reloaded.get().moistureTreshold, 25);
+    CHECK_EQUAL(reloaded.get().moistureCompensation, -30);
+    CHECK_EQUAL(reloaded.get().moistureCurve, MICROBIT_MOISTURE_CURVE_RESISTIVE);
+    CHECK_EQUAL(reloaded.get().moistureDry, 300);
+
+    // The next save goes to the next slot, with a single write
+    data.moistureTreshold = 26;
+    store.update(data);
+    store.commit();
+    CHECK_EQUAL(writes(pages), 2);
+    CHECK(!isErased(pages, 1));
+    CHECK_EQUAL(saved(pages).moistureTreshold, 26);
+
+    MicroBitConfigStore next(flash, pages);
+    CHECK_EQUAL(next.load(), MICROBIT_OK);
+    CHECK_EQUAL(next.get().moistureTreshold, 26);
+}
+
+/**
+  * Changes are saved once the commit delay is over.
+  */
+static void testDelay()
+{
+    uint32_t *pages = takePages();
+    MicroBitConfigStore store(flash, pages);
+
+    store.load();
+
+    MicroBitConfigData data = store.get();
+    data.moistureTreshold = 20;
+    store.update(data);
+
+    sim_run(MICROBIT_CONFIG_STORE_COMMIT_DELAY / 2);
+    data.moistureTreshold = 21;
+    store.update(data);
+    CHECK_EQUAL(writes(pages), 0);
+
+    // Counted from the first change
+    sim_run(MICROBIT_CONFIG_STORE_COMMIT_DELAY / 2 + 100);
+    CHECK_EQUAL(writes(pages), 1);
+    CHECK_EQUAL(saved(pages).moistureTreshold, 21);
+}
+
+/**
+  * Saves of another version or with a bad checksum are ignored.
+  */
+static void testRejected()
+{
+    uint32_t *pages = takePages();
+    MicroBitConfigStore store(flash, pages);
+
+    store.load();
+
+    MicroBitConfigData data = store.get();
+    data.moistureTreshold = 30;
+    store.update(data);
+    store.commit();
+
+    MicroBitConfigData good = saved(pages);
+
+    // Any byte of the settings is covered by the checksum
+    for (int i = offsetof(MicroBitConfigData, reservoir); i < (int)sizeof(good); i++)
+    {
+        MicroBitConfigData corrupted = good;
+        ((uint8_t *)&corrupted)[i] ^= 0x10;
+        *slot(pages, 0) = corrupted;
+
+        MicroBitConfigStore rejected(flash, pages);
+        CHECK_EQUAL(rejected.load(), MICROBIT_NO_DATA);
+        CHECK_EQUAL(rejected.get().moistureTreshold, MICROBIT_CONFIG_MOISTURE_TRESHOLD);
+    }
+
+    MicroBitConfigData other = good;
+    other.version = MICROBIT_CONFIG_STORE_VERSION + 1;
+    *slot(pages, 0) = other;
+
+    MicroBitConfigStore rejected(flash, pages);
+    CHECK_EQUAL(rejected.load(), MICROBIT_NO_DATA);
+
+    *slot(pages, 0) = good;
+
+    MicroBitConfigStore accepted(flash, pages);
+    CHECK_EQUAL(accepted.load(), MICROBIT_OK);
+    CHECK_EQUAL(accepted.get().moistureTreshold, 30);
+}
+
+/**
+  * Consecutive saves land in consecutive slots around the ring, each page being erased only
+  * when the ring comes back to it, and the newest one is loaded, across sequence wraps.
+  */
+static void testWearLevelling()
+{
+    uint32_t *pages = takePages();
+    uint32_t *second = pages + PAGE_SIZE / 4;
+    MicroBitConfigStore store(flash, pages);
+
+    store.load();
+
+    const int saves = 5 * MICROBIT_CONFIG_STORE_SLOTS + 7;
+
+    for (int i = 0; i < saves; i++)
+    {
+        MicroBitConfigData data = store.get();
+        data.reservoir.volume = i;
+        store.update(data);
+        store.commit();
+
+        if (!CHECK_EQUAL(slot(pages, i % MICROBIT_CONFIG_STORE_SLOTS)->reservoir.volume, (uint32_t)i))
+            return;
+    }
+
+    // The erases are spread over both pages
+    CHECK_EQUAL(MicroBitFlash::getEraseCount(pages), 5);
+    CHECK_EQUAL(MicroBitFlash::getEraseCount(second), 4);
+
+    // The newest record is loaded, not the one in the last slot, and the next save follows it
+    MicroBitConfigStore reloaded(flash, pages);
+    CHECK_EQUAL(reloaded.load(), MICROBIT_OK);
+    CHECK_EQUAL(reloaded.get().reservoir.volume, (uint32_t)(saves - 1));
+
+    MicroBitConfigData data = reloaded.get();
+    data.reservoir.volume = saves;
+    reloaded.update(data);
+    reloaded.commit();
+    CHECK_EQUAL(slot(pages, saves % MICROBIT_CONFIG_STORE_SLOTS)->reservoir.volume, (uint32_t)saves);
+
+    // A slot left half written by a reset is skipped
+    int next = (saves + 1) % MICROBIT_CONFIG_STORE_SLOTS;
+    slot(pages, next)->version = 0;
+
+    data.reservoir.volume = saves + 1;
+    reloaded.update(data);
+    reloaded.commit();
+    CHECK_EQUAL(slot(pages, next + 1)->reservoir.volume, (uint32_t)(saves + 1));
+
+    MicroBitConfigStore last(flash, pages);
+    CHECK_EQUAL(last.load(), MICROBIT_OK);
+    CHECK_EQUAL(last.get().reservoir.volume, (uint32_t)(saves + 1));
+}
+
+int main()
+{
+    testDefaults();
+    testRoundTrip();
+    testDelay();
+    testRejected();
+    testWearLevelling();
+
+    return SIM_TEST_RESULT();
+}
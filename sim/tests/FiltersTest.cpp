@@ -0,0 +1,101 @@
+#include "SimTest.h"
+
+#include "utils/filters/MicroBitFilters.h"
+
+static void testEma()
+{
+    MicroBitEmaFilter<2> ema;
+
+    // Starts from the first reading
+    CHECK_EQUAL(ema.apply(100), 100);
+
+    // A step is followed by a quarter of the gap each time
+    CHECK_EQUAL(ema.apply(200), 125);
+    CHECK_EQUAL(ema.apply(200), 144);
+
+    int32_t out = 0;
+
+    for (int i = 0; i < 40; i++)
+        out = ema.apply(200);
+
+    CHECK_EQUAL(out, 200);
+
+    // Constant input stays put, whatever the rounding
+    for (int v = -300; v <= 300; v += 37)
+    {
+        ema.reset();
+
+        for (int i = 0; i < 10; i++)
+            out = ema.apply(v);
+
+        CHECK_EQUAL(out, v);
+    }
+}
+
+static void testMedian()
+{
+    MicroBitMedianFilter<3> median;
+
+    // Median of what has been seen so far
+    CHECK_EQUAL(median.apply(10), 10);
+    CHECK_EQUAL(median.apply(11), 11);
+    CHECK_EQUAL(median.apply(12), 11);
+
+    // An isolated spike is removed
+    CHECK_EQUAL(median.apply(500), 12);
+    CHECK_EQUAL(median.apply(13), 13);
+
+    // Two readings in a row are a change
+    median.reset();
+    median.apply(10);
+    median.apply(10);
+    median.apply(50);
+    CHECK_EQUAL(median.apply(50), 50);
+
+    MicroBitMedianFilter<5> wide;
+    const int32_t in[] = { 5, 1, 4, 2, 3, 100, -100, 3 };
+    const int32_t expected[] = { 5, 5, 4, 4, 3, 3, 3, 3 };
+
+    for (int i = 0; i < 8; i++)
+        CHECK_EQUAL(wide.apply(in[i]), expected[i]);
+}
+
+static void testDeadband()
+{
+    MicroBitDeadbandFilter<2> deadband;
+
+    CHECK_EQUAL(deadband.apply(10), 10);
+    CHECK_EQUAL(deadband.apply(12), 10);
+    CHECK_EQUAL(deadband.apply(8), 10);
+    CHECK_EQUAL(deadband.apply(13), 13);
+    CHECK_EQUAL(deadband.apply(11), 13);
+    CHECK_EQUAL(deadband.apply(10), 10);
+
+    deadband.reset();
+    CHECK_EQUAL(deadband.apply(11), 11);
+}
+
+static void testChain()
+{
+    MicroBitFilterChain<MicroBitMedianFilter<3>, MicroBitEmaFilter<1> > chain;
+
+    CHECK_EQUAL(chain.apply(100), 100);
+    CHECK_EQUAL(chain.apply(100), 100);
+
+    // The spike never reaches the average
+    CHECK_EQUAL(chain.apply(1000), 100);
+    CHECK_EQUAL(chain.apply(100), 100);
+
+    chain.reset();
+    CHECK_EQUAL(chain.apply(40), 40);
+}
+
+int main()
+{
+    testEma();
+    testMedian();
+    testDeadband();
+    testChain();
+
+    return SIM_TEST_RESULT();
+}
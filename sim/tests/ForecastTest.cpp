@@ -0,0 +1,142 @@
+#include "SimTest.h"
+
+#include "MicroBitSimulator.h"
+#include "controllers/forecast/MicroBitDryingForecast.h"
+
+static void testLearning()
+{
+    MicroBitDryingForecast forecast;
+
+    CHECK_EQUAL(forecast.getCost(), 0);
+
+    // Measured over MICROBIT_DRYING_LEARN_STEP points
+    forecast.update(30, 0);
+    forecast.update(29, 1000);
+    CHECK_EQUAL(forecast.getCost(), 0);
+
+    forecast.update(28, 2000);
+    CHECK_EQUAL(forecast.getCost(), 1000);
+
+    // Then averaged, a quarter of the gap each time
+    forecast.update(26, 4400);
+    CHECK_EQUAL(forecast.getCost(), 1050);
+
+    // A watering starts a new measure: the demand before it is not counted
+    forecast.update(40, 5000);
+    forecast.update(39, 6000);
+    CHECK_EQUAL(forecast.getCost(), 1050);
+
+    forecast.update(38, 6850);
+    CHECK_EQUAL(forecast.getCost(), 1050 + ((925 - 1050) >> MICROBIT_DRYING_LEARN_SHIFT));
+
+    // So does restart()
+    uint32_t cost = forecast.getCost();
+    forecast.restart();
+    forecast.update(20, 100000);
+    forecast.update(18, 100100);
+    CHECK_EQUAL(forecast.getCost(), cost + ((50 - (int32_t)cost) >> MICROBIT_DRYING_LEARN_SHIFT));
+}
+
+/**
+  * Readings back up by the noise of the filter do not start a new measure.
+  */
+static void testNoise()
+{
+    MicroBitDryingForecast forecast;
+
+    forecast.update(30, 0);
+    forecast.update(29, 1000);
+    forecast.update(29 + MICROBIT_DRYING_NOISE, 1500);
+    forecast.update(28, 2000);
+    CHECK_EQUAL(forecast.getCost(), 1000);
+
+    // A larger rise does
+    forecast.update(28 + MICROBIT_DRYING_NOISE + 1, 3000);
+    forecast.update(28 + MICROBIT_DRYING_NOISE - 1, 3400);
+    CHECK_EQUAL(forecast.getCost(), 1000 + ((200 - 1000) >> MICROBIT_DRYING_LEARN_SHIFT));
+}
+
+static void testDemandWraps()
+{
+    MicroBitDryingForecast forecast;
+
+    // The total demand wraps around
+    forecast.update(30, 0xFFFFFF00);
+    forecast.update(28, 0x00000100);
+    CHECK_EQUAL(forecast.getCost(), 0x100);
+}
+
+static void testPrediction()
+{
+    MicroBitDryingForecast forecast;
+    MicroBitEvapotranspiration et;
+
+    // Nothing known yet
+    CHECK_EQUAL(forecast.timeToThreshold(20, 10, et), MICROBIT_DRYING_UNKNOWN);
+
+    forecast.update(30, 0);
+    forecast.update(28, 2000);
+
+    // Reached
+    CHECK_EQUAL(forecast.timeToThreshold(10, 10, et), 0);
+    CHECK_EQUAL(forecast.timeToThreshold(8, 10, et), 0);
+
+    // No demand measured yet
+    CHECK_EQUAL(forecast.timeToThreshold(20, 10, et), MICROBIT_DRYING_UNKNOWN);
+
+    // Light 100 at 20 C: ((100 + 16) * (20 + 18)) >> 4 = 275 per second
+    et.update(100, 20);
+    CHECK_EQUAL(et.getRate(), 275);
+    CHECK_EQUAL(forecast.timeToThreshold(20, 10, et), 10 * 1000 / 275);
+
+    // The demand is integrated as time goes
+    sim_run(10000);
+    et.update(100, 20);
+    CHECK_EQUAL(et.getTotal(), 2750);
+
+    // Without demand the threshold is never reached within the horizon
+    et.update(0, -18);
+    CHECK_EQUAL(forecast.timeToThreshold(20, 10, et), MICROBIT_DRYING_UNKNOWN);
+}
+
+/**
+  * A pot drying at a constant demand, read every minute: the forecast converges on the
+  * time the threshold is actually reached.
+  */
+static void testConvergence()
+{
+    MicroBitDryingForecast forecast;
+    MicroBitEvapotranspiration et;
+
+    // One moisture point every 50 minutes
+    const uint32_t cost = 275 * 3000;
+
+    et.update(100, 20);
+
+    for (int minute = 0; minute <= 800; minute++)
+    {
+        int moisture = 30 - minute / 50;
+
+        et.update(100, 20);
+        forecast.update(moisture, et.getTotal());
+
+        sim_run(60000);
+    }
+
+    CHECK(forecast.getCost() > cost * 95 / 100 && forecast.getCost() < cost * 105 / 100);
+
+    // At 14, 4 points and about 200 minutes from a threshold of 10
+    uint32_t eta = forecast.timeToThreshold(14, 10, et);
+    CHECK(eta > 190 * 60 && eta < 210 * 60);
+}
+
+int main()
+{
+    testLearning();
+    testNoise();
+    testDemandWraps();
+    testPrediction();
+    testConvergence();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,204 @@
+#include <string.h>
+
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "services/history/MicroBitHistoryService.h"
+
+static MicroBitMessageBus bus;
+static BLEDevice ble;
+static MicroBitHistory history;
+static GattAttribute::Handle_t handle;
+
+static uint16_t get16(const std::vector<uint8_t> &b, int offset)
+{
+    return b[offset] | (b[offset + 1] << 8);
+}
+
+static uint32_t get32(const std::vector<uint8_t> &b, int offset)
+{
+    return get16(b, offset) | ((uint32_t)get16(b, offset + 2) << 16);
+}
+
+/**
+  * Ask for records as the peer does.
+  */
+static void request(uint32_t from, uint16_t count)
+{
+    uint8_t value[6] = { (uint8_t)from, (uint8_t)(from >> 8), (uint8_t)(from >> 16), (uint8_t)(from >> 24), (uint8_t)count, (uint8_t)(count >> 8) };
+
+    ble.simulateWrite(handle, value, sizeof(value));
+    sim_run(10);
+}
+
+/**
+  * The stream fills the radio buffers, and goes on as they are sent.
+  */
+static void testStream()
+{
+    std::vector<GattServer::Notification> &notifications = ble.gattServer().getNotifications();
+    notifications.clear();
+
+    // 3 records per chunk: a header, 14 chunks and the end chunk
+    request(0, 40);
+    CHECK_EQUAL(notifications.size(), BLE_SIM_TX_BUFFERS);
+
+    for (int i = 0; i < 10; i++)
+    {
+        ble.simulateDataSent();
+        sim_run(10);
+    }
+
+    CHECK_EQUAL(notifications.size(), 16);
+
+    if (notifications.size() != 16)
+        return;
+
+    // Header
+    CHECK_EQUAL(get16(notifications[0].value, 0), 0);
+    CHECK_EQUAL(get16(notifications[0].value, 2), 0);
+    CHECK_EQUAL(get16(notifications[0].value, 6), 40);
+
+    for (int i = 1; i < 15; i++)
+        CHECK_EQUAL(get16(notifications[i].value, 0), i);
+
+    CHECK_EQUAL(get16(notifications[15].value, 0), MICROBIT_HISTORY_CHUNK_END);
+    CHECK_EQUAL(notifications[15].value[2], MICROBIT_HISTORY_STATUS_COMPLETE);
+
+    // Nothing more once the stream is over
+    notifications.clear();
+    ble.simulateDataSent();
+    sim_run(10);
+    CHECK(notifications.empty());
+}
+
+/**
+  * Records overwritten while streaming end the stream.
+  */
+static void testOverrun()
+{
+    std::vector<GattServer::Notification> &notifications = ble.gattServer().getNotifications();
+    notifications.clear();
+
+    request(history.first(), MICROBIT_HISTORY_CAPACITY);
+    CHECK_EQUAL(notifications.size(), BLE_SIM_TX_BUFFERS);
+
+    MicroBitHistorySample sample;
+    memset(&sample, 0, sizeof(sample));
+
+    for (int i = 0; i < MICROBIT_HISTORY_CAPACITY; i++)
+        history.record(sample);
+
+    ble.simulateDataSent();
+    sim_run(10);
+
+    // The chunk that did not fit a buffer was read before the overrun
+    CHECK_EQUAL(notifications.size(), BLE_SIM_TX_BUFFERS + 2);
+    CHECK_EQUAL(get16(notifications.back().value, 0), MICROBIT_HISTORY_CHUNK_END);
+    CHECK_EQUAL(notifications.back().value[2], MICROBIT_HISTORY_STATUS_OVERRUN);
+}
+
+/**
+  * Send the radio buffers until the stream is over.
+  */
+static void drain()
+{
+    for (int i = 0; i < MICROBIT_HISTORY_CAPACITY && ble.simulateDataSent() > 0; i++)
+        sim_run(10);
+}
+
+/**
+  * Connect again, and run until the peer would have asked for records.
+  */
+static void reconnect()
+{
+    ble.simulateDisconnect();
+    sim_run(10);
+
+    ble.gattServer().getNotifications().clear();
+    ble.simulateConnect();
+    sim_run(10);
+}
+
+/**
+  * A peer that connects is sent the records it has not received, unless it asks for others.
+  */
+static void testReconnect()
+{
+    std::vector<GattServer::Notification> &notifications = ble.gattServer().getNotifications();
+
+    // The last stream was cut short: the records from the oldest kept on
+    reconnect();
+    sim_run(MICROBIT_HISTORY_SERVICE_CONNECT_DELAY - 100);
+    CHECK(notifications.empty());
+
+    sim_run(200);
+    CHECK_EQUAL(notifications.size(), BLE_SIM_TX_BUFFERS);
+
+    drain();
+    CHECK_EQUAL(get16(notifications[0].value, 0), 0);
+    CHECK_EQUAL(get32(notifications[0].value, 2), history.first());
+    CHECK_EQUAL(get16(notifications[0].value, 6), history.end() - history.first());
+    CHECK_EQUAL(get16(notifications.back().value, 0), MICROBIT_HISTORY_CHUNK_END);
+    CHECK_EQUAL(notifications.back().value[2], MICROBIT_HISTORY_STATUS_COMPLETE);
+
+    // Then only the records since
+    uint32_t end = history.end();
+
+    MicroBitHistorySample sample;
+    memset(&sample, 0, sizeof(sample));
+    history.record(sample);
+    history.record(sample);
+
+    reconnect();
+    sim_run(MICROBIT_HISTORY_SERVICE_CONNECT_DELAY + 100);
+    drain();
+
+    CHECK_EQUAL(notifications.size(), 3);
+    CHECK_EQUAL(get32(notifications[0].value, 2), end);
+    CHECK_EQUAL(get16(notifications[0].value, 6), 2);
+
+    // Nothing left to send
+    reconnect();
+    sim_run(MICROBIT_HISTORY_SERVICE_CONNECT_DELAY + 100);
+    drain();
+
+    CHECK_EQUAL(notifications.size(), 2);
+    CHECK_EQUAL(get16(notifications[0].value, 6), 0);
+
+    // A request of the peer replaces the backfill
+    reconnect();
+    request(history.first(), 1);
+    sim_run(MICROBIT_HISTORY_SERVICE_CONNECT_DELAY + 100);
+    drain();
+
+    CHECK_EQUAL(notifications.size(), 3);
+    CHECK_EQUAL(get32(notifications[0].value, 2), history.first());
+    CHECK_EQUAL(get16(notifications[0].value, 6), 1);
+}
+
+int main()
+{
+    MicroBitHistorySample sample;
+    memset(&sample, 0, sizeof(sample));
+
+    for (int i = 0; i < 40; i++)
+    {
+        sample.time = i * 300;
+        sample.moisture = 30 - i / 4;
+        history.record(sample);
+    }
+
+    MicroBitHistoryService service(ble, history);
+
+    handle = ble.gattServer().findCharacteristic(UUID(MicroBitHistoryServiceDataUUID));
+    CHECK(handle != 0);
+
+    ble.simulateConnect();
+
+    testStream();
+    testOverrun();
+    testReconnect();
+
+    return SIM_TEST_RESULT();
+}
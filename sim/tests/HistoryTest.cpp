@@ -0,0 +1,162 @@
+#include <string.h>
+
+#include "SimTest.h"
+
+#include "storage/history/MicroBitHistory.h"
+
+static MicroBitHistorySample sample(uint32_t time, int moisture, int light, int temperature, uint8_t flags = 0)
+{
+    MicroBitHistorySample s;
+
+    s.time = time;
+    s.moisture = moisture;
+    s.light = light;
+    s.temperature = temperature;
+    s.flags = flags;
+
+    return s;
+}
+
+static bool same(const MicroBitHistorySample &a, const MicroBitHistorySample &b)
+{
+    return a.time == b.time && a.moisture == b.moisture && a.light == b.light && a.temperature == b.temperature &&
+           (a.flags & ~MICROBIT_HISTORY_FLAG_KEYFRAME) == (b.flags & ~MICROBIT_HISTORY_FLAG_KEYFRAME);
+}
+
+/**
+  * Decode every record kept, as a reader does, and compare with what was recorded.
+  */
+static void checkReplay(MicroBitHistory &history, const MicroBitHistorySample *recorded, uint32_t total)
+{
+    MicroBitHistorySample state;
+    uint8_t record[MICROBIT_HISTORY_RECORD_SIZE];
+
+    CHECK_EQUAL(history.end(), total);
+    CHECK_EQUAL(history.stateBefore(history.first(), state), MICROBIT_OK);
+
+    for (uint32_t seq = history.first(); seq < history.end(); seq++)
+    {
+        CHECK_EQUAL(history.read(seq, record), MICROBIT_OK);
+        MicroBitHistory::decode(record, state);
+
+        if (!CHECK(same(state, recorded[seq])))
+            return;
+    }
+}
+
+static void testDeltas()
+{
+    MicroBitHistory history;
+    MicroBitHistorySample recorded[3];
+    uint8_t record[MICROBIT_HISTORY_RECORD_SIZE];
+
+    recorded[0] = sample(10, 30, 100, 20);
+    recorded[1] = sample(310, 29, 120, 21, MICROBIT_HISTORY_FLAG_WATERING);
+    recorded[2] = sample(610, 35, 90, 19);
+
+    for (int i = 0; i < 3; i++)
+        history.record(recorded[i]);
+
+    // The first record starts from its own state: all deltas are 0
+    CHECK_EQUAL(history.read(0, record), MICROBIT_OK);
+    CHECK_EQUAL(record[0] | (record[1] << 8), 0);
+    CHECK_EQUAL(record[2], 0);
+    CHECK_EQUAL(record[5], 0);
+
+    CHECK_EQUAL(history.read(1, record), MICROBIT_OK);
+    CHECK_EQUAL(record[0] | (record[1] << 8), 300);
+    CHECK_EQUAL((int8_t)record[2], -1);
+    CHECK_EQUAL((int8_t)record[3], 20);
+    CHECK_EQUAL((int8_t)record[4], 1);
+    CHECK_EQUAL(record[5], MICROBIT_HISTORY_FLAG_WATERING);
+
+    checkReplay(history, recorded, 3);
+
+    CHECK_EQUAL(history.read(3, record), MICROBIT_INVALID_PARAMETER);
+}
+
+static void testKeyframes()
+{
+    MicroBitHistory history;
+    MicroBitHistorySample recorded[4];
+    uint8_t record[MICROBIT_HISTORY_RECORD_SIZE];
+
+    recorded[0] = sample(0, 5, 0, -10);
+    recorded[1] = sample(300, 5, 250, -10);
+    recorded[2] = sample(600, 5, 122, 120);
+    recorded[3] = sample(900, 6, 123, 121);
+
+    for (int i = 0; i < 4; i++)
+        history.record(recorded[i]);
+
+    // Light +250, then temperature +130, do not fit an int8
+    history.read(1, record);
+    CHECK(record[5] & MICROBIT_HISTORY_FLAG_KEYFRAME);
+    CHECK_EQUAL(record[3], 250);
+
+    history.read(2, record);
+    CHECK(record[5] & MICROBIT_HISTORY_FLAG_KEYFRAME);
+
+    history.read(3, record);
+    CHECK(!(record[5] & MICROBIT_HISTORY_FLAG_KEYFRAME));
+
+    checkReplay(history, recorded, 4);
+}
+
+static void testSaturatedTime()
+{
+    MicroBitHistory history;
+    MicroBitHistorySample state;
+    uint8_t record[MICROBIT_HISTORY_RECORD_SIZE];
+
+    history.record(sample(0, 10, 10, 10));
+    history.record(sample(100000, 10, 10, 10));
+    history.record(sample(100300, 10, 10, 10));
+
+    history.read(1, record);
+    CHECK_EQUAL(record[0] | (record[1] << 8), 0xFFFF);
+
+    // The next delta is counted from the saturated time, so that the gap is not lost twice
+    history.read(2, record);
+    CHECK_EQUAL(record[0] | (record[1] << 8), 100300 - 0xFFFF);
+
+    history.stateBefore(3, state);
+    CHECK_EQUAL(state.time, 100300);
+}
+
+static void testOverwrite()
+{
+    const uint32_t total = MICROBIT_HISTORY_CAPACITY * 3 + 17;
+    static MicroBitHistorySample recorded[total];
+    MicroBitHistory history;
+    uint8_t record[MICROBIT_HISTORY_RECORD_SIZE];
+
+    for (uint32_t i = 0; i < total; i++)
+    {
+        // Mostly small steps, with a jump now and then
+        int moisture = (i % 50 == 49) ? 0 : 20 + (int)(i % 7);
+        recorded[i] = sample(i * 300, moisture, (i * 13) & 0xFF, 15 + (int)(i % 3), i % 11 == 0 ? MICROBIT_HISTORY_FLAG_WATERING : 0);
+        history.record(recorded[i]);
+    }
+
+    CHECK_EQUAL(history.first(), total - MICROBIT_HISTORY_CAPACITY);
+    CHECK_EQUAL(history.read(history.first() - 1, record), MICROBIT_INVALID_PARAMETER);
+
+    checkReplay(history, recorded, total);
+
+    // Any record kept can be the start of a download
+    MicroBitHistorySample state;
+    CHECK_EQUAL(history.stateBefore(total - 5, state), MICROBIT_OK);
+    CHECK(same(state, recorded[total - 6]));
+    CHECK_EQUAL(history.stateBefore(history.first() - 1, state), MICROBIT_INVALID_PARAMETER);
+}
+
+int main()
+{
+    testDeltas();
+    testKeyframes();
+    testSaturatedTime();
+    testOverwrite();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,197 @@
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "sensors/light/MicroBitAmbientLightSensor.h"
+
+// Raw readings of the LED columns in the dark, halfway and in full light
+#define DARK        MICROBIT_AMBIENT_LIGHT_MAX_VALUE
+#define DIM         206
+#define BRIGHT      MICROBIT_AMBIENT_LIGHT_MIN_VALUE
+
+static MicroBitMessageBus bus;
+static MicroBitDisplay display;
+static MicroBitAmbientLightSensor sensor(display);
+
+// Components taking up the idle callbacks
+static MicroBitComponent others[MICROBIT_IDLE_COMPONENTS];
+
+static int updates = 0;
+static uint64_t updateTime = 0;
+
+static void onUpdate(MicroBitEvent)
+{
+    updates++;
+    updateTime = system_timer_current_time();
+}
+
+/**
+  * Set the raw reading of every LED column.
+  */
+static void setRaw(int raw)
+{
+    for (int i = 0; i < MICROBIT_AMBIENT_LIGHT_COLUMNS; i++)
+        sim_environment().analogIn[MICROBIT_AMBIENT_LIGHT_COLUMN_START + i] = raw;
+}
+
+/**
+  * Run until the sensor takes its next reading, for two periods at most.
+  */
+static void nextSample()
+{
+    int before = updates;
+
+    for (int i = 0; i < 2 * MICROBIT_AMBIENT_LIGHT_PERIOD / 100 && updates == before; i++)
+        sim_run(100);
+
+    CHECK(updates > before);
+}
+
+/**
+  * Read a raw level until the filter has settled on it.
+  */
+static void settle(int raw)
+{
+    setRaw(raw);
+
+    for (int i = 0; i < 12; i++)
+        nextSample();
+}
+
+/**
+  * Check the filtered level: the average rounds to within 1 of the level read.
+  */
+static bool checkLevel(int expected)
+{
+    int level = sensor.getLightLevel();
+
+    return CHECK(level >= expected - 1 && level <= expected + 1);
+}
+
+/**
+  * Check the time between the next two readings. A reading is taken on a system tick after
+  * it is due, and the steps of nextSample() move the ticks by up to one more.
+  */
+static bool checkPeriod(int period)
+{
+    nextSample();
+    uint64_t start = updateTime;
+    nextSample();
+    uint64_t elapsed = updateTime - start;
+
+    return CHECK(elapsed >= (uint64_t)period && elapsed <= (uint64_t)period + 2 * SYSTEM_TICK_PERIOD_MS);
+}
+
+/**
+  * Without room for the idle callback the sensor still reads on demand, and registers on a
+  * later read once there is room.
+  */
+static void testIdleRegistration()
+{
+    for (int i = 0; i < MICROBIT_IDLE_COMPONENTS; i++)
+        CHECK_EQUAL(fiber_add_idle_component(&others[i]), MICROBIT_OK);
+
+    setRaw(DARK);
+
+    CHECK_EQUAL(sensor.updateSample(), MICROBIT_OK);
+    CHECK(!(sensor.status & MICROBIT_AMBIENT_LIGHT_ADDED_TO_IDLE));
+    CHECK_EQUAL(updates, 1);
+
+    // Nothing reads without the callback
+    sim_run(MICROBIT_AMBIENT_LIGHT_PERIOD * 2);
+    CHECK_EQUAL(updates, 1);
+
+    for (int i = 0; i < MICROBIT_IDLE_COMPONENTS; i++)
+        fiber_remove_idle_component(&others[i]);
+
+    CHECK_EQUAL(sensor.updateSample(), MICROBIT_OK);
+    CHECK(sensor.status & MICROBIT_AMBIENT_LIGHT_ADDED_TO_IDLE);
+    CHECK_EQUAL(updates, 2);
+}
+
+/**
+  * A reading maps the raw range onto 0 - 255, clamped, and leaves the display as it was.
+  */
+static void testAcquire()
+{
+    display.enable();
+
+    settle(BRIGHT);
+    checkLevel(255);
+    CHECK(display.status & MICROBIT_COMPONENT_RUNNING);
+
+    // The columns are left with their LEDs off
+    for (int i = 0; i < MICROBIT_AMBIENT_LIGHT_COLUMNS; i++)
+        CHECK_EQUAL(sim_environment().digitalOut[MICROBIT_AMBIENT_LIGHT_COLUMN_START + i], 1);
+
+    settle(DARK + 50);
+    checkLevel(0);
+
+    settle(BRIGHT - 50);
+    checkLevel(255);
+
+    display.disable();
+
+    settle(DIM);
+    checkLevel((DARK - DIM) * 255 / (DARK - BRIGHT));
+    CHECK(!(display.status & MICROBIT_COMPONENT_RUNNING));
+}
+
+/**
+  * A single spike is dropped by the median, a lasting change comes through the average
+  * in a few readings.
+  */
+static void testFilter()
+{
+    settle(DARK);
+    checkLevel(0);
+
+    setRaw(BRIGHT);
+    nextSample();
+    setRaw(DARK);
+    nextSample();
+    nextSample();
+    checkLevel(0);
+
+    // The median lets the change through on its second reading, the average halves the step
+    setRaw(BRIGHT);
+    nextSample();
+    checkLevel(0);
+    nextSample();
+    CHECK_EQUAL(sensor.getLightLevel(), 128);
+    nextSample();
+    CHECK_EQUAL(sensor.getLightLevel(), 192);
+}
+
+/**
+  * The idle callback reads once per period, and a new period applies from the next reading.
+  */
+static void testPeriod()
+{
+    CHECK_EQUAL(sensor.getPeriod(), MICROBIT_AMBIENT_LIGHT_PERIOD);
+    checkPeriod(MICROBIT_AMBIENT_LIGHT_PERIOD);
+
+    sensor.setPeriod(1000);
+    CHECK_EQUAL(sensor.getPeriod(), 1000);
+    checkPeriod(1000);
+
+    // Reads between two samples do not read again
+    nextSample();
+    sim_run(500);
+
+    int before = updates;
+    sensor.getLightLevel();
+    sensor.getLightLevel();
+    CHECK_EQUAL(updates, before);
+}
+
+int main()
+{
+    bus.listen(MICROBIT_ID_AMBIENT_LIGHT, MICROBIT_AMBIENT_LIGHT_EVT_UPDATE, onUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+
+    testIdleRegistration();
+    testAcquire();
+    testFilter();
+    testPeriod();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "sensors/moisture/MicroBitMoistureSensor.h"
+
+static MicroBitMessageBus bus;
+
+static MicroBitPin probe(MICROBIT_ID_IO_P0, MICROBIT_PIN_P0, PIN_CAPABILITY_ALL);
+static MicroBitPin excitation(MICROBIT_ID_IO_P1, MICROBIT_PIN_P1, PIN_CAPABILITY_ALL);
+
+/**
+  * A probe that returns the conversions of a burst in turn.
+  */
+class ScriptedProbe : public MicroBitSimEnvironment
+{
+    public:
+
+    int conversions[MICROBIT_MOISTURE_BURST_MAX];
+    int next;
+
+    virtual int readAnalog(int pin)
+    {
+        if (pin != MICROBIT_PIN_P0)
+            return MicroBitSimEnvironment::readAnalog(pin);
+
+        return conversions[next++ % MICROBIT_MOISTURE_BURST_MAX];
+    }
+};
+
+static ScriptedProbe script;
+
+/**
+  * Take a reading of a burst.
+  */
+static int sample(MicroBitMoistureSensor &sensor)
+{
+    script.next = 0;
+    sensor.setNextSample(0);
+    sensor.updateSample();
+
+    return sensor.getRawLevel();
+}
+
+/**
+  * Every possible sum of every burst size gives the same mean as a division.
+  */
+static void testMean()
+{
+    MicroBitMoistureSensor sensor(probe, excitation);
+
+    for (int n = 1; n <= MICROBIT_MOISTURE_BURST_MAX; n++)
+    {
+        sensor.setBurst(n, MOISTURE_REDUCTION_MEAN);
+
+        for (int sum = 0; sum <= n * 1023; sum++)
+        {
+            // Spread the sum over the conversions
+            for (int i = 0; i < n; i++)
+                script.conversions[i] = sum / n + (i < sum % n ? 1 : 0);
+
+            if (!CHECK_EQUAL(sample(sensor), sum / n))
+            {
+                fprintf(stderr, "burst of %d, sum %d\n", n, sum);
+                return;
+            }
+        }
+    }
+}
+
+/**
+  * Same for the trimmed mean, with the lowest and highest conversions at the ends of the range.
+  */
+static void testTrimmedMean()
+{
+    MicroBitMoistureSensor sensor(probe, excitation);
+
+    for (int n = 3; n <= MICROBIT_MOISTURE_BURST_MAX; n++)
+    {
+        sensor.setBurst(n, MOISTURE_REDUCTION_TRIMMED_MEAN);
+
+        int kept = n - 2;
+
+        for (int sum = 0; sum <= kept * 1023; sum++)
+        {
+            script.conversions[0] = 0;
+            script.conversions[n - 1] = 1023;
+
+            for (int i = 0; i < kept; i++)
+                script.conversions[i + 1] = sum / kept + (i < sum % kept ? 1 : 0);
+
+            if (!CHECK_EQUAL(sample(sensor), sum / kept))
+            {
+                fprintf(stderr, "trimmed burst of %d, sum %d\n", n, sum);
+                return;
+            }
+        }
+    }
+
+    // Too short to trim: plain mean
+    sensor.setBurst(2, MOISTURE_REDUCTION_TRIMMED_MEAN);
+    script.conversions[0] = 100;
+    script.conversions[1] = 201;
+    CHECK_EQUAL(sample(sensor), 150);
+
+    // Outliers are dropped
+    sensor.setBurst(5, MOISTURE_REDUCTION_TRIMMED_MEAN);
+    const int burst[] = { 400, 1023, 402, 0, 404 };
+
+    for (int i = 0; i < 5; i++)
+        script.conversions[i] = burst[i];
+
+    CHECK_EQUAL(sample(sensor), 402);
+}
+
+static void testMedian()
+{
+    MicroBitMoistureSensor sensor(probe, excitation);
+    const int burst[] = { 500, 3, 1000, 498, 501, 499, 1023 };
+
+    sensor.setBurst(7, MOISTURE_REDUCTION_MEDIAN);
+
+    for (int i = 0; i < 7; i++)
+        script.conversions[i] = burst[i];
+
+    CHECK_EQUAL(sample(sensor), 500);
+
+    CHECK_EQUAL(sensor.setBurst(0), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(sensor.setBurst(MICROBIT_MOISTURE_BURST_MAX + 1), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(sensor.getBurstSize(), 7);
+}
+
+int main()
+{
+    sim_set_environment(&script);
+
+    testMean();
+    testTrimmedMean();
+    testMedian();
+
+    return SIM_TEST_RESULT();
+}
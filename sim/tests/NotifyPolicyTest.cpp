@@ -0,0 +1,176 @@
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "services/characteristic/MicroBitCharacteristicService.h"
+
+#define MIN_INTERVAL    1000
+
+static MicroBitMessageBus bus;
+static BLEDevice ble;
+
+static const uint8_t serviceUUID[] = {
+    0x5e,0x3f,0x00,0x01,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
+
+static const uint8_t characteristicUUID[] = {
+    0x5e,0x3f,0x00,0x02,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
+
+static const uint8_t readCharacteristicUUID[] = {
+    0x5e,0x3f,0x00,0x03,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
+
+/**
+  * Read the characteristic value as a peer does.
+  */
+static int readValue(GattAttribute::Handle_t handle)
+{
+    uint8_t value[2] = { 0, 0 };
+    uint16_t len = sizeof(value);
+
+    ble.gattServer().read(handle, value, &len);
+
+    return value[0] | (value[1] << 8);
+}
+
+/**
+  * Changes within the minimum interval are held back, and the latest one is let through
+  * once the interval is over.
+  */
+static void testPolicy()
+{
+    MicroBitNotifyPolicy policy(2, MIN_INTERVAL, 0);
+
+    CHECK(policy.offer(10));
+    CHECK_EQUAL(policy.pendingDelay(), -1);
+
+    // Within the deadband
+    CHECK(!policy.offer(12));
+    CHECK_EQUAL(policy.pendingDelay(), -1);
+
+    sim_run(100);
+    CHECK(!policy.offer(20));
+    CHECK(!policy.offer(30));
+    CHECK_EQUAL(policy.pendingDelay(), MIN_INTERVAL - 100);
+    CHECK(!policy.flush());
+
+    sim_run(MIN_INTERVAL);
+    CHECK_EQUAL(policy.pendingDelay(), 0);
+    CHECK(policy.flush());
+    CHECK_EQUAL(policy.pendingDelay(), -1);
+    CHECK(!policy.flush());
+
+    // The flushed value is the last notified one
+    sim_run(MIN_INTERVAL);
+    CHECK(!policy.offer(31));
+    CHECK(policy.offer(33));
+
+    // A held back change undone within the interval is not sent
+    CHECK(!policy.offer(40));
+    CHECK_EQUAL(policy.pendingDelay(), MIN_INTERVAL);
+    CHECK(!policy.offer(34));
+    CHECK_EQUAL(policy.pendingDelay(), -1);
+
+    sim_run(MIN_INTERVAL);
+    CHECK(!policy.flush());
+    CHECK(!policy.offer(32));
+}
+
+/**
+  * The trailing value of a burst of changes is notified without a new update.
+  */
+static void testTrailing()
+{
+    MicroBitCharacteristicService<uint16_t> service(ble, serviceUUID, characteristicUUID,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, 0,
+            MicroBitNotifyPolicy(0, MIN_INTERVAL, 0));
+
+    std::vector<GattServer::Notification> &notifications = ble.gattServer().getNotifications();
+
+    ble.simulateConnect();
+    sim_run(10);
+    notifications.clear();
+
+    CHECK(service.update(10));
+    CHECK(!service.update(20));
+    CHECK(!service.update(30));
+    CHECK_EQUAL(notifications.size(), 1);
+
+    sim_run(MIN_INTERVAL / 2);
+    CHECK_EQUAL(notifications.size(), 1);
+
+    sim_run(MIN_INTERVAL);
+    CHECK_EQUAL(notifications.size(), 2);
+
+    if (notifications.size() == 2)
+        CHECK_EQUAL(notifications[1].value[0], 30);
+
+    // Nothing more waits
+    ble.simulateDataSent();
+    sim_run(MIN_INTERVAL * 2);
+    CHECK_EQUAL(notifications.size(), 2);
+
+    // A change held back when the peer leaves is dropped
+    sim_run(MIN_INTERVAL);
+    CHECK(service.update(40));
+    CHECK(!service.update(50));
+    ble.simulateDisconnect();
+    sim_run(MIN_INTERVAL * 2);
+    CHECK_EQUAL(notifications.size(), 3);
+}
+
+/**
+  * Reads return the latest value, whether it was notified, held back, offered while no
+  * peer was connected or set.
+  */
+static void testReads()
+{
+    MicroBitCharacteristicService<uint16_t> service(ble, serviceUUID, readCharacteristicUUID,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, 0,
+            MicroBitNotifyPolicy(2, MIN_INTERVAL, 0));
+
+    GattAttribute::Handle_t handle = ble.gattServer().findCharacteristic(UUID(readCharacteristicUUID));
+    CHECK(handle != 0);
+
+    std::vector<GattServer::Notification> &notifications = ble.gattServer().getNotifications();
+
+    ble.simulateDisconnect();
+    sim_run(10);
+    notifications.clear();
+
+    CHECK(!service.update(10));
+    CHECK_EQUAL(readValue(handle), 10);
+
+    ble.simulateConnect();
+    sim_run(10);
+
+    CHECK(service.update(20));
+    CHECK_EQUAL(readValue(handle), 20);
+
+    // Held back by the interval
+    CHECK(!service.update(30));
+    CHECK_EQUAL(readValue(handle), 30);
+
+    // Within the deadband
+    sim_run(MIN_INTERVAL * 2);
+    CHECK(!service.update(31));
+    CHECK_EQUAL(readValue(handle), 31);
+
+    CHECK_EQUAL(notifications.size(), 2);
+
+    // Set without notifying
+    service.set(40);
+    CHECK_EQUAL(readValue(handle), 40);
+    CHECK_EQUAL(notifications.size(), 2);
+
+    ble.simulateDisconnect();
+}
+
+int main()
+{
+    testPolicy();
+    testTrailing();
+    testReads();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,127 @@
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "utils/power/MicroBitPowerManager.h"
+
+static MicroBitMessageBus bus;
+static MicroBitDisplay display;
+static MicroBitPowerManager power(display);
+
+// System tick period set by the runtime
+static int tickPeriod;
+
+static bool displayOn()
+{
+    return display.status & MICROBIT_COMPONENT_RUNNING;
+}
+
+/**
+  * In low power mode the display, and the fast tick, run while it has a user and only then.
+  */
+static void testDisplayUsers()
+{
+    // Nothing is switched before the manager starts
+    display.enable();
+    power.acquireDisplay();
+    power.releaseDisplay();
+    CHECK(displayOn());
+    CHECK_EQUAL(system_timer_get_period(), tickPeriod);
+
+    power.setLowPower(true);
+    CHECK(!displayOn());
+    CHECK_EQUAL(system_timer_get_period(), MICROBIT_POWER_IDLE_TICK_PERIOD);
+
+    power.acquireDisplay();
+    CHECK(displayOn());
+    CHECK_EQUAL(system_timer_get_period(), tickPeriod);
+
+    // Counted: on until the last user is done
+    power.acquireDisplay();
+    power.releaseDisplay();
+    CHECK(displayOn());
+
+    power.releaseDisplay();
+    CHECK(!displayOn());
+    CHECK_EQUAL(system_timer_get_period(), MICROBIT_POWER_IDLE_TICK_PERIOD);
+
+    // A release too many is ignored
+    power.releaseDisplay();
+    power.acquireDisplay();
+    CHECK(displayOn());
+    power.releaseDisplay();
+    CHECK(!displayOn());
+
+    // Out of low power mode the display stays on
+    power.setLowPower(false);
+    CHECK(displayOn());
+    CHECK_EQUAL(system_timer_get_period(), tickPeriod);
+
+    power.releaseDisplay();
+    CHECK(displayOn());
+
+    power.setLowPower(true);
+    CHECK(!displayOn());
+}
+
+/**
+  * A fiber busy for a while, interrupted by a system tick at the end.
+  */
+static void busy()
+{
+    wait_ms(50);
+    power.systemTick();
+}
+
+/**
+  * A fiber waiting for a second.
+  */
+static void sleeper()
+{
+    fiber_sleep(1000);
+}
+
+/**
+  * The time between two ticks is accounted to the idle loop or to the fibers, whichever the
+  * tick interrupts, however long it was: the simulation skips the ticks with nothing to do,
+  * as the slow tick of the low power mode does on the device.
+  */
+static void testResidency()
+{
+    // Until the idle fiber is known, every tick is awake time
+    sim_run(100);
+    power.reset();
+
+    sim_run(10000);
+    CHECK(power.getSleepTime() > 10000 - MICROBIT_POWER_IDLE_TICK_PERIOD);
+    CHECK(power.getSleepTime() <= 10000);
+    CHECK_EQUAL(power.getAwakeTime(), 0);
+
+    create_fiber(busy);
+    sim_run(MICROBIT_POWER_IDLE_TICK_PERIOD);
+    CHECK(power.getAwakeTime() >= 50);
+    CHECK(power.getAwakeTime() < 50 + MICROBIT_POWER_IDLE_TICK_PERIOD);
+
+    uint32_t sleep = power.getSleepTime();
+    uint32_t awake = power.getAwakeTime();
+
+    // A stretch without ticks is accounted on the next one, here a fiber waking up
+    create_fiber(sleeper);
+    sim_run(1000 + MICROBIT_POWER_IDLE_TICK_PERIOD);
+    CHECK_EQUAL(power.getAwakeTime(), awake);
+    CHECK(power.getSleepTime() >= sleep + 1000);
+    CHECK(power.getSleepTime() <= sleep + 1000 + 2 * MICROBIT_POWER_IDLE_TICK_PERIOD);
+
+    power.reset();
+    CHECK_EQUAL(power.getSleepTime(), 0);
+    CHECK_EQUAL(power.getAwakeTime(), 0);
+}
+
+int main()
+{
+    tickPeriod = system_timer_get_period();
+
+    testDisplayUsers();
+    testResidency();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,174 @@
+#include <string.h>
+
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "actuators/watering/MicroBitReservoir.h"
+#include "storage/config/MicroBitConfigStore.h"
+
+static MicroBitMessageBus bus;
+
+static MicroBitFlash flash;
+
+static int updates = 0;
+static int empties = 0;
+
+static void onUpdate(MicroBitEvent)
+{
+    updates++;
+}
+
+static void onEmpty(MicroBitEvent)
+{
+    empties++;
+}
+
+/**
+  * A run draws its time at the flow rate, and the usage gives the time to empty.
+  */
+static void testDraw()
+{
+    MicroBitReservoir reservoir;
+
+    CHECK_EQUAL(reservoir.getVolume(), MICROBIT_RESERVOIR_CAPACITY);
+    CHECK_EQUAL(reservoir.getTimeToEmpty(), MICROBIT_RESERVOIR_UNKNOWN);
+
+    int before = updates;
+
+    reservoir.draw(2000);
+    CHECK_EQUAL(reservoir.getVolume(), MICROBIT_RESERVOIR_CAPACITY - 2 * MICROBIT_RESERVOIR_FLOW_RATE);
+    CHECK_EQUAL(updates, before + 1);
+
+    // A calibrated pump
+    CHECK_EQUAL(reservoir.setFlowRate(0), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(reservoir.setFlowRate(10000), MICROBIT_OK);
+
+    reservoir.draw(500);
+    CHECK_EQUAL(reservoir.getVolume(), MICROBIT_RESERVOIR_CAPACITY - 2 * MICROBIT_RESERVOIR_FLOW_RATE - 5000);
+
+    // 55 ml drawn in an hour: the rest above the reserve lasts that many hours more
+    sim_run(3600000);
+
+    uint32_t left = reservoir.getVolume() - MICROBIT_RESERVOIR_RESERVE;
+    CHECK_EQUAL(reservoir.getTimeToEmpty(), (uint64_t)left * 3600 / 55000);
+}
+
+/**
+  * A refill sets the level, at most the tank size, and starts a new usage estimate.
+  */
+static void testRefill()
+{
+    MicroBitReservoir reservoir;
+
+    reservoir.draw(10000);
+    CHECK(reservoir.getTimeToEmpty() != MICROBIT_RESERVOIR_UNKNOWN);
+
+    reservoir.refill();
+    CHECK_EQUAL(reservoir.getVolume(), MICROBIT_RESERVOIR_CAPACITY);
+    CHECK_EQUAL(reservoir.getTimeToEmpty(), MICROBIT_RESERVOIR_UNKNOWN);
+
+    reservoir.refill(500000);
+    CHECK_EQUAL(reservoir.getVolume(), 500000);
+
+    reservoir.refill(MICROBIT_RESERVOIR_CAPACITY + 1);
+    CHECK_EQUAL(reservoir.getVolume(), MICROBIT_RESERVOIR_CAPACITY);
+
+    // A smaller tank holds less
+    CHECK_EQUAL(reservoir.setCapacity(MICROBIT_RESERVOIR_RESERVE - 1), MICROBIT_INVALID_PARAMETER);
+    CHECK_EQUAL(reservoir.setCapacity(600000), MICROBIT_OK);
+    CHECK_EQUAL(reservoir.getCapacity(), 600000);
+    CHECK_EQUAL(reservoir.getVolume(), 600000);
+
+    reservoir.refill();
+    CHECK_EQUAL(reservoir.getVolume(), 600000);
+}
+
+/**
+  * The water above the reserve bounds the runs; once the level reaches the reserve the
+  * tank is empty for the pump.
+  */
+static void testReserve()
+{
+    MicroBitReservoir reservoir;
+
+    reservoir.refill(MICROBIT_RESERVOIR_RESERVE + MICROBIT_RESERVOIR_FLOW_RATE);
+    CHECK(reservoir.enoughWater());
+    CHECK_EQUAL(reservoir.getRunTime(), 1000);
+
+    int before = empties;
+
+    reservoir.draw(400);
+    CHECK_EQUAL(reservoir.getRunTime(), 600);
+    CHECK_EQUAL(empties, before);
+
+    reservoir.draw(600);
+    CHECK_EQUAL(reservoir.getVolume(), MICROBIT_RESERVOIR_RESERVE);
+    CHECK(!reservoir.enoughWater());
+    CHECK_EQUAL(reservoir.getRunTime(), 0);
+    CHECK_EQUAL(reservoir.getTimeToEmpty(), 0);
+    CHECK_EQUAL(empties, before + 1);
+
+    // A run past the bottom of the tank empties it, no more
+    reservoir.draw(MICROBIT_RESERVOIR_RESERVE * 1000 / MICROBIT_RESERVOIR_FLOW_RATE + 1000);
+    CHECK_EQUAL(reservoir.getVolume(), 0);
+}
+
+/**
+  * The state saved in the config store restores the level, the tank and the usage estimate;
+  * a state out of range restores within range.
+  */
+static void testSaveRestore()
+{
+    uint32_t *pages = sim_flash_page(MICROBIT_SIM_FLASH_PAGES);
+
+    MicroBitReservoir reservoir;
+    reservoir.setCapacity(2000000);
+    reservoir.setFlowRate(30000);
+    reservoir.refill(1500000);
+    reservoir.draw(3000);
+    sim_run(60000);
+    reservoir.getTimeToEmpty();
+
+    MicroBitConfigStore store(flash, pages);
+    store.load();
+
+    MicroBitConfigData data = store.get();
+    data.reservoir = reservoir.getState();
+    store.update(data);
+    store.commit();
+
+    MicroBitConfigStore reloaded(flash, pages);
+    CHECK_EQUAL(reloaded.load(), MICROBIT_OK);
+
+    MicroBitReservoir restored;
+    restored.setState(reloaded.get().reservoir);
+
+    CHECK_EQUAL(restored.getVolume(), 1500000 - 90000);
+    CHECK_EQUAL(restored.getCapacity(), 2000000);
+    CHECK_EQUAL(restored.getFlowRate(), 30000);
+    CHECK_EQUAL(restored.getTimeToEmpty(), reservoir.getTimeToEmpty());
+    CHECK_EQUAL(memcmp(&restored.getState(), &reservoir.getState(), sizeof(MicroBitReservoirState)), 0);
+
+    MicroBitReservoirState bad;
+    memset(&bad, 0xFF, sizeof(bad));
+    bad.flowRate = 0;
+    bad.capacity = MICROBIT_RESERVOIR_RESERVE - 1;
+
+    restored.setState(bad);
+    CHECK_EQUAL(restored.getFlowRate(), MICROBIT_RESERVOIR_FLOW_RATE);
+    CHECK_EQUAL(restored.getCapacity(), MICROBIT_RESERVOIR_CAPACITY);
+    CHECK_EQUAL(restored.getVolume(), MICROBIT_RESERVOIR_CAPACITY);
+}
+
+int main()
+{
+    bus.listen(MICROBIT_ID_RESERVOIR, MICROBIT_RESERVOIR_EVT_UPDATE, onUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+    bus.listen(MICROBIT_ID_RESERVOIR, MICROBIT_RESERVOIR_EVT_EMPTY, onEmpty, MESSAGE_BUS_LISTENER_IMMEDIATE);
+
+    testDraw();
+    testRefill();
+    testReserve();
+    testSaveRestore();
+
+    return SIM_TEST_RESULT();
+}
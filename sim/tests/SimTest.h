@@ -0,0 +1,51 @@
+#ifndef SIM_TEST_H
+#define SIM_TEST_H
+
+#include <stdio.h>
+
+/**
+  * Minimal checks for the host tests: a failed check is reported and the test goes on,
+  * SIM_TEST_RESULT() is the exit code of the test program.
+  */
+
+static int simTestChecks = 0;
+static int simTestFailures = 0;
+
+static inline bool simTestCheck(bool ok, const char *file, int line, const char *expression)
+{
+    simTestChecks++;
+
+    if (!ok)
+    {
+        simTestFailures++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    }
+
+    return ok;
+}
+
+static inline bool simTestCheckEqual(long long actual, long long expected, const char *file, int line, const char *expression)
+{
+    simTestChecks++;
+
+    if (actual != expected)
+    {
+        simTestFailures++;
+        fprintf(stderr, "%s:%d: check failed: %s is %lld, expected %lld\n", file, line, expression, actual, expected);
+    }
+
+    return actual == expected;
+}
+
+static inline int simTestResult(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, simTestChecks, simTestFailures);
+
+    return simTestFailures ? 1 : 0;
+}
+
+#define CHECK(c)                simTestCheck((c), __FILE__, __LINE__, #c)
+#define CHECK_EQUAL(a, b)       simTestCheckEqual((long long)(a), (long long)(b), __FILE__, __LINE__, #a)
+#define SIM_TEST_RESULT()       simTestResult(__FILE__)
+
+#endif
@@ -0,0 +1,200 @@
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "actuators/watering/MicroBitWateringActuator.h"
+
+static MicroBitMessageBus bus;
+
+static MicroBitPin pump(MICROBIT_ID_IO_P8, MICROBIT_PIN_P8, PIN_CAPABILITY_ALL);
+
+static MicroBitReservoir reservoir;
+static MicroBitWateringActuator actuator(pump, reservoir);
+
+/**
+  * The level last written to the pump pin.
+  */
+static int pumpLevel()
+{
+    return sim_environment().digitalOut[MICROBIT_PIN_P8];
+}
+
+static int updates = 0;
+static int soaked = 0;
+
+static void onUpdate(MicroBitEvent)
+{
+    updates++;
+}
+
+static void onSoaked(MicroBitEvent)
+{
+    soaked++;
+}
+
+/**
+  * Check that a run lasted about length ms: it ends on the first system tick after its end.
+  */
+static bool checkPulse(uint32_t length)
+{
+    uint32_t pulse = actuator.getPulseLength();
+
+    return CHECK(pulse >= length && pulse <= length + SYSTEM_TICK_PERIOD_MS);
+}
+
+/**
+  * A run goes on, soaks in and goes off, firing an update on each pump change and a
+  * soaked event at the end, and draws its water from the tank.
+  */
+static void testSequence()
+{
+    reservoir.refill();
+    uint32_t volume = reservoir.getVolume();
+
+    int before = updates;
+
+    CHECK_EQUAL(actuator.startWatering(1000, 2000), MICROBIT_OK);
+    CHECK(actuator.isWatering());
+    CHECK_EQUAL(pumpLevel(), 1);
+    CHECK_EQUAL(updates, before + 1);
+
+    // Only one run at a time
+    CHECK_EQUAL(actuator.startWatering(1000, 2000), MICROBIT_BUSY);
+
+    sim_run(1100);
+    CHECK(actuator.isSoaking());
+    CHECK_EQUAL(pumpLevel(), 0);
+    CHECK_EQUAL(updates, before + 2);
+    CHECK_EQUAL(soaked, 0);
+    checkPulse(1000);
+
+    sim_run(2000);
+    CHECK(!actuator.isWatering());
+    CHECK(!actuator.isSoaking());
+    CHECK_EQUAL(soaked, 1);
+
+    CHECK_EQUAL(reservoir.getVolume(), volume - actuator.getPulseLength() * MICROBIT_RESERVOIR_FLOW_RATE / 1000);
+}
+
+/**
+  * A stopped run still soaks in, an aborted one does not, and a soak can be aborted too.
+  */
+static void testStopAndAbort()
+{
+    soaked = 0;
+
+    CHECK_EQUAL(actuator.startWatering(5000, 2000), MICROBIT_OK);
+    sim_run(500);
+    actuator.stopWatering();
+    CHECK(actuator.isSoaking());
+    CHECK_EQUAL(pumpLevel(), 0);
+    CHECK(actuator.getPulseLength() < 1000);
+
+    sim_run(1000);
+    CHECK(actuator.isSoaking());
+    CHECK_EQUAL(soaked, 0);
+
+    sim_run(1100);
+    CHECK(!actuator.isSoaking());
+    CHECK_EQUAL(soaked, 1);
+
+    CHECK_EQUAL(actuator.startWatering(5000, 2000), MICROBIT_OK);
+    sim_run(500);
+    actuator.abortWatering();
+    CHECK(!actuator.isWatering());
+    CHECK(!actuator.isSoaking());
+    CHECK_EQUAL(pumpLevel(), 0);
+
+    sim_run(100);
+    CHECK_EQUAL(soaked, 2);
+
+    CHECK_EQUAL(actuator.startWatering(500, 5000), MICROBIT_OK);
+    sim_run(600);
+    CHECK(actuator.isSoaking());
+    actuator.abortWatering();
+    CHECK(!actuator.isSoaking());
+
+    sim_run(100);
+    CHECK_EQUAL(soaked, 3);
+
+    // Nothing to stop
+    actuator.stopWatering();
+    actuator.abortWatering();
+    sim_run(100);
+    CHECK_EQUAL(soaked, 3);
+}
+
+/**
+  * Only a running pump is extended, and never beyond MICROBIT_WATERING_MAX_PULSE in all.
+  */
+static void testExtend()
+{
+    CHECK_EQUAL(actuator.extendWatering(1000), MICROBIT_INVALID_PARAMETER);
+
+    CHECK_EQUAL(actuator.startWatering(1000), MICROBIT_OK);
+    sim_run(500);
+    CHECK_EQUAL(actuator.extendWatering(1000), MICROBIT_OK);
+    CHECK_EQUAL(actuator.getPulseLength(), 2000);
+
+    sim_run(1000);
+    CHECK(actuator.isWatering());
+
+    sim_run(600);
+    CHECK(!actuator.isWatering());
+    checkPulse(2000);
+
+    CHECK_EQUAL(actuator.startWatering(MICROBIT_WATERING_MAX_PULSE + 1000), MICROBIT_OK);
+    CHECK_EQUAL(actuator.getPulseLength(), MICROBIT_WATERING_MAX_PULSE);
+
+    CHECK_EQUAL(actuator.extendWatering(1000), MICROBIT_OK);
+    CHECK_EQUAL(actuator.getPulseLength(), MICROBIT_WATERING_MAX_PULSE);
+
+    sim_run(MICROBIT_WATERING_MAX_PULSE + 100);
+    CHECK(!actuator.isWatering());
+    checkPulse(MICROBIT_WATERING_MAX_PULSE);
+}
+
+/**
+  * A run is cut to the water left above the reserve, and none starts once the tank is down
+  * to the reserve, extended or not.
+  */
+static void testReserve()
+{
+    // Two seconds of pumping above the reserve
+    reservoir.refill(MICROBIT_RESERVOIR_RESERVE + 2 * MICROBIT_RESERVOIR_FLOW_RATE);
+
+    CHECK_EQUAL(actuator.startWatering(1000), MICROBIT_OK);
+    CHECK_EQUAL(actuator.extendWatering(5000), MICROBIT_OK);
+    CHECK_EQUAL(actuator.getPulseLength(), 2000);
+
+    sim_run(2100);
+    CHECK(!actuator.isWatering());
+    CHECK(!actuator.enoughWater());
+
+    // Overrun by at most a tick
+    CHECK(reservoir.getVolume() >= MICROBIT_RESERVOIR_RESERVE - SYSTEM_TICK_PERIOD_MS * MICROBIT_RESERVOIR_FLOW_RATE / 1000);
+
+    CHECK_EQUAL(actuator.startWatering(1000), MICROBIT_NO_RESOURCES);
+    CHECK(!actuator.isWatering());
+    CHECK_EQUAL(pumpLevel(), 0);
+
+    reservoir.refill(MICROBIT_RESERVOIR_RESERVE + MICROBIT_RESERVOIR_FLOW_RATE);
+
+    CHECK_EQUAL(actuator.startWatering(5000), MICROBIT_OK);
+    CHECK_EQUAL(actuator.getPulseLength(), 1000);
+
+    sim_run(1100);
+    CHECK(!actuator.isWatering());
+}
+
+int main()
+{
+    bus.listen(actuator.id, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE, onUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+    bus.listen(actuator.id, MICROBIT_WATERING_ACTUATOR_EVT_SOAKED, onSoaked, MESSAGE_BUS_LISTENER_IMMEDIATE);
+
+    testSequence();
+    testStopAndAbort();
+    testExtend();
+    testReserve();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,121 @@
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "controllers/zones/MicroBitZoneScheduler.h"
+
+#define ZONES   3
+
+// Time a probe read takes before the update is fired, in ms: the probe settles for up to
+// MICROBIT_MOISTURE_SETTLE_MAX us before the conversions
+#define READ_TIME   4
+
+static MicroBitMessageBus bus;
+
+static MicroBitPin probe0(MICROBIT_ID_IO_P0, MICROBIT_PIN_P0, PIN_CAPABILITY_ALL);
+static MicroBitPin probe1(MICROBIT_ID_IO_P3, MICROBIT_PIN_P3, PIN_CAPABILITY_ALL);
+static MicroBitPin probe2(MICROBIT_ID_IO_P4, MICROBIT_PIN_P4, PIN_CAPABILITY_ALL);
+static MicroBitPin excitation(MICROBIT_ID_IO_P1, MICROBIT_PIN_P1, PIN_CAPABILITY_ALL);
+static MicroBitPin pump0(MICROBIT_ID_IO_P2, MICROBIT_PIN_P2, PIN_CAPABILITY_ALL);
+static MicroBitPin pump1(MICROBIT_ID_IO_P8, MICROBIT_PIN_P8, PIN_CAPABILITY_ALL);
+static MicroBitPin pump2(MICROBIT_ID_IO_P12, MICROBIT_PIN_P12, PIN_CAPABILITY_ALL);
+
+static MicroBitReservoir reservoir;
+
+static MicroBitMoistureSensor sensors[ZONES] = {
+    { probe0, excitation, MICROBIT_ID_ZONE_MOISTURE(0) },
+    { probe1, excitation, MICROBIT_ID_ZONE_MOISTURE(1) },
+    { probe2, excitation, MICROBIT_ID_ZONE_MOISTURE(2) }
+};
+
+static MicroBitWateringActuator actuators[ZONES] = {
+    { pump0, reservoir, MICROBIT_ID_ZONE_WATERING(0) },
+    { pump1, reservoir, MICROBIT_ID_ZONE_WATERING(1) },
+    { pump2, reservoir, MICROBIT_ID_ZONE_WATERING(2) }
+};
+
+static MicroBitZoneScheduler scheduler(sensors, actuators, ZONES, 1);
+
+static int samples[ZONES];
+static int misplaced[ZONES];
+
+static void onSample(MicroBitEvent e)
+{
+    int zone = scheduler.zoneOf(e.source);
+    int offset = (MICROBIT_ZONES_FRAME * zone) / ZONES;
+
+    samples[zone]++;
+
+    // Taken in the first system tick of the slot
+    if ((system_timer_current_time() + MICROBIT_ZONES_FRAME - offset) % MICROBIT_ZONES_FRAME >= SYSTEM_TICK_PERIOD_MS + READ_TIME)
+        misplaced[zone]++;
+}
+
+/**
+  * Every sample of a sensor is taken in the slot of its zone, whatever its period. The
+  * simulation skips the ticks between the samples.
+  */
+static void testInterleave()
+{
+    const int periods[ZONES] = { 1000, 1700, 2300 };
+
+    scheduler.interleave();
+
+    for (int i = 0; i < ZONES; i++)
+    {
+        bus.listen(sensors[i].id, MICROBIT_MOISTURE_EVT_UPDATE, onSample, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        sensors[i].setPeriod(periods[i]);
+        sensors[i].setNextSample(0);
+        sensors[i].updateSample();
+    }
+
+    uint64_t ticks = sim_ticks();
+    sim_run(60000);
+
+    for (int i = 0; i < ZONES; i++)
+    {
+        // Each sample is late by less than a frame
+        CHECK(samples[i] > 60000 / (periods[i] + MICROBIT_ZONES_FRAME));
+        CHECK_EQUAL(misplaced[i], 0);
+    }
+
+    CHECK(sim_ticks() - ticks < 60000 / SYSTEM_TICK_PERIOD_MS / 10);
+
+    // A sample asked for now waits for the slot
+    sensors[1].setNextSample(0);
+    sim_run(MICROBIT_ZONES_FRAME);
+    CHECK_EQUAL(misplaced[1], 0);
+}
+
+/**
+  * A single pump runs at a time, the others wait their turn.
+  */
+static void testPumps()
+{
+    scheduler.start();
+
+    for (int i = 0; i < ZONES; i++)
+        CHECK_EQUAL(scheduler.request(i, 1000, 0), MICROBIT_OK);
+
+    CHECK(actuators[0].isWatering());
+    CHECK(scheduler.isWaiting(1));
+    CHECK(scheduler.isWaiting(2));
+    CHECK_EQUAL(scheduler.request(1, 1000, 0), MICROBIT_BUSY);
+
+    sim_run(1100);
+    CHECK(!actuators[0].isWatering());
+    CHECK(actuators[1].isWatering());
+    CHECK(scheduler.isWaiting(2));
+
+    scheduler.cancel(2);
+    sim_run(1100);
+    CHECK(!actuators[1].isWatering());
+    CHECK(!actuators[2].isWatering());
+}
+
+int main()
+{
+    testInterleave();
+    testPumps();
+
+    return SIM_TEST_RESULT();
+}
@@ -0,0 +1,125 @@
+#include "SimTest.h"
+
+#include "MicroBit.h"
+#include "controllers/zones/MicroBitZoneScheduler.h"
+
+#define ZONES   5
+
+static MicroBitMessageBus bus;
+
+static MicroBitPin probe0(MICROBIT_ID_IO_P0, MICROBIT_PIN_P0, PIN_CAPABILITY_ALL);
+static MicroBitPin probe1(MICROBIT_ID_IO_P3, MICROBIT_PIN_P3, PIN_CAPABILITY_ALL);
+static MicroBitPin probe2(MICROBIT_ID_IO_P4, MICROBIT_PIN_P4, PIN_CAPABILITY_ALL);
+static MicroBitPin probe3(MICROBIT_ID_IO_P10, MICROBIT_PIN_P10, PIN_CAPABILITY_ALL);
+static MicroBitPin probe4(MICROBIT_ID_IO_P2, MICROBIT_PIN_P2, PIN_CAPABILITY_ALL);
+static MicroBitPin excitation(MICROBIT_ID_IO_P1, MICROBIT_PIN_P1, PIN_CAPABILITY_ALL);
+static MicroBitPin pump0(MICROBIT_ID_IO_P8, MICROBIT_PIN_P8, PIN_CAPABILITY_ALL);
+static MicroBitPin pump1(MICROBIT_ID_IO_P12, MICROBIT_PIN_P12, PIN_CAPABILITY_ALL);
+static MicroBitPin pump2(MICROBIT_ID_IO_P13, MICROBIT_PIN_P13, PIN_CAPABILITY_ALL);
+static MicroBitPin pump3(MICROBIT_ID_IO_P14, MICROBIT_PIN_P14, PIN_CAPABILITY_ALL);
+static MicroBitPin pump4(MICROBIT_ID_IO_P15, MICROBIT_PIN_P15, PIN_CAPABILITY_ALL);
+
+static MicroBitReservoir reservoir;
+
+static MicroBitMoistureSensor sensors[ZONES] = {
+    { probe0, excitation, MICROBIT_ID_ZONE_MOISTURE(0) },
+    { probe1, excitation, MICROBIT_ID_ZONE_MOISTURE(1) },
+    { probe2, excitation, MICROBIT_ID_ZONE_MOISTURE(2) },
+    { probe3, excitation, MICROBIT_ID_ZONE_MOISTURE(3) },
+    { probe4, excitation, MICROBIT_ID_ZONE_MOISTURE(4) }
+};
+
+static MicroBitWateringActuator actuators[ZONES] = {
+    { pump0, reservoir, MICROBIT_ID_ZONE_WATERING(0) },
+    { pump1, reservoir, MICROBIT_ID_ZONE_WATERING(1) },
+    { pump2, reservoir, MICROBIT_ID_ZONE_WATERING(2) },
+    { pump3, reservoir, MICROBIT_ID_ZONE_WATERING(3) },
+    { pump4, reservoir, MICROBIT_ID_ZONE_WATERING(4) }
+};
+
+static MicroBitZoneScheduler scheduler(sensors, actuators, ZONES, 1);
+
+// Components standing for the rest of the firmware, e.g. the message bus and the thermometer
+static MicroBitComponent others[MICROBIT_IDLE_COMPONENTS - 1];
+
+static int samples[ZONES];
+static int soaked[ZONES];
+
+static void onSample(MicroBitEvent e)
+{
+    samples[scheduler.zoneOf(e.source)]++;
+}
+
+static void onSoaked(MicroBitEvent e)
+{
+    soaked[scheduler.zoneOf(e.source)]++;
+}
+
+/**
+  * With a single idle component left for the zones, every zone still samples, and a watering
+  * of each runs and soaks in to completion. The zones are brought up in the order of the
+  * example: the scheduler starts before the sensors are configured, since configuring a
+  * sensor takes a sample.
+  */
+static void testWatering()
+{
+    for (int i = 0; i < MICROBIT_IDLE_COMPONENTS - 1; i++)
+        CHECK_EQUAL(fiber_add_idle_component(&others[i]), MICROBIT_OK);
+
+    scheduler.interleave();
+    CHECK_EQUAL(scheduler.start(), MICROBIT_OK);
+
+    for (int i = 0; i < ZONES; i++)
+    {
+        sensors[i].setBurst(4, MOISTURE_REDUCTION_TRIMMED_MEAN);
+        sensors[i].setPeriod(1000);
+        sensors[i].setTemperatureCompensation(20);
+    }
+
+    for (int i = 0; i < ZONES; i++)
+    {
+        bus.listen(sensors[i].id, MICROBIT_MOISTURE_EVT_UPDATE, onSample, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        bus.listen(actuators[i].id, MICROBIT_WATERING_ACTUATOR_EVT_SOAKED, onSoaked, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        sensors[i].updateSample();
+    }
+
+    uint32_t volume = reservoir.getVolume();
+
+    for (int i = 0; i < ZONES; i++)
+        CHECK_EQUAL(scheduler.request(i, 1000, 2000), MICROBIT_OK);
+
+    CHECK(actuators[0].isWatering());
+
+    for (int i = 1; i < ZONES; i++)
+        CHECK(scheduler.isWaiting(i));
+
+    // One pump at a time, in turn
+    sim_run(100);
+
+    for (int i = 1; i < ZONES; i++)
+    {
+        sim_run(1000);
+        CHECK(actuators[i - 1].isSoaking());
+        CHECK(actuators[i].isWatering());
+    }
+
+    sim_run(4000);
+
+    for (int i = 0; i < ZONES; i++)
+    {
+        CHECK(!actuators[i].isWatering());
+        CHECK(!actuators[i].isSoaking());
+        CHECK_EQUAL(soaked[i], 1);
+        CHECK(samples[i] >= 4);
+    }
+
+    // Every run drew from the tank
+    CHECK(reservoir.getVolume() < volume);
+}
+
+int main()
+{
+    testWatering();
+
+    return SIM_TEST_RESULT();
+}
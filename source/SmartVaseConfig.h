@@ -0,0 +1,55 @@
+#ifndef SMART_VASE_CONFIG_H
+#define SMART_VASE_CONFIG_H
+
+#include "MicroBitConfig.h"
+
+/**
+  * Compile time options for the Giò SmartVase firmware.
+  *
+  * Each option can be overridden from config.json, under the "gio-smart-vase" key,
+  * in the same way microbit-dal options are set under "microbit-dal".
+  */
+
+// Enable timing of the sensor-to-notify path. Results are reported over serial.
+// Set to '1' to enable.
+#ifdef YOTTA_CFG_GIO_SMART_VASE_PROFILING
+#define SMART_VASE_PROFILING                    YOTTA_CFG_GIO_SMART_VASE_PROFILING
+#else
+#define SMART_VASE_PROFILING                    0
+#endif
+
+// Period (in ms) at which profiling results are reported over serial.
+#ifdef YOTTA_CFG_GIO_SMART_VASE_PROFILING_PERIOD
+#define SMART_VASE_PROFILING_PERIOD             YOTTA_CFG_GIO_SMART_VASE_PROFILING_PERIOD
+#else
+#define SMART_VASE_PROFILING_PERIOD             60000
+#endif
+
+// Enable the telemetry service, that notifies all the readings in a single characteristic.
+// The per-reading services are always available.
+// Set to '1' to enable.
+#ifdef YOTTA_CFG_GIO_SMART_VASE_TELEMETRY_SERVICE
+#define SMART_VASE_TELEMETRY_SERVICE            YOTTA_CFG_GIO_SMART_VASE_TELEMETRY_SERVICE
+#else
+#define SMART_VASE_TELEMETRY_SERVICE            0
+#endif
+
+// Switch the display off between readings and slow down the system tick, to save battery.
+// The display is still used to show the watering and the messages.
+// Set to '1' to enable.
+#ifdef YOTTA_CFG_GIO_SMART_VASE_LOW_POWER
+#define SMART_VASE_LOW_POWER                    YOTTA_CFG_GIO_SMART_VASE_LOW_POWER
+#else
+#define SMART_VASE_LOW_POWER                    0
+#endif
+
+// Default temperature compensation of the moisture readings, in 1/1024 of the reading per
+// degree Celsius; can be changed at run time. Resistive probes in soil typically read about
+// 2% more per degree, i.e. 20. Set to '0' to disable.
+#ifdef YOTTA_CFG_GIO_SMART_VASE_MOISTURE_COMPENSATION
+#define SMART_VASE_MOISTURE_COMPENSATION        YOTTA_CFG_GIO_SMART_VASE_MOISTURE_COMPENSATION
+#else
+#define SMART_VASE_MOISTURE_COMPENSATION        0
+#endif
+
+#endif
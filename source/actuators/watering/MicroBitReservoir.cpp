@@ -0,0 +1,217 @@
+#include "MicroBitConfig.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitReservoir.h"
+
+/**
+  * Constructor.
+  * Create a representation of a full reservoir with the default size and flow rate.
+  */
+MicroBitReservoir::MicroBitReservoir()
+{
+    state.volume = MICROBIT_RESERVOIR_CAPACITY;
+    state.capacity = MICROBIT_RESERVOIR_CAPACITY;
+    state.flowRate = MICROBIT_RESERVOIR_FLOW_RATE;
+    state.drawn = 0;
+    state.elapsed = 0;
+
+    lastTick = 0;
+}
+
+/**
+  * Returns the state, to be saved.
+  */
+const MicroBitReservoirState &MicroBitReservoir::getState()
+{
+    return state;
+}
+
+/**
+  * Restore a saved state.
+  *
+  * @param saved the state returned by getState before the reset.
+  */
+void MicroBitReservoir::setState(const MicroBitReservoirState &saved)
+{
+    state = saved;
+
+    if (state.flowRate == 0)
+        state.flowRate = MICROBIT_RESERVOIR_FLOW_RATE;
+
+    if (state.capacity < MICROBIT_RESERVOIR_RESERVE)
+        state.capacity = MICROBIT_RESERVOIR_CAPACITY;
+
+    if (state.volume > state.capacity)
+        state.volume = state.capacity;
+
+    lastTick = system_timer_current_time();
+}
+
+/**
+  * Account for a pump run.
+  *
+  * @param duration how long the pump ran, in ms.
+  */
+void MicroBitReservoir::draw(uint32_t duration)
+{
+    uint32_t used = ((uint64_t)duration * state.flowRate) / 1000;
+
+    if (used > state.volume)
+        used = state.volume;
+
+    tick();
+
+    state.volume -= used;
+    state.drawn += used;
+
+    changed();
+}
+
+/**
+  * Set the level after a refill.
+  *
+  * @param volume the water in the tank, in ul. Defaults to a full tank.
+  */
+void MicroBitReservoir::refill(uint32_t volume)
+{
+    if (volume > state.capacity)
+        volume = state.capacity;
+
+    state.volume = volume;
+
+    // Start a new usage estimate
+    state.drawn = 0;
+    state.elapsed = 0;
+    lastTick = system_timer_current_time();
+
+    changed();
+}
+
+/**
+  * Set the tank size.
+  *
+  * @param capacity the tank size, in ul.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if capacity is below the reserve.
+  */
+int MicroBitReservoir::setCapacity(uint32_t capacity)
+{
+    if (capacity < MICROBIT_RESERVOIR_RESERVE)
+        return MICROBIT_INVALID_PARAMETER;
+
+    state.capacity = capacity;
+
+    if (state.volume > capacity)
+        state.volume = capacity;
+
+    changed();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Set the calibrated flow rate of the pump.
+  *
+  * @param flowRate the water pumped per second, in ul.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if flowRate is 0.
+  */
+int MicroBitReservoir::setFlowRate(uint32_t flowRate)
+{
+    if (flowRate == 0)
+        return MICROBIT_INVALID_PARAMETER;
+
+    state.flowRate = flowRate;
+
+    changed();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Returns the water in the tank, in ul.
+  */
+uint32_t MicroBitReservoir::getVolume()
+{
+    return state.volume;
+}
+
+/**
+  * Returns the tank size, in ul.
+  */
+uint32_t MicroBitReservoir::getCapacity()
+{
+    return state.capacity;
+}
+
+/**
+  * Returns the flow rate of the pump, in ul/s.
+  */
+uint32_t MicroBitReservoir::getFlowRate()
+{
+    return state.flowRate;
+}
+
+/**
+  * Returns how long the pump can run before the level reaches the reserve, in ms.
+  */
+uint32_t MicroBitReservoir::getRunTime()
+{
+    if (!enoughWater())
+        return 0;
+
+    uint64_t time = ((uint64_t)(state.volume - MICROBIT_RESERVOIR_RESERVE) * 1000) / state.flowRate;
+
+    return time > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)time;
+}
+
+/**
+  * Returns the estimated time before the level reaches the reserve at the current usage,
+  * in seconds, or MICROBIT_RESERVOIR_UNKNOWN if no water was used since the last refill.
+  */
+uint32_t MicroBitReservoir::getTimeToEmpty()
+{
+    if (!enoughWater())
+        return 0;
+
+    if (state.drawn == 0)
+        return MICROBIT_RESERVOIR_UNKNOWN;
+
+    tick();
+
+    uint64_t time = ((uint64_t)(state.volume - MICROBIT_RESERVOIR_RESERVE) * state.elapsed) / state.drawn;
+
+    return time >= MICROBIT_RESERVOIR_UNKNOWN ? MICROBIT_RESERVOIR_UNKNOWN - 1 : (uint32_t)time;
+}
+
+/**
+  * Returns true if there is water above the reserve.
+  */
+bool MicroBitReservoir::enoughWater()
+{
+    return state.volume > MICROBIT_RESERVOIR_RESERVE;
+}
+
+/**
+  * Add the uptime since the last call to the usage time.
+  */
+void MicroBitReservoir::tick()
+{
+    uint64_t now = system_timer_current_time();
+    uint32_t seconds = (now - lastTick) / 1000;
+
+    // Keep the remainder for the next call
+    state.elapsed += seconds;
+    lastTick += (uint64_t)seconds * 1000;
+}
+
+/**
+  * Fire the update event, and the empty event if the level reached the reserve.
+  */
+void MicroBitReservoir::changed()
+{
+    MicroBitEvent(MICROBIT_ID_RESERVOIR, MICROBIT_RESERVOIR_EVT_UPDATE);
+
+    if (!enoughWater())
+        MicroBitEvent(MICROBIT_ID_RESERVOIR, MICROBIT_RESERVOIR_EVT_EMPTY);
+}
+
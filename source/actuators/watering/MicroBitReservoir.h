@@ -0,0 +1,153 @@
+#ifndef MICROBIT_RESERVOIR_H
+#define MICROBIT_RESERVOIR_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitEvent.h"
+
+#define MICROBIT_ID_RESERVOIR                   1236
+#define MICROBIT_RESERVOIR_EVT_UPDATE           1
+#define MICROBIT_RESERVOIR_EVT_EMPTY            2
+
+// Default tank size and pump flow rate, in ul and ul/s
+#define MICROBIT_RESERVOIR_CAPACITY             1000000
+#define MICROBIT_RESERVOIR_FLOW_RATE            25000
+
+// Water left in the tank to keep the pump submerged, in ul
+#define MICROBIT_RESERVOIR_RESERVE              100000
+
+// Time to empty when there is no usage to estimate it from
+#define MICROBIT_RESERVOIR_UNKNOWN              0xFFFFFFFF
+
+/**
+  * State of the reservoir, as kept across resets.
+  */
+struct MicroBitReservoirState
+{
+    // Water in the tank, tank size and flow rate of the pump, in ul and ul/s
+    uint32_t    volume;
+    uint32_t    capacity;
+    uint32_t    flowRate;
+
+    // Water pumped and seconds of uptime since the last refill, to estimate the usage
+    uint32_t    drawn;
+    uint32_t    elapsed;
+};
+
+/**
+  * Class definition for MicroBitReservoir.
+  *
+  * Models the water tank the pumps draw from: every pump run removes its length times the
+  * calibrated flow rate of the pump, so the level stays right whatever the pulse lengths are.
+  * The time to empty is estimated from the water used since the last refill.
+  *
+  * The state is meant to be saved after every MICROBIT_RESERVOIR_EVT_UPDATE, so it survives
+  * resets (see MicroBitConfigStore); the uptime is only updated on changes, so the time the
+  * board spends off, and since the last change before a reset, is not counted as usage time.
+  *
+  * MICROBIT_RESERVOIR_EVT_UPDATE is fired after every change of the level, and
+  * MICROBIT_RESERVOIR_EVT_EMPTY when the level reaches the reserve.
+  */
+class MicroBitReservoir
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a representation of a full reservoir with the default size and flow rate.
+      */
+    MicroBitReservoir();
+
+    /**
+      * Returns the state, to be saved.
+      */
+    const MicroBitReservoirState &getState();
+
+    /**
+      * Restore a saved state.
+      *
+      * @param saved the state returned by getState before the reset.
+      */
+    void setState(const MicroBitReservoirState &saved);
+
+    /**
+      * Account for a pump run.
+      *
+      * @param duration how long the pump ran, in ms.
+      */
+    void draw(uint32_t duration);
+
+    /**
+      * Set the level after a refill.
+      *
+      * @param volume the water in the tank, in ul. Defaults to a full tank.
+      */
+    void refill(uint32_t volume = MICROBIT_RESERVOIR_UNKNOWN);
+
+    /**
+      * Set the tank size.
+      *
+      * @param capacity the tank size, in ul.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if capacity is below the reserve.
+      */
+    int setCapacity(uint32_t capacity);
+
+    /**
+      * Set the calibrated flow rate of the pump.
+      *
+      * @param flowRate the water pumped per second, in ul.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if flowRate is 0.
+      */
+    int setFlowRate(uint32_t flowRate);
+
+    /**
+      * Returns the water in the tank, in ul.
+      */
+    uint32_t getVolume();
+
+    /**
+      * Returns the tank size, in ul.
+      */
+    uint32_t getCapacity();
+
+    /**
+      * Returns the flow rate of the pump, in ul/s.
+      */
+    uint32_t getFlowRate();
+
+    /**
+      * Returns how long the pump can run before the level reaches the reserve, in ms.
+      */
+    uint32_t getRunTime();
+
+    /**
+      * Returns the estimated time before the level reaches the reserve at the current usage,
+      * in seconds, or MICROBIT_RESERVOIR_UNKNOWN if no water was used since the last refill.
+      */
+    uint32_t getTimeToEmpty();
+
+    /**
+      * Returns true if there is water above the reserve.
+      */
+    bool enoughWater();
+
+    private:
+
+    /**
+      * Add the uptime since the last call to the usage time.
+      */
+    void tick();
+
+    /**
+      * Fire the update event, and the empty event if the level reached the reserve.
+      */
+    void changed();
+
+    MicroBitReservoirState  state;
+
+    // Time the uptime was last added to the usage time, in ms of system time
+    uint64_t                lastTick;
+};
+
+#endif
@@ -1,59 +1,291 @@
+#include "mbed.h"
 #include "MicroBitPin.h"
 #include "MicroBitEvent.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitFiber.h"
 #include "MicroBitWateringActuator.h"
 
+/**
+ * Returns true if the wrapping ms time t has been reached.
+ */
+static bool reached(uint32_t t)
+{
+    return (int32_t)((uint32_t)system_timer_current_time() - t) >= 0;
+}
+
 /**
   * Constructor.
   * Create a representation of the MicrovitWateringActuator
   * @param _trigger The pin used to drive the watering
+  * @param _reservoir The tank the pump draws from
+  * @param id the unique EventModel id of this component. Defaults to MICROBIT_ID_WATERING_ACTUATOR.
   */
-MicroBitWateringActuator::MicroBitWateringActuator(MicroBitPin &_trigger) : 
-    trigger(_trigger)
+MicroBitWateringActuator::MicroBitWateringActuator(MicroBitPin &_trigger, MicroBitReservoir &_reservoir, uint16_t id) :
+    trigger(_trigger), reservoir(_reservoir)
 {
-    remaining_waterings = MICROBIT_WATERINGS_COUNT;
+    this->id = id;
 
     // Make sure that the pump is off when creating the actuator.
     stopPump();
 
-    status = MICROBIT_WATERING_OFF;
+    state = MICROBIT_WATERING_OFF;
+    startTime = 0;
+    stopTime = 0;
+    soakTime = 0;
+    soakEnd = 0;
+    pumped = 0;
+    updatePending = false;
+    soakedPending = false;
 }
 
 /**
   * Start watering immediately.
   *
-  * @return the state of the actuator after the operation.
+  * @param duration how long the pump runs, in ms, up to MICROBIT_WATERING_MAX_PULSE and to the
+  *        water left above the reserve.
+  * @param soak how long to wait for the water to soak in after the pump stops, in ms.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_BUSY if a watering is in progress,
+  *         MICROBIT_NO_RESOURCES if there is not enough water, or no room
+  *         for the callbacks that stop the pump.
   */
-void MicroBitWateringActuator::startWatering()
+int MicroBitWateringActuator::startWatering(uint32_t duration, uint32_t soak)
 {
-    if(status == MICROBIT_WATERING_OFF && enoughWater())
+    if (state == MICROBIT_WATERING_ON)
+        return MICROBIT_BUSY;
+
+    if (!enoughWater())
+        return MICROBIT_NO_RESOURCES;
+
+    // Register for the timer and idle callbacks that drive the sequence, unless the owner
+    // makes them. Without them the pump would not stop: do not start, and try again on the
+    // next watering.
+    if (!(status & (MICROBIT_WATERING_ADDED_TO_TICK | MICROBIT_WATERING_EXTERNAL_TICKS)))
     {
-        startPump();
-        status = MICROBIT_WATERING_ON;
+        if (system_timer_add_component(this) != MICROBIT_OK)
+            return MICROBIT_NO_RESOURCES;
 
-        remaining_waterings--;
+        status |= MICROBIT_WATERING_ADDED_TO_TICK;
+    }
+
+    if (!(status & (MICROBIT_WATERING_ADDED_TO_IDLE | MICROBIT_WATERING_EXTERNAL_TICKS)))
+    {
+        if (fiber_add_idle_component(this) != MICROBIT_OK)
+            return MICROBIT_NO_RESOURCES;
 
-        // Trigger event
-        MicroBitEvent ev = MicroBitEvent(MICROBIT_ID_WATERING_ACTUATOR, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE);
-        ev.fire();
+        status |= MICROBIT_WATERING_ADDED_TO_IDLE;
     }
+
+    if (duration > MICROBIT_WATERING_MAX_PULSE)
+        duration = MICROBIT_WATERING_MAX_PULSE;
+
+    uint32_t runTime = reservoir.getRunTime();
+
+    if (duration > runTime)
+        duration = runTime;
+
+    // systemTick() changes the state from the timer interrupt: check again and start in
+    // one go, so that a soak ending meanwhile is not overwritten.
+    __disable_irq();
+
+    if (state == MICROBIT_WATERING_ON)
+    {
+        __enable_irq();
+        return MICROBIT_BUSY;
+    }
+
+    startTime = system_timer_current_time();
+    stopTime = startTime + duration;
+    soakTime = soak;
+
+    startPump();
+    state = MICROBIT_WATERING_ON;
+
+    __enable_irq();
+
+    // Trigger event
+    MicroBitEvent(id, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE);
+
+    return MICROBIT_OK;
 }
 
 /**
-  * Stops watering immediately.
-  *
-  * @return the state of the actuator after the operation.
+  * Stop the pump immediately. The soak time of the watering still applies.
   */
 void MicroBitWateringActuator::stopWatering()
 {
-    if(status == MICROBIT_WATERING_ON && enoughWater())
+    // The run may end in systemTick() between the check and the stop
+    __disable_irq();
+
+    if (state == MICROBIT_WATERING_ON)
+        endRun(true);
+
+    __enable_irq();
+}
+
+/**
+  * Stop the pump immediately and skip the soak time.
+  */
+void MicroBitWateringActuator::abortWatering()
+{
+    __disable_irq();
+
+    if (state == MICROBIT_WATERING_ON)
+    {
+        endRun(false);
+    }
+    else if (state == MICROBIT_WATERING_SOAKING)
     {
-        stopPump();
-        status = MICROBIT_WATERING_OFF;
+        state = MICROBIT_WATERING_OFF;
+        soakedPending = true;
+    }
+
+    __enable_irq();
+}
+
+/**
+  * Make the running pump run longer, up to MICROBIT_WATERING_MAX_PULSE in total.
+  *
+  * @param duration the time to add, in ms.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the pump is not running.
+  */
+int MicroBitWateringActuator::extendWatering(uint32_t duration)
+{
+    uint32_t runTime = reservoir.getRunTime();
+
+    // A run that ends in systemTick() meanwhile must not be extended: its stopTime is final
+    __disable_irq();
 
-        // Trigger event
-        MicroBitEvent ev = MicroBitEvent(MICROBIT_ID_WATERING_ACTUATOR, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE);
-        ev.fire();
+    if (state != MICROBIT_WATERING_ON)
+    {
+        __enable_irq();
+        return MICROBIT_INVALID_PARAMETER;
     }
+
+    uint32_t run = stopTime - startTime;
+
+    if (run + duration > MICROBIT_WATERING_MAX_PULSE)
+        duration = MICROBIT_WATERING_MAX_PULSE - run;
+
+    if (run + duration > runTime)
+        duration = runTime > run ? runTime - run : 0;
+
+    stopTime = stopTime + duration;
+
+    __enable_irq();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Stop the pump and move to the soak state, or to off if there is no soak.
+  * Safe to call from the timer interrupt.
+  */
+void MicroBitWateringActuator::endRun(bool soak)
+{
+    stopPump();
+
+    // Record the actual run, that is shorter than planned when stopped early
+    stopTime = system_timer_current_time();
+    pumped += stopTime - startTime;
+
+    if (soak && soakTime)
+    {
+        soakEnd = (uint32_t)system_timer_current_time() + soakTime;
+        state = MICROBIT_WATERING_SOAKING;
+    }
+    else
+    {
+        state = MICROBIT_WATERING_OFF;
+        soakedPending = true;
+    }
+
+    updatePending = true;
+}
+
+/**
+  * Periodic callback from the system timer: stops the pump and ends the soak on time.
+  */
+void MicroBitWateringActuator::systemTick()
+{
+    if (state == MICROBIT_WATERING_ON && reached(stopTime))
+    {
+        endRun(true);
+    }
+    else if (state == MICROBIT_WATERING_SOAKING && reached(soakEnd))
+    {
+        state = MICROBIT_WATERING_OFF;
+        soakedPending = true;
+    }
+}
+
+/**
+  * Periodic callback from MicroBit idle thread: fires the pending events.
+  */
+void MicroBitWateringActuator::idleTick()
+{
+    if (pumped)
+    {
+        __disable_irq();
+        uint32_t duration = pumped;
+        pumped = 0;
+        __enable_irq();
+
+        reservoir.draw(duration);
+    }
+
+    // Clear before firing, so that a transition happening meanwhile is not lost.
+    if (updatePending)
+    {
+        updatePending = false;
+        MicroBitEvent(id, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE);
+    }
+
+    if (soakedPending && state == MICROBIT_WATERING_OFF)
+    {
+        soakedPending = false;
+        MicroBitEvent(id, MICROBIT_WATERING_ACTUATOR_EVT_SOAKED);
+    }
+}
+
+#ifdef MICROBIT_SIM
+/**
+ * Returns the system time, in ms, of the next tick with work to do: now while events are
+ * pending, else the end of the run or of the soak, (uint64_t)-1 if none.
+ */
+uint64_t MicroBitWateringActuator::getWakeupTime()
+{
+    uint64_t now = system_timer_current_time();
+
+    if (pumped || updatePending || (soakedPending && state == MICROBIT_WATERING_OFF))
+        return now;
+
+    if (state == MICROBIT_WATERING_ON || state == MICROBIT_WATERING_SOAKING)
+    {
+        int32_t left = (int32_t)((state == MICROBIT_WATERING_ON ? stopTime : soakEnd) - (uint32_t)now);
+
+        return left > 0 ? now + left : now;
+    }
+
+    return (uint64_t)-1;
+}
+#endif
+
+/**
+ * Leave the system timer and the idle thread: the owner of the actuator calls systemTick()
+ * and idleTick() instead, e.g. so that several actuators take a single component of each.
+ */
+void MicroBitWateringActuator::setExternalTicks()
+{
+    if (status & MICROBIT_WATERING_ADDED_TO_TICK)
+        system_timer_remove_component(this);
+
+    if (status & MICROBIT_WATERING_ADDED_TO_IDLE)
+        fiber_remove_idle_component(this);
+
+    status &= ~(MICROBIT_WATERING_ADDED_TO_TICK | MICROBIT_WATERING_ADDED_TO_IDLE);
+    status |= MICROBIT_WATERING_EXTERNAL_TICKS;
 }
 
 /**
@@ -77,31 +309,29 @@ void MicroBitWateringActuator::stopPump()
  */
 bool MicroBitWateringActuator::isWatering()
 {
-    return status;
+    return state == MICROBIT_WATERING_ON;
 }
 
 /**
- * Return true if there is enough water for watering.
+ * Return true while the water of the last watering soaks in.
  */
-bool MicroBitWateringActuator::enoughWater()
+bool MicroBitWateringActuator::isSoaking()
 {
-    return remaining_waterings > 0;
+    return state == MICROBIT_WATERING_SOAKING;
 }
 
 /**
- * Set the count of how many times the pump should be activated
+ * Return the length of the current (or last) pump run, in ms.
  */
-void MicroBitWateringActuator::setWateringCount(int c)
+uint32_t MicroBitWateringActuator::getPulseLength()
 {
-    if (c < 0)
-    {
-        c = MICROBIT_WATERINGS_COUNT;
-    }
-
-    remaining_waterings = c;
+    return stopTime - startTime;
 }
 
-int MicroBitWateringActuator::getWateringCount()
+/**
+ * Return true if there is enough water for watering.
+ */
+bool MicroBitWateringActuator::enoughWater()
 {
-    return remaining_waterings;
-}
\ No newline at end of file
+    return reservoir.enoughWater();
+}
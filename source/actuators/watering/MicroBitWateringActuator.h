@@ -1,23 +1,44 @@
-
 #ifndef MICROBIT_WATERING_ACTUATOR_H
 #define MICROBIT_WATERING_ACTUATOR_H
 
+#include "MicroBitComponent.h"
 #include "MicroBitPin.h"
 
+#include "MicroBitReservoir.h"
+
 #define MICROBIT_ID_WATERING_ACTUATOR                   1235
 #define MICROBIT_WATERING_ACTUATOR_EVT_UPDATE           10
+#define MICROBIT_WATERING_ACTUATOR_EVT_SOAKED           11
 
 #define MICROBIT_WATERING_ON                    1
 #define MICROBIT_WATERING_OFF                   0
+#define MICROBIT_WATERING_SOAKING               2
+
+// Default and longest pump run, in ms
+#define MICROBIT_WATERING_DEFAULT_PULSE         5000
+#define MICROBIT_WATERING_MAX_PULSE             30000
 
-#define MICROBIT_WATERINGS_COUNT                4
+// Status flags
+#define MICROBIT_WATERING_ADDED_TO_TICK         0x01
+#define MICROBIT_WATERING_ADDED_TO_IDLE         0x02
+#define MICROBIT_WATERING_EXTERNAL_TICKS        0x04
 
 /**
  * Class definition for the custom MicroBit WateringActuator.
  * Manages the watering of the plant.
- * For safety purposes, if the water level is too low or is not available, the pump is not activated.
+ * The pump draws from a MicroBitReservoir: for safety purposes the pump is not activated when the
+ * level is down to the reserve, and a run is cut short so that it does not go below it.
+ *
+ * A watering is a timed sequence: the pump runs for the requested time (MICROBIT_WATERING_ON),
+ * then the water soaks in (MICROBIT_WATERING_SOAKING), then the actuator is idle again
+ * (MICROBIT_WATERING_OFF). The pump is switched off from the system timer tick, so no fiber is
+ * held while it runs, and a run can be stopped, aborted or extended at any time.
+ *
+ * MICROBIT_WATERING_ACTUATOR_EVT_UPDATE is fired when the pump starts and stops, and
+ * MICROBIT_WATERING_ACTUATOR_EVT_SOAKED when the soak time is over. Events are fired from the
+ * idle thread rather than from the timer interrupt.
  */
-class MicroBitWateringActuator
+class MicroBitWateringActuator : public MicroBitComponent
 {
     public:
 
@@ -25,42 +46,86 @@ class MicroBitWateringActuator
      * Constructor.
      * Create a representation of the MicrovitWateringActuator
      * @param _trigger The pin used to drive the watering
+     * @param _reservoir The tank the pump draws from
+     * @param id the unique EventModel id of this component. Defaults to MICROBIT_ID_WATERING_ACTUATOR.
      */
-    MicroBitWateringActuator(MicroBitPin &_trigger);
+    MicroBitWateringActuator(MicroBitPin &_trigger, MicroBitReservoir &_reservoir, uint16_t id = MICROBIT_ID_WATERING_ACTUATOR);
 
     /**
      * Start watering immediately.
-     * 
-     * @return returns the state of the actuator after the operation.
+     *
+     * @param duration how long the pump runs, in ms, up to MICROBIT_WATERING_MAX_PULSE and to the
+     *        water left above the reserve.
+     * @param soak how long to wait for the water to soak in after the pump stops, in ms.
+     *
+     * @return MICROBIT_OK on success, MICROBIT_BUSY if a watering is in progress,
+     *         MICROBIT_NO_RESOURCES if there is not enough water, or no room
+     *         for the callbacks that stop the pump.
      */
-    void startWatering();
+    int startWatering(uint32_t duration = MICROBIT_WATERING_DEFAULT_PULSE, uint32_t soak = 0);
 
     /**
-     * Stop watering immediately.
-     * 
-     * @return returns the state of the actuator after the operation.
+     * Stop the pump immediately. The soak time of the watering still applies.
      */
     void stopWatering();
 
+    /**
+     * Stop the pump immediately and skip the soak time.
+     */
+    void abortWatering();
+
+    /**
+     * Make the running pump run longer, up to MICROBIT_WATERING_MAX_PULSE in total.
+     *
+     * @param duration the time to add, in ms.
+     *
+     * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the pump is not running.
+     */
+    int extendWatering(uint32_t duration);
+
     /**
      * Return MICROBIT_WATERING_ON if the actuator is enabled, otherwise MICROBIT_WATERING_OFF.
      */
     bool isWatering();
 
+    /**
+     * Return true while the water of the last watering soaks in.
+     */
+    bool isSoaking();
+
+    /**
+     * Return the length of the current (or last) pump run, in ms.
+     */
+    uint32_t getPulseLength();
+
     /**
      * Return true if there is enough water for watering.
      */
     bool enoughWater();
 
     /**
-     * Set the count of how many times the pump should be activated
+     * Periodic callback from the system timer: stops the pump and ends the soak on time.
      */
-    void setWateringCount(int c);
+    virtual void systemTick();
 
     /**
-     * Return the remaining waterings count
+     * Periodic callback from MicroBit idle thread: fires the pending events.
      */
-    int getWateringCount();
+    virtual void idleTick();
+
+#ifdef MICROBIT_SIM
+    /**
+     * Returns the system time, in ms, of the next tick with work to do: now while events are
+     * pending, else the end of the run or of the soak, (uint64_t)-1 if none.
+     */
+    virtual uint64_t getWakeupTime();
+#endif
+
+    /**
+     * Leave the system timer and the idle thread: the owner of the actuator calls systemTick()
+     * and idleTick() instead, e.g. so that several actuators take a single component of each.
+     */
+    void setExternalTicks();
 
     private:
 
@@ -74,20 +139,45 @@ class MicroBitWateringActuator
      */
     void stopPump();
 
+    /**
+     * Stop the pump and move to the soak state, or to off if there is no soak.
+     * Safe to call from the timer interrupt.
+     */
+    void endRun(bool soak);
+
     /**
      * Pin to use to start/stop the pump
      */
     MicroBitPin &trigger;
 
     /**
-     * Waterings remaining
+     * Tank the pump draws from
+     */
+    MicroBitReservoir &reservoir;
+
+    /**
+     * Actuator's current state: MICROBIT_WATERING_ON, MICROBIT_WATERING_SOAKING or MICROBIT_WATERING_OFF
+     */
+    volatile int32_t state;
+
+    /**
+     * Timing of the current watering, in ms of system time (wrapping).
+     */
+    volatile uint32_t startTime;
+    volatile uint32_t stopTime;
+    volatile uint32_t soakTime;
+    volatile uint32_t soakEnd;
+
+    /**
+     * Pumping time not yet drawn from the reservoir, in ms.
      */
-    int32_t remaining_waterings;
+    volatile uint32_t pumped;
 
     /**
-     * Actuator's current status
+     * Events waiting to be fired from the idle thread. Set on state changes, also from the timer interrupt.
      */
-    int32_t status;
+    volatile bool updatePending;
+    volatile bool soakedPending;
 };
 
-#endif
\ No newline at end of file
+#endif
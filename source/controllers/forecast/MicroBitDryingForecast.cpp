@@ -0,0 +1,94 @@
+#include "MicroBitDryingForecast.h"
+
+/**
+  * Constructor.
+  * Create a forecast that knows nothing of the soil yet.
+  */
+MicroBitDryingForecast::MicroBitDryingForecast()
+{
+    anchorMoisture = 0;
+    anchorDemand = 0;
+    anchored = false;
+    cost = 0;
+}
+
+/**
+  * Account a new moisture reading.
+  *
+  * @param moisture the moisture reading.
+  * @param demand the total demand at the time of the reading, see MicroBitEvapotranspiration::getTotal().
+  */
+void MicroBitDryingForecast::update(int32_t moisture, uint32_t demand)
+{
+    // Watered, or first reading: measure from here. A reading back up by the noise of
+    // the filter is not a watering, and would cut the measure short.
+    if (!anchored || moisture > anchorMoisture + MICROBIT_DRYING_NOISE)
+    {
+        anchorMoisture = moisture;
+        anchorDemand = demand;
+        anchored = true;
+        return;
+    }
+
+    int32_t drop = anchorMoisture - moisture;
+
+    if (drop < MICROBIT_DRYING_LEARN_STEP)
+        return;
+
+    uint32_t sample = (demand - anchorDemand) / drop;
+
+    if (sample > 0)
+    {
+        if (cost == 0)
+            cost = sample;
+        else
+            cost = (uint32_t)((int64_t)cost + (((int64_t)sample - cost) >> MICROBIT_DRYING_LEARN_SHIFT));
+    }
+
+    anchorMoisture = moisture;
+    anchorDemand = demand;
+}
+
+/**
+  * Drop the measure in progress, e.g. when a watering starts.
+  */
+void MicroBitDryingForecast::restart()
+{
+    anchored = false;
+}
+
+/**
+  * The demand it takes for the moisture to drop by one point, 0 until measured.
+  */
+uint32_t MicroBitDryingForecast::getCost()
+{
+    return cost;
+}
+
+/**
+  * Predict when the moisture reaches the threshold.
+  *
+  * @param moisture the latest moisture reading.
+  * @param threshold the moisture level under which the plant needs water.
+  * @param et the demand estimator.
+  *
+  * @return the time in seconds, 0 if already reached, or MICROBIT_DRYING_UNKNOWN if
+  *         the soil has not been measured yet or the threshold is too far ahead.
+  */
+uint32_t MicroBitDryingForecast::timeToThreshold(int32_t moisture, int32_t threshold, MicroBitEvapotranspiration &et)
+{
+    if (moisture <= threshold)
+        return 0;
+
+    if (cost == 0)
+        return MICROBIT_DRYING_UNKNOWN;
+
+    uint64_t demand = (uint64_t)(moisture - threshold) * cost;
+
+    if (demand > 0xFFFFFFFE)
+        return MICROBIT_DRYING_UNKNOWN;
+
+    uint32_t time = et.timeToDemand((uint32_t)demand);
+
+    return time == MICROBIT_ET_UNKNOWN ? MICROBIT_DRYING_UNKNOWN : time;
+}
@@ -0,0 +1,81 @@
+#ifndef MICROBIT_DRYING_FORECAST_H
+#define MICROBIT_DRYING_FORECAST_H
+
+#include "MicroBitConfig.h"
+
+#include "MicroBitEvapotranspiration.h"
+
+// Moisture drop, in points, over which the soil response is measured
+#define MICROBIT_DRYING_LEARN_STEP          2
+
+// Learning rate of the soil response, as a right shift (1/4)
+#define MICROBIT_DRYING_LEARN_SHIFT         2
+
+// Rise of the moisture, in points, that is taken for noise rather than water. The moisture
+// filter moves by at least 2 points at a time (1 point deadband).
+#define MICROBIT_DRYING_NOISE               2
+
+#define MICROBIT_DRYING_UNKNOWN             0xFFFFFFFF
+
+/**
+  * Class definition for the MicroBitDryingForecast.
+  *
+  * Learns how the moisture of a pot follows the evaporative demand estimated by
+  * MicroBitEvapotranspiration: the demand it takes for the moisture to drop by one point,
+  * measured over each MICROBIT_DRYING_LEARN_STEP points of drying. From it, and the demand
+  * to come, predicts when the moisture reaches the watering threshold.
+  *
+  * A rise of the moisture by more than MICROBIT_DRYING_NOISE points, e.g. a watering,
+  * starts a new measure.
+  */
+class MicroBitDryingForecast
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a forecast that knows nothing of the soil yet.
+      */
+    MicroBitDryingForecast();
+
+    /**
+      * Account a new moisture reading.
+      *
+      * @param moisture the moisture reading.
+      * @param demand the total demand at the time of the reading, see MicroBitEvapotranspiration::getTotal().
+      */
+    void update(int32_t moisture, uint32_t demand);
+
+    /**
+      * Drop the measure in progress, e.g. when a watering starts.
+      */
+    void restart();
+
+    /**
+      * The demand it takes for the moisture to drop by one point, 0 until measured.
+      */
+    uint32_t getCost();
+
+    /**
+      * Predict when the moisture reaches the threshold.
+      *
+      * @param moisture the latest moisture reading.
+      * @param threshold the moisture level under which the plant needs water.
+      * @param et the demand estimator.
+      *
+      * @return the time in seconds, 0 if already reached, or MICROBIT_DRYING_UNKNOWN if
+      *         the soil has not been measured yet or the threshold is too far ahead.
+      */
+    uint32_t timeToThreshold(int32_t moisture, int32_t threshold, MicroBitEvapotranspiration &et);
+
+    private:
+
+    // Start of the measure in progress
+    int32_t     anchorMoisture;
+    uint32_t    anchorDemand;
+    bool        anchored;
+
+    uint32_t    cost;
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "MicroBitSystemTimer.h"
+#include "MicroBitEvapotranspiration.h"
+
+/**
+  * Constructor.
+  * Create an estimator with empty profiles.
+  */
+MicroBitEvapotranspiration::MicroBitEvapotranspiration()
+{
+    lastTime = 0;
+    hourStart = 0;
+    rate = 0;
+    total = 0;
+    light = 0;
+    primed = false;
+    hourDemand = 0;
+    hourLight = 0;
+    hourTime = 0;
+    hour = 0;
+
+    memset(demandProfile, 0, sizeof(demandProfile));
+    memset(lightProfile, 0, sizeof(lightProfile));
+}
+
+/**
+  * Account new light and temperature readings. The demand since the previous readings
+  * is integrated at the previous rate.
+  *
+  * @param light the light level, 0 - 255.
+  * @param temperature the temperature, in degrees Celsius.
+  */
+void MicroBitEvapotranspiration::update(int light, int temperature)
+{
+    uint64_t now = system_timer_current_time();
+
+    if (!primed)
+    {
+        hourStart = now;
+        primed = true;
+    }
+    else
+    {
+        // A gap longer than an hour would only be guessed: count at most an hour of it
+        uint32_t dt = now - lastTime > MICROBIT_ET_HOUR ? MICROBIT_ET_HOUR : (uint32_t)(now - lastTime);
+        uint32_t demand = (uint32_t)((uint64_t)rate * dt / 1000);
+
+        total += demand;
+        hourDemand += demand;
+        hourLight += (uint32_t)this->light * dt / 1000;
+        hourTime += dt;
+    }
+
+    while (now - hourStart >= MICROBIT_ET_HOUR)
+        closeHour();
+
+    if (light < 0)
+        light = 0;
+
+    if (light > 255)
+        light = 255;
+
+    int t = temperature + MICROBIT_ET_TEMPERATURE_OFFSET;
+
+    this->light = light;
+    this->rate = t > 0 ? ((light + MICROBIT_ET_LIGHT_BASE) * t) >> MICROBIT_ET_SHIFT : 0;
+    this->lastTime = now;
+}
+
+/**
+  * Fold the current hour into the profiles and start the next one.
+  * Each hour is averaged with the same hour of the previous days.
+  */
+void MicroBitEvapotranspiration::closeHour()
+{
+    if (hourTime > 0)
+    {
+        uint32_t meanDemand = (uint32_t)((uint64_t)hourDemand * 1000 / hourTime);
+        uint32_t meanLight = (uint32_t)((uint64_t)hourLight * 1000 / hourTime);
+
+        // Keep 0 for the hours not seen yet
+        if (meanDemand == 0)
+            meanDemand = 1;
+
+        if (meanDemand > 0xFFFF)
+            meanDemand = 0xFFFF;
+
+        demandProfile[hour] = demandProfile[hour] ? (demandProfile[hour] + meanDemand + 1) / 2 : meanDemand;
+        lightProfile[hour] = lightProfile[hour] ? (lightProfile[hour] + meanLight + 1) / 2 : meanLight;
+    }
+
+    hourDemand = 0;
+    hourLight = 0;
+    hourTime = 0;
+    hour = (hour + 1) % MICROBIT_ET_HOURS;
+    hourStart += MICROBIT_ET_HOUR;
+}
+
+/**
+  * The current demand, per second.
+  */
+uint32_t MicroBitEvapotranspiration::getRate()
+{
+    return rate;
+}
+
+/**
+  * The demand accumulated since the startup. Wraps around: only differences are meaningful.
+  */
+uint32_t MicroBitEvapotranspiration::getTotal()
+{
+    return total;
+}
+
+/**
+  * The light received over a day: the sum of the mean light level of each hour, in
+  * level hours (0 - 6120). A relative daily light integral, as the LEDs are not calibrated.
+  */
+uint32_t MicroBitEvapotranspiration::getDailyLightIntegral()
+{
+    uint32_t dli = 0;
+
+    for (int i = 0; i < MICROBIT_ET_HOURS; i++)
+        dli += lightProfile[i];
+
+    return dli;
+}
+
+/**
+  * Predict how long it takes for some demand to accumulate, following the daily profile.
+  * The rest of the current hour runs at the current rate, the following hours at the rate
+  * of their profile, or at the current rate until the profile is known.
+  *
+  * @param demand the demand to accumulate.
+  *
+  * @return the time in seconds, or MICROBIT_ET_UNKNOWN beyond MICROBIT_ET_HORIZON.
+  */
+uint32_t MicroBitEvapotranspiration::timeToDemand(uint32_t demand)
+{
+    if (demand == 0)
+        return 0;
+
+    if (!primed)
+        return MICROBIT_ET_UNKNOWN;
+
+    uint64_t elapsed = system_timer_current_time() - hourStart;
+    uint32_t seconds = elapsed < MICROBIT_ET_HOUR ? (MICROBIT_ET_HOUR - (uint32_t)elapsed) / 1000 : 0;
+    uint32_t r = rate;
+    uint32_t time = 0;
+    int h = hour;
+
+    for (int i = 0; i <= MICROBIT_ET_HORIZON; i++)
+    {
+        uint32_t available = r * seconds;
+
+        if (demand <= available)
+            return time + demand / r;
+
+        demand -= available;
+        time += seconds;
+
+        h = (h + 1) % MICROBIT_ET_HOURS;
+        r = demandProfile[h] ? demandProfile[h] : rate;
+        seconds = MICROBIT_ET_HOUR / 1000;
+    }
+
+    return MICROBIT_ET_UNKNOWN;
+}
@@ -0,0 +1,104 @@
+#ifndef MICROBIT_EVAPOTRANSPIRATION_H
+#define MICROBIT_EVAPOTRANSPIRATION_H
+
+#include "MicroBitConfig.h"
+
+// Hours in the daily profiles, and length of an hour in ms
+#define MICROBIT_ET_HOURS                   24
+#define MICROBIT_ET_HOUR                    3600000
+
+// Demand model: ((light + LIGHT_BASE) * (temperature + TEMPERATURE_OFFSET)) >> SHIFT per second.
+// The light base accounts for the water lost in the dark, the temperature offset is the
+// one of the Hargreaves equation (17.8 C).
+#define MICROBIT_ET_LIGHT_BASE              16
+#define MICROBIT_ET_TEMPERATURE_OFFSET      18
+#define MICROBIT_ET_SHIFT                   4
+
+// How far ahead predictions go, in hours
+#define MICROBIT_ET_HORIZON                 (7 * MICROBIT_ET_HOURS)
+
+#define MICROBIT_ET_UNKNOWN                 0xFFFFFFFF
+
+/**
+  * Class definition for MicroBitEvapotranspiration.
+  *
+  * Estimates the evaporative demand from the light and the temperature, in the fixed
+  * point units of the demand model above, and integrates it over time. Each hour of the
+  * day keeps the mean demand and light seen at that hour on the previous days, so that
+  * the demand to come can be predicted through the day/night cycle.
+  *
+  * Hours are counted from the startup, as the micro:bit has no clock: the profiles follow
+  * the day/night cycle whatever time the vase was switched on.
+  */
+class MicroBitEvapotranspiration
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create an estimator with empty profiles.
+      */
+    MicroBitEvapotranspiration();
+
+    /**
+      * Account new light and temperature readings. The demand since the previous readings
+      * is integrated at the previous rate.
+      *
+      * @param light the light level, 0 - 255.
+      * @param temperature the temperature, in degrees Celsius.
+      */
+    void update(int light, int temperature);
+
+    /**
+      * The current demand, per second.
+      */
+    uint32_t getRate();
+
+    /**
+      * The demand accumulated since the startup. Wraps around: only differences are meaningful.
+      */
+    uint32_t getTotal();
+
+    /**
+      * The light received over a day: the sum of the mean light level of each hour, in
+      * level hours (0 - 6120). A relative daily light integral, as the LEDs are not calibrated.
+      */
+    uint32_t getDailyLightIntegral();
+
+    /**
+      * Predict how long it takes for some demand to accumulate, following the daily profile.
+      *
+      * @param demand the demand to accumulate.
+      *
+      * @return the time in seconds, or MICROBIT_ET_UNKNOWN beyond MICROBIT_ET_HORIZON.
+      */
+    uint32_t timeToDemand(uint32_t demand);
+
+    private:
+
+    /**
+      * Fold the current hour into the profiles and start the next one.
+      */
+    void closeHour();
+
+    // Time of the last readings and of the start of the current hour, in ms of system time
+    uint64_t    lastTime;
+    uint64_t    hourStart;
+
+    uint32_t    rate;
+    uint32_t    total;
+    uint8_t     light;
+    bool        primed;
+
+    // Accumulated over the current hour: demand, light in level seconds, time in ms
+    uint32_t    hourDemand;
+    uint32_t    hourLight;
+    uint32_t    hourTime;
+    uint8_t     hour;
+
+    // Mean demand per second and mean light of each hour, 0 until seen
+    uint16_t    demandProfile[MICROBIT_ET_HOURS];
+    uint8_t     lightProfile[MICROBIT_ET_HOURS];
+};
+
+#endif
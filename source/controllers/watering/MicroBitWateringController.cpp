@@ -0,0 +1,164 @@
+#include "MicroBitWateringController.h"
+
+/**
+  * Constructor.
+  * Create a controller with the default soil response.
+  */
+MicroBitWateringController::MicroBitWateringController()
+{
+    gain = MICROBIT_WATERING_CONTROLLER_GAIN;
+    integral = 0;
+    minPulse = MICROBIT_WATERING_CONTROLLER_MIN_PULSE;
+    maxPulse = MICROBIT_WATERING_CONTROLLER_MAX_PULSE;
+    soakTime = MICROBIT_WATERING_CONTROLLER_SOAK_TIME;
+    lastPulse = 0;
+    moistureBefore = 0;
+    pending = false;
+}
+
+/**
+  * Decide whether a pulse is needed. Never true between a pulse start and the end of its soak.
+  *
+  * @param moisture the latest moisture reading.
+  * @param threshold the moisture level under which the plant needs water.
+  *
+  * @return true if a pulse is needed.
+  */
+bool MicroBitWateringController::needsWatering(int32_t moisture, int32_t threshold)
+{
+    return !pending && moisture < threshold;
+}
+
+/**
+  * Length of the pulse that brings the moisture back to the target.
+  *
+  * @param moisture the latest moisture reading.
+  * @param threshold the moisture level under which the plant needs water.
+  *
+  * @return the pulse length, in ms.
+  */
+uint32_t MicroBitWateringController::pulseLength(int32_t moisture, int32_t threshold)
+{
+    int32_t deficit = threshold + MICROBIT_WATERING_CONTROLLER_MARGIN - moisture;
+    int32_t pulse = ((gain * deficit) >> 8) + integral;
+
+    if (pulse < (int32_t)minPulse)
+        return minPulse;
+
+    if (pulse > (int32_t)maxPulse)
+        return maxPulse;
+
+    return pulse;
+}
+
+/**
+  * Record that a pulse started.
+  *
+  * @param length the pulse length, in ms.
+  * @param moisture the moisture reading before the pulse.
+  */
+void MicroBitWateringController::pulseStarted(uint32_t length, int32_t moisture)
+{
+    lastPulse = length;
+    moistureBefore = moisture;
+    pending = true;
+}
+
+/**
+  * Record that the water of the last pulse has soaked in, and learn the soil response
+  * from the moisture reached.
+  *
+  * @param moisture the moisture reading after the soak.
+  * @param threshold the moisture level under which the plant needs water.
+  */
+void MicroBitWateringController::pulseSoaked(int32_t moisture, int32_t threshold)
+{
+    if (!pending)
+        return;
+
+    pending = false;
+    learn(moisture, threshold);
+}
+
+/**
+  * Record that the last pulse was cut short: nothing is learned from it.
+  */
+void MicroBitWateringController::pulseCancelled()
+{
+    pending = false;
+}
+
+/**
+  * The learned soil response, in ms of pumping per moisture point.
+  */
+int MicroBitWateringController::getGain()
+{
+    return gain >> 8;
+}
+
+/**
+  * Set the pulse bounds.
+  *
+  * @param minPulse the shortest pulse, in ms.
+  * @param maxPulse the longest pulse, in ms.
+  */
+void MicroBitWateringController::setPulseLimits(uint32_t minPulse, uint32_t maxPulse)
+{
+    this->minPulse = minPulse;
+    this->maxPulse = maxPulse < minPulse ? minPulse : maxPulse;
+}
+
+/**
+  * Set the time left to the water to soak in after each pulse.
+  *
+  * @param soakTime the soak time, in ms.
+  */
+void MicroBitWateringController::setSoakTime(uint32_t soakTime)
+{
+    this->soakTime = soakTime;
+}
+
+/**
+  * The time left to the water to soak in after each pulse, in ms.
+  */
+uint32_t MicroBitWateringController::getSoakTime()
+{
+    return soakTime;
+}
+
+/**
+  * Update the soil response and the integral from the moisture reached after a pulse.
+  */
+void MicroBitWateringController::learn(int32_t moisture, int32_t threshold)
+{
+    int32_t rise = moisture - moistureBefore;
+
+    // Without a rise the probe tells nothing about the soil: keep the response, let the integral act.
+    if (rise > 0)
+    {
+        // One division per pulse, far from the sampling path.
+        int32_t observed = (int32_t)((lastPulse << 8) / rise);
+
+        gain += (observed - gain) >> MICROBIT_WATERING_CONTROLLER_LEARN_SHIFT;
+
+        if (gain < MICROBIT_WATERING_CONTROLLER_MIN_GAIN)
+            gain = MICROBIT_WATERING_CONTROLLER_MIN_GAIN;
+
+        if (gain > MICROBIT_WATERING_CONTROLLER_MAX_GAIN)
+            gain = MICROBIT_WATERING_CONTROLLER_MAX_GAIN;
+    }
+
+    int32_t deficit = threshold + MICROBIT_WATERING_CONTROLLER_MARGIN - moisture;
+
+    if (deficit <= 0)
+    {
+        integral = 0;
+    }
+    else
+    {
+        integral += ((gain * deficit) >> 8) >> MICROBIT_WATERING_CONTROLLER_INTEGRAL_SHIFT;
+
+        if (integral > (int32_t)maxPulse)
+            integral = maxPulse;
+    }
+}
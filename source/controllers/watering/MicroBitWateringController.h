@@ -0,0 +1,138 @@
+#ifndef MICROBIT_WATERING_CONTROLLER_H
+#define MICROBIT_WATERING_CONTROLLER_H
+
+#include "MicroBitConfig.h"
+
+// Moisture points above the threshold the controller aims for
+#define MICROBIT_WATERING_CONTROLLER_MARGIN         5
+
+// Pump pulse bounds, in ms
+#define MICROBIT_WATERING_CONTROLLER_MIN_PULSE      500
+#define MICROBIT_WATERING_CONTROLLER_MAX_PULSE      10000
+
+// Time left to the water to spread in the soil before the moisture is evaluated again, in ms
+#define MICROBIT_WATERING_CONTROLLER_SOAK_TIME      120000
+
+// Initial and allowed soil response, in ms of pumping per moisture point (Q8 fixed point)
+#define MICROBIT_WATERING_CONTROLLER_GAIN           (200 << 8)
+#define MICROBIT_WATERING_CONTROLLER_MIN_GAIN       (20 << 8)
+#define MICROBIT_WATERING_CONTROLLER_MAX_GAIN       (2000 << 8)
+
+// Learning rate of the soil response and integral factor, as right shifts (1/4)
+#define MICROBIT_WATERING_CONTROLLER_LEARN_SHIFT    2
+#define MICROBIT_WATERING_CONTROLLER_INTEGRAL_SHIFT 2
+
+/**
+  * Class definition for the MicroBitWateringController.
+  *
+  * Computes the length of each pump pulse from the moisture deficit, instead of running
+  * the pump for a fixed time:
+  *
+  *   pulse = gain * (threshold + margin - moisture) + integral
+  *
+  * where gain is the soil response (ms of pumping per moisture point) learned from the
+  * previous pulses, and integral accumulates the deficit left after each pulse.
+  *
+  * After each pulse the water is left to soak in (see MicroBitWateringActuator) before the
+  * moisture is looked at again: that reading is used to update the soil response.
+  */
+class MicroBitWateringController
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a controller with the default soil response.
+      */
+    MicroBitWateringController();
+
+    /**
+      * Decide whether a pulse is needed. Never true between a pulse start and the end of its soak.
+      *
+      * @param moisture the latest moisture reading.
+      * @param threshold the moisture level under which the plant needs water.
+      *
+      * @return true if a pulse is needed.
+      */
+    bool needsWatering(int32_t moisture, int32_t threshold);
+
+    /**
+      * Length of the pulse that brings the moisture back to the target.
+      *
+      * @param moisture the latest moisture reading.
+      * @param threshold the moisture level under which the plant needs water.
+      *
+      * @return the pulse length, in ms.
+      */
+    uint32_t pulseLength(int32_t moisture, int32_t threshold);
+
+    /**
+      * Record that a pulse started.
+      *
+      * @param length the pulse length, in ms.
+      * @param moisture the moisture reading before the pulse.
+      */
+    void pulseStarted(uint32_t length, int32_t moisture);
+
+    /**
+      * Record that the water of the last pulse has soaked in, and learn the soil response
+      * from the moisture reached.
+      *
+      * @param moisture the moisture reading after the soak.
+      * @param threshold the moisture level under which the plant needs water.
+      */
+    void pulseSoaked(int32_t moisture, int32_t threshold);
+
+    /**
+      * Record that the last pulse was cut short: nothing is learned from it.
+      */
+    void pulseCancelled();
+
+    /**
+      * The learned soil response, in ms of pumping per moisture point.
+      */
+    int getGain();
+
+    /**
+      * Set the pulse bounds.
+      *
+      * @param minPulse the shortest pulse, in ms.
+      * @param maxPulse the longest pulse, in ms.
+      */
+    void setPulseLimits(uint32_t minPulse, uint32_t maxPulse);
+
+    /**
+      * Set the time left to the water to soak in after each pulse.
+      *
+      * @param soakTime the soak time, in ms.
+      */
+    void setSoakTime(uint32_t soakTime);
+
+    /**
+      * The time left to the water to soak in after each pulse, in ms.
+      */
+    uint32_t getSoakTime();
+
+    private:
+
+    /**
+      * Update the soil response and the integral from the moisture reached after a pulse.
+      */
+    void learn(int32_t moisture, int32_t threshold);
+
+    // Soil response, ms of pumping per moisture point, Q8.
+    int32_t     gain;
+    // Accumulated deficit, in ms.
+    int32_t     integral;
+
+    uint32_t    minPulse;
+    uint32_t    maxPulse;
+    uint32_t    soakTime;
+
+    // Last pulse
+    uint32_t    lastPulse;
+    int32_t     moistureBefore;
+    bool        pending;
+};
+
+#endif
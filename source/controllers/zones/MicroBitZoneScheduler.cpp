@@ -0,0 +1,224 @@
+#include "MicroBitConfig.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitFiber.h"
+#include "MicroBitZoneScheduler.h"
+
+/**
+  * Constructor.
+  *
+  * @param sensors the moisture sensor of each zone.
+  * @param actuators the watering actuator of each zone.
+  * @param zoneCount the number of zones, up to MICROBIT_ZONES_MAX.
+  * @param maxPumps the number of pumps allowed to run at once.
+  * @param id the ID of the new MicroBitZoneScheduler object.
+  */
+MicroBitZoneScheduler::MicroBitZoneScheduler(MicroBitMoistureSensor *sensors, MicroBitWateringActuator *actuators, int zoneCount, int maxPumps, uint16_t id) :
+        sensors(sensors), actuators(actuators)
+{
+    this->id = id;
+    this->status = 0;
+    this->zoneCount = zoneCount > MICROBIT_ZONES_MAX ? MICROBIT_ZONES_MAX : zoneCount;
+    this->next = 0;
+
+    setMaxPumps(maxPumps);
+
+    for (int i = 0; i < MICROBIT_ZONES_MAX; i++)
+    {
+        waiting[i] = false;
+        duration[i] = 0;
+        soak[i] = 0;
+    }
+}
+
+/**
+  * Start serving the waiting waterings as the pumps stop, and making the callbacks of
+  * the sensors and actuators. Must be called once the message bus is available, and
+  * before the sensors are configured or sampled: a sensor that takes a sample first
+  * registers itself in the idle thread, and may take the room the scheduler needs.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_NO_RESOURCES if the system timer or the idle
+  *         thread has no room left: the sensors and actuators then register themselves.
+  */
+int MicroBitZoneScheduler::start()
+{
+    if (status & MICROBIT_ZONES_STARTED)
+        return MICROBIT_OK;
+
+    status |= MICROBIT_ZONES_STARTED;
+
+    if (EventModel::defaultEventBus)
+        for (int i = 0; i < zoneCount; i++)
+            EventModel::defaultEventBus->listen(actuators[i].id, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE, this, &MicroBitZoneScheduler::onActuatorUpdate);
+
+    if (system_timer_add_component(this) != MICROBIT_OK)
+        return MICROBIT_NO_RESOURCES;
+
+    if (fiber_add_idle_component(this) != MICROBIT_OK)
+    {
+        system_timer_remove_component(this);
+        return MICROBIT_NO_RESOURCES;
+    }
+
+    for (int i = 0; i < zoneCount; i++)
+    {
+        sensors[i].setExternalIdle();
+        actuators[i].setExternalTicks();
+    }
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Spread the samples of the sensors evenly over MICROBIT_ZONES_FRAME: every sample of a
+  * sensor is taken in the slot of its zone.
+  */
+void MicroBitZoneScheduler::interleave()
+{
+    for (int i = 0; i < zoneCount; i++)
+        sensors[i].setSampleSlot(MICROBIT_ZONES_FRAME, (MICROBIT_ZONES_FRAME * i) / zoneCount);
+}
+
+/**
+  * Ask for a watering of a zone. It starts immediately if a pump slot is free,
+  * otherwise as soon as one frees up.
+  *
+  * @param zone the zone to water.
+  * @param duration how long the pump runs, in ms.
+  * @param soak how long to wait for the water to soak in after the pump stops, in ms.
+  *
+  * @return MICROBIT_OK if the watering started or was queued, MICROBIT_BUSY if the zone is
+  *         already watering or waiting, MICROBIT_INVALID_PARAMETER if zone is out of range.
+  */
+int MicroBitZoneScheduler::request(int zone, uint32_t duration, uint32_t soak)
+{
+    if (zone < 0 || zone >= zoneCount)
+        return MICROBIT_INVALID_PARAMETER;
+
+    if (waiting[zone] || actuators[zone].isWatering())
+        return MICROBIT_BUSY;
+
+    this->duration[zone] = duration;
+    this->soak[zone] = soak;
+    waiting[zone] = true;
+
+    dispatch();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Drop a waiting request of a zone. Has no effect on a running pump.
+  *
+  * @param zone the zone.
+  */
+void MicroBitZoneScheduler::cancel(int zone)
+{
+    if (zone >= 0 && zone < zoneCount)
+        waiting[zone] = false;
+}
+
+/**
+  * Returns true if a watering of the zone is waiting for a pump slot.
+  */
+bool MicroBitZoneScheduler::isWaiting(int zone)
+{
+    return zone >= 0 && zone < zoneCount && waiting[zone];
+}
+
+/**
+  * Returns the zone whose sensor or actuator has the given event id, or -1.
+  */
+int MicroBitZoneScheduler::zoneOf(uint16_t id)
+{
+    for (int i = 0; i < zoneCount; i++)
+        if (sensors[i].id == id || actuators[i].id == id)
+            return i;
+
+    return -1;
+}
+
+/**
+  * Change the number of pumps allowed to run at once.
+  */
+void MicroBitZoneScheduler::setMaxPumps(int maxPumps)
+{
+    this->maxPumps = maxPumps < 1 ? 1 : maxPumps;
+}
+
+/**
+  * Actuator update callback: starts waiting waterings when a pump stops.
+  */
+void MicroBitZoneScheduler::onActuatorUpdate(MicroBitEvent)
+{
+    dispatch();
+}
+
+/**
+  * Periodic callback from MicroBit system timer: calls back every actuator.
+  */
+void MicroBitZoneScheduler::systemTick()
+{
+    for (int i = 0; i < zoneCount; i++)
+        actuators[i].systemTick();
+}
+
+/**
+  * Periodic callback from MicroBit idle thread: calls back every sensor and actuator.
+  */
+void MicroBitZoneScheduler::idleTick()
+{
+    for (int i = 0; i < zoneCount; i++)
+    {
+        sensors[i].idleTick();
+        actuators[i].idleTick();
+    }
+}
+
+#ifdef MICROBIT_SIM
+/**
+  * Returns the earliest system time, in ms, a sensor or an actuator has work for.
+  */
+uint64_t MicroBitZoneScheduler::getWakeupTime()
+{
+    uint64_t wakeup = (uint64_t)-1;
+
+    for (int i = 0; i < zoneCount; i++)
+    {
+        if (sensors[i].getWakeupTime() < wakeup)
+            wakeup = sensors[i].getWakeupTime();
+
+        if (actuators[i].getWakeupTime() < wakeup)
+            wakeup = actuators[i].getWakeupTime();
+    }
+
+    return wakeup;
+}
+#endif
+
+/**
+  * Start waiting waterings while pump slots are free.
+  */
+void MicroBitZoneScheduler::dispatch()
+{
+    int running = 0;
+
+    for (int i = 0; i < zoneCount; i++)
+        if (actuators[i].isWatering())
+            running++;
+
+    for (int n = 0; n < zoneCount && running < maxPumps; n++)
+    {
+        int zone = (next + n) % zoneCount;
+
+        if (!waiting[zone])
+            continue;
+
+        waiting[zone] = false;
+
+        if (actuators[zone].startWatering(duration[zone], soak[zone]) == MICROBIT_OK)
+        {
+            running++;
+            next = (zone + 1) % zoneCount;
+        }
+    }
+}
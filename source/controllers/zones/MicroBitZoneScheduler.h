@@ -0,0 +1,154 @@
+#ifndef MICROBIT_ZONE_SCHEDULER_H
+#define MICROBIT_ZONE_SCHEDULER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "EventModel.h"
+
+#include "../../sensors/moisture/MicroBitMoistureSensor.h"
+#include "../../actuators/watering/MicroBitWateringActuator.h"
+
+#define MICROBIT_ID_ZONE_SCHEDULER              1240
+
+// Largest number of zones a scheduler can drive
+#define MICROBIT_ZONES_MAX                      8
+
+// Event ids of the sensors and actuators of zones other than zone 0
+#define MICROBIT_ID_ZONE_MOISTURE_BASE          1400
+#define MICROBIT_ID_ZONE_WATERING_BASE          1420
+
+// Frame the probe reads are spread over, in ms: each zone reads its probe in its own slot of
+// every frame. Slots are MICROBIT_ZONES_FRAME / zone count apart, more than a system tick.
+#define MICROBIT_ZONES_FRAME                    256
+
+// Event id of the moisture sensor and watering actuator of a zone
+#define MICROBIT_ID_ZONE_MOISTURE(zone)         ((zone) == 0 ? MICROBIT_ID_MOISTURE : MICROBIT_ID_ZONE_MOISTURE_BASE + (zone))
+#define MICROBIT_ID_ZONE_WATERING(zone)         ((zone) == 0 ? MICROBIT_ID_WATERING_ACTUATOR : MICROBIT_ID_ZONE_WATERING_BASE + (zone))
+
+// Status flags
+#define MICROBIT_ZONES_STARTED                  0x01
+
+/**
+  * Class definition for the MicroBitZoneScheduler.
+  *
+  * Coordinates several pots (zones), each with its own moisture sensor and watering actuator:
+  * - gives each sensor its own slot of a MICROBIT_ZONES_FRAME frame and takes every sample
+  *   in it, so that probe reads are interleaved rather than bunched in the same idle tick;
+  * - queues watering requests and never runs more than a given number of pumps at once,
+  *   so that the pumps do not brown out the board. Waiting zones are served round robin,
+  *   starting after the last zone served, so that no zone is starved;
+  * - once started, makes the system timer and idle callbacks of all the sensors and
+  *   actuators, so that the zones take one system component and one idle component
+  *   whatever their number.
+  */
+class MicroBitZoneScheduler : public MicroBitComponent
+{
+    public:
+
+    /**
+      * Constructor.
+      *
+      * @param sensors the moisture sensor of each zone.
+      * @param actuators the watering actuator of each zone.
+      * @param zoneCount the number of zones, up to MICROBIT_ZONES_MAX.
+      * @param maxPumps the number of pumps allowed to run at once.
+      * @param id the ID of the new MicroBitZoneScheduler object.
+      */
+    MicroBitZoneScheduler(MicroBitMoistureSensor *sensors, MicroBitWateringActuator *actuators, int zoneCount, int maxPumps, uint16_t id = MICROBIT_ID_ZONE_SCHEDULER);
+
+    /**
+      * Start serving the waiting waterings as the pumps stop, and making the callbacks of
+      * the sensors and actuators. Must be called once the message bus is available, and
+      * before the sensors are configured or sampled: a sensor that takes a sample first
+      * registers itself in the idle thread, and may take the room the scheduler needs.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_NO_RESOURCES if the system timer or the idle
+      *         thread has no room left: the sensors and actuators then register themselves.
+      */
+    int start();
+
+    /**
+      * Spread the samples of the sensors evenly over MICROBIT_ZONES_FRAME: every sample of a
+      * sensor is taken in the slot of its zone.
+      */
+    void interleave();
+
+    /**
+      * Ask for a watering of a zone. It starts immediately if a pump slot is free,
+      * otherwise as soon as one frees up.
+      *
+      * @param zone the zone to water.
+      * @param duration how long the pump runs, in ms.
+      * @param soak how long to wait for the water to soak in after the pump stops, in ms.
+      *
+      * @return MICROBIT_OK if the watering started or was queued, MICROBIT_BUSY if the zone is
+      *         already watering or waiting, MICROBIT_INVALID_PARAMETER if zone is out of range.
+      */
+    int request(int zone, uint32_t duration, uint32_t soak);
+
+    /**
+      * Drop a waiting request of a zone. Has no effect on a running pump.
+      *
+      * @param zone the zone.
+      */
+    void cancel(int zone);
+
+    /**
+      * Returns true if a watering of the zone is waiting for a pump slot.
+      */
+    bool isWaiting(int zone);
+
+    /**
+      * Returns the zone whose sensor or actuator has the given event id, or -1.
+      */
+    int zoneOf(uint16_t id);
+
+    /**
+      * Change the number of pumps allowed to run at once.
+      */
+    void setMaxPumps(int maxPumps);
+
+    /**
+      * Actuator update callback: starts waiting waterings when a pump stops.
+      */
+    void onActuatorUpdate(MicroBitEvent e);
+
+    /**
+      * Periodic callback from MicroBit system timer: calls back every actuator.
+      */
+    virtual void systemTick();
+
+    /**
+      * Periodic callback from MicroBit idle thread: calls back every sensor and actuator.
+      */
+    virtual void idleTick();
+
+#ifdef MICROBIT_SIM
+    /**
+      * Returns the earliest system time, in ms, a sensor or an actuator has work for.
+      */
+    virtual uint64_t getWakeupTime();
+#endif
+
+    private:
+
+    /**
+      * Start waiting waterings while pump slots are free.
+      */
+    void dispatch();
+
+    MicroBitMoistureSensor      *sensors;
+    MicroBitWateringActuator    *actuators;
+    uint8_t                     zoneCount;
+    uint8_t                     maxPumps;
+
+    // Next zone to consider, for round robin service
+    uint8_t                     next;
+
+    // Waiting requests
+    bool                        waiting[MICROBIT_ZONES_MAX];
+    uint32_t                    duration[MICROBIT_ZONES_MAX];
+    uint32_t                    soak[MICROBIT_ZONES_MAX];
+};
+
+#endif
@@ -1,48 +1,179 @@
 #include "MicroBit.h"
 
+#include "SmartVaseConfig.h"
+
 #include "MicroBitTemperatureService.h"
 #include "services/light/MicroBitLightService.h"
 #include "services/moisture/MicroBitMoistureService.h"
 #include "services/watering/MicroBitWateringService.h"
+#include "services/reservoir/MicroBitReservoirService.h"
+#include "services/telemetry/MicroBitTelemetryService.h"
+#include "services/history/MicroBitHistoryService.h"
+#include "services/command/MicroBitCommandService.h"
 
 #include "sensors/moisture/MicroBitMoistureSensor.h"
+#include "sensors/light/MicroBitAmbientLightSensor.h"
 
 #include "actuators/watering/MicroBitWateringActuator.h"
+#include "actuators/watering/MicroBitReservoir.h"
+
+#include "controllers/watering/MicroBitWateringController.h"
+#include "controllers/zones/MicroBitZoneScheduler.h"
+#include "controllers/forecast/MicroBitEvapotranspiration.h"
+#include "controllers/forecast/MicroBitDryingForecast.h"
 
-#define UPDATE_TIMEOUT 5000
+#include "storage/history/MicroBitHistory.h"
+#include "storage/config/MicroBitConfigStore.h"
+
+#include "utils/profiling/MicroBitProfiler.h"
+#include "utils/power/MicroBitPowerManager.h"
+#include "utils/services/MicroBitServiceRegistry.h"
+#include "utils/services/MicroBitWriteDispatcher.h"
 
-#define WATERING_EVENT_ID 55536 // Reserved events: [1-65535]
-#define WATERING_EVENT_REQUESTED 1
-#define WATERING_EVENT_STARTED 2
-#define WATERING_EVENT_ENDED 3
 #define WATERING_TIMEOUT 5000
 
-// uBit Services
+#define MOISTURE_BURST_SIZE 8
+
+// Number of pots driven by this micro:bit, see the zone table below
+#define ZONE_COUNT 1
+
+// Number of pumps allowed to run at the same time
+#define MAX_ACTIVE_PUMPS 1
+
+// Longest moisture reading period while the threshold is predicted to be far away, in ms, if
+// the slowest reading period allows it, and how many readings to take at least before it is
+// reached, on top of the filter lag
+#define FORECAST_MAX_PERIOD 900000
+#define FORECAST_READINGS 4
+
+// Temperature reading period in low power mode, in ms
+#define LOW_POWER_TEMPERATURE_PERIOD 60000
+
+// uBit Services, statically allocated and created once the control loop runs
 MicroBit uBit;
-MicroBitLightService *lightService;
-MicroBitTemperatureService *temperatureService;
-MicroBitMoistureService *moistureService;
-MicroBitWateringService *wateringService;
+MicroBitStaticService<MicroBitLightService> lightService;
+MicroBitStaticService<MicroBitTemperatureService> temperatureService;
+MicroBitStaticService<MicroBitMoistureService> moistureService;
+MicroBitStaticService<MicroBitWateringService> wateringService;
+MicroBitStaticService<MicroBitReservoirService> reservoirService;
+MicroBitStaticService<MicroBitHistoryService> historyService;
+MicroBitStaticService<MicroBitCommandService> commandService;
+
+#if CONFIG_ENABLED(SMART_VASE_TELEMETRY_SERVICE)
+MicroBitStaticService<MicroBitTelemetryService> telemetryService;
+#define TELEMETRY_SERVICE_GATT_SIZE MICROBIT_TELEMETRY_SERVICE_GATT_SIZE
+#define TELEMETRY_SERVICE_WRITE_HANDLERS MICROBIT_TELEMETRY_SERVICE_WRITE_HANDLERS
+#else
+#define TELEMETRY_SERVICE_GATT_SIZE 0
+#define TELEMETRY_SERVICE_WRITE_HANDLERS 0
+#endif
+
+static_assert(MICROBIT_GATT_RUNTIME_SIZE + MICROBIT_LIGHT_SERVICE_GATT_SIZE + MICROBIT_TEMPERATURE_SERVICE_GATT_SIZE +
+              MICROBIT_MOISTURE_SERVICE_GATT_SIZE + MICROBIT_WATERING_SERVICE_GATT_SIZE + MICROBIT_RESERVOIR_SERVICE_GATT_SIZE + MICROBIT_HISTORY_SERVICE_GATT_SIZE +
+              MICROBIT_COMMAND_SERVICE_GATT_SIZE + TELEMETRY_SERVICE_GATT_SIZE <= MICROBIT_SD_GATT_TABLE_SIZE,
+              "The BLE services do not fit the attribute table: raise gatt_table_size in config.json");
+
+// Handlers the services above add to the write dispatcher, checked against it once they are created
+#define WRITE_HANDLER_COUNT (MICROBIT_LIGHT_SERVICE_WRITE_HANDLERS + MICROBIT_TEMPERATURE_SERVICE_WRITE_HANDLERS + \
+                             MICROBIT_MOISTURE_SERVICE_WRITE_HANDLERS + MICROBIT_WATERING_SERVICE_WRITE_HANDLERS + MICROBIT_RESERVOIR_SERVICE_WRITE_HANDLERS + \
+                             MICROBIT_HISTORY_SERVICE_WRITE_HANDLERS + MICROBIT_COMMAND_SERVICE_WRITE_HANDLERS + TELEMETRY_SERVICE_WRITE_HANDLERS)
+
+static_assert(WRITE_HANDLER_COUNT <= MICROBIT_WRITE_DISPATCHER_HANDLERS,
+              "The BLE services do not fit the write dispatcher: raise MICROBIT_WRITE_DISPATCHER_HANDLERS");
+
+// Settings kept across resets, in flash pages of their own
+MicroBitFlash flash;
+MicroBitConfigStore config(flash);
+
+// Water tank shared by the pumps
+MicroBitReservoir reservoir;
+
+// Switches the display off when it is not used
+MicroBitPowerManager power(uBit.display);
+
+// Light sensed through the display LEDs, whether the display is on or not
+MicroBitAmbientLightSensor lightSensor(uBit.display);
+
+/**
+ * Zone table: one moisture sensor (read pin, excitation pin) and one pump pin per pot.
+ * Zone 0 is the one exposed by the BLE services.
+ *
+ * More zones can use any free pin; P3, P4 and P10 are analog inputs shared with the display.
+ * e.g. { uBit.io.P3, uBit.io.P8, MICROBIT_ID_ZONE_MOISTURE(1) } and { uBit.io.P12, reservoir, MICROBIT_ID_ZONE_WATERING(1) }
+ */
+MicroBitMoistureSensor moistureSensors[ZONE_COUNT] = {
+    { uBit.io.P0, uBit.io.P1, MICROBIT_ID_ZONE_MOISTURE(0) }
+};
+
+MicroBitWateringActuator wateringActuators[ZONE_COUNT] = {
+    { uBit.io.P2, reservoir, MICROBIT_ID_ZONE_WATERING(0) }
+};
+
+static_assert(ZONE_COUNT <= MICROBIT_ZONES_MAX, "Too many zones for the zone scheduler: raise MICROBIT_ZONES_MAX");
+
+// Controllers. The scheduler calls back the sensors and pumps of every zone, so that more
+// zones do not take more of the idle thread and system timer components.
+MicroBitWateringController wateringControllers[ZONE_COUNT];
+MicroBitZoneScheduler zoneScheduler(moistureSensors, wateringActuators, ZONE_COUNT, MAX_ACTIVE_PUMPS);
+
+// Drying predictions
+MicroBitEvapotranspiration evapotranspiration;
+MicroBitDryingForecast dryingForecasts[ZONE_COUNT];
+
+// Last temperature reading, in degrees Celsius, valid once the thermometer is calibrated
+int temperature = 0;
+bool temperatureKnown = false;
 
-// Sensors
-MicroBitMoistureSensor moistureSensor(uBit.io.P0, uBit.io.P1);
-MicroBitWateringActuator wateringActuator(uBit.io.P2);
+// Longest moisture reading period while the forecast knows nothing better, in ms
+uint32_t maxSamplePeriod = MICROBIT_MOISTURE_MAX_PERIOD;
+
+// History of the readings
+MicroBitHistory history;
+uint64_t nextHistoryTime = 0;
+bool wateredSinceHistory = false;
 
 // Images
 MicroBitImage drop("0,0,255,0, 0\n0,0,255,0,0\n0,255,0,255,0\n255,0,0,0,255\n0,255,0,255,0\n");
 MicroBitImage arrowDown("0,0,255,0, 0\n0,0,255,0,0\n255,0,255,0,255\n0,255,255,255,0\n0,0,255,0,0\n");
 
 /**
- * If true the watering operation is forced to run
+ * If true the watering operation of the zone is forced to run
+ */
+bool forceWatering[ZONE_COUNT];
+
+/**
+ * If true the watering drop is shown
  */
-bool forceWatering = false;
+bool showingDrop = false;
+
+/**
+ * Length of the forced waterings, in ms
+ */
+uint32_t forcedPulse = WATERING_TIMEOUT;
+
+/**
+ * Scrolls a message, keeping the display on until it is over.
+ */
+void scrollAsync(ManagedString s)
+{
+    if (uBit.display.scrollAsync(s) == MICROBIT_OK)
+        power.acquireDisplay();
+}
+
+/**
+ * Releases the display once a message has been scrolled.
+ */
+void onAnimationComplete(MicroBitEvent)
+{
+    power.releaseDisplay();
+}
 
 /**
  * A listener to perform actions after a BLE device connects.
  */
 void onConnected(MicroBitEvent)
 {
-    uBit.display.scrollAsync('C');
+    scrollAsync('C');
     uBit.sleep(50);
 }
 
@@ -51,147 +182,603 @@ void onConnected(MicroBitEvent)
  */
 void onDisconnected(MicroBitEvent)
 {
-    uBit.display.scrollAsync('D');
+    scrollAsync('D');
     uBit.sleep(50);
 }
 
 /**
- * Return true if watering is needed.
+ * Return the moisture level under which the plants are watered. Read from the settings,
+ * so that it is available before the BLE services are created.
+ */
+int32_t moistureTreshold()
+{
+    return config.get().moistureTreshold;
+}
+
+/**
+ * Return true if watering of a zone is needed.
+ *
+ * @param zone the zone.
+ * @param moisture the latest moisture reading of the zone.
  */
-bool canWater()
+bool canWater(int zone, int32_t moisture)
 {
+    MicroBitWateringActuator &actuator = wateringActuators[zone];
+
     // No watering if the vase is actually watering the plant or there isn't enough water
-    if (wateringActuator.isWatering() || !wateringActuator.enoughWater())
+    if (actuator.isWatering() || zoneScheduler.isWaiting(zone) || !actuator.enoughWater())
     {
         return false;
     }
 
-    if (forceWatering)
+    if (forceWatering[zone])
         return true;
 
-    // Check moisture level for watering
-    int32_t moisture = moistureSensor.getMoistureLevel();
+    // Leave the water of the last watering the time to soak in
+    if (actuator.isSoaking())
+        return false;
 
-    return moisture < (*moistureService).getMoistureLevelTreshold();
+    // Check moisture level for watering
+    return wateringControllers[zone].needsWatering(moisture, moistureTreshold());
 }
 
 /**
- * Initialise the micro:bit and its sensors.
+ * Ask the scheduler for a watering of a zone, if needed.
+ * Forced waterings run for forcedPulse, the others for the time computed by the controller.
+ *
+ * @param zone the zone.
  */
-void init()
+void checkWatering(int zone)
 {
-    // Initialise the micro:bit runtime.
-    uBit.init();
+    int32_t moisture = moistureSensors[zone].getMoistureLevel();
 
-    // Calibrate termometer
-    uBit.thermometer.setCalibration(uBit.thermometer.getTemperature());
+    if (!canWater(zone, moisture))
+        return;
 
-    // This will returns 0 on the first call
-    uBit.display.readLightLevel();
-    uBit.display.setDisplayMode(DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE);
+    uint32_t pulse = forcedPulse;
+
+    if (!forceWatering[zone])
+        pulse = wateringControllers[zone].pulseLength(moisture, moistureTreshold());
+
+    zoneScheduler.request(zone, pulse, wateringControllers[zone].getSoakTime());
+
+    // disable forcing watering after watering
+    forceWatering[zone] = false;
 }
 
+#if CONFIG_ENABLED(SMART_VASE_PROFILING)
 /**
- * Start and stop the watering actuator.
+ * Periodically reports the profiling results over serial.
  */
-void performWatering()
+void profilerFiber()
 {
-    if (!wateringActuator.isWatering())
+    while (1)
     {
-        wateringActuator.startWatering();
+        uBit.sleep(SMART_VASE_PROFILING_PERIOD);
 
-        uBit.display.printAsync(drop);
+        uBit.serial.printf("profile,%d\r\n", (int)system_timer_current_time());
+        MicroBitProfiler::report(uBit.serial);
+        MicroBitProfiler::reset();
 
-        uBit.sleep(WATERING_TIMEOUT);
+        power.report(uBit.serial);
+        power.reset();
+    }
+}
+#endif
 
-        wateringActuator.stopWatering();
+/**
+ * Handler for remote watering requests, for zone 0.
+ */
+void onWateringRequested(MicroBitEvent)
+{
+    // Remote requests are forced waterings
+    forceWatering[0] = true;
+    checkWatering(0);
+}
 
-        uBit.display.clear();
+/**
+ * Stops the pump of a zone at once, or drops its queued watering. The shortened pulse is
+ * not used to learn the soil response.
+ *
+ * @param zone the zone.
+ * @param abort true to skip the soak time as well.
+ */
+void stopWatering(int zone, bool abort)
+{
+    MicroBitWateringActuator &actuator = wateringActuators[zone];
 
-        // disable forcing watering after watering
-        forceWatering = false;
-    }
+    zoneScheduler.cancel(zone);
+
+    // An aborted soak is cut short as well
+    if (actuator.isWatering() || (abort && actuator.isSoaking()))
+        wateringControllers[zone].pulseCancelled();
+
+    if (abort)
+        actuator.abortWatering();
+    else
+        actuator.stopWatering();
 }
 
 /**
- * Fiber code to check sensor values.
+ * Handler for remote stop requests, for zone 0.
  */
-void updateFiber()
+void onWateringStopRequested(MicroBitEvent)
 {
-    while (1)
+    stopWatering(0, false);
+}
+
+/**
+ * Calibrate the zone 0 probe and save the calibration.
+ *
+ * @param dry the raw reading in dry soil, MICROBIT_COMMAND_CALIBRATION_KEEP or MICROBIT_COMMAND_CALIBRATION_CURRENT for the last reading.
+ * @param wet the raw reading in saturated soil, MICROBIT_COMMAND_CALIBRATION_KEEP or MICROBIT_COMMAND_CALIBRATION_CURRENT for the last reading.
+ * @param curve the MICROBIT_MOISTURE_CURVE_* between them.
+ *
+ * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the calibration is not valid.
+ */
+int calibrateProbe(int dry, int wet, int curve)
+{
+    MicroBitMoistureSensor &sensor = moistureSensors[0];
+
+    if (dry == MICROBIT_COMMAND_CALIBRATION_KEEP)
+        dry = sensor.getCalibration().getDry();
+
+    if (wet == MICROBIT_COMMAND_CALIBRATION_KEEP)
+        wet = sensor.getCalibration().getWet();
+
+    if (dry == MICROBIT_COMMAND_CALIBRATION_CURRENT)
+        dry = sensor.getRawLevel();
+
+    if (wet == MICROBIT_COMMAND_CALIBRATION_CURRENT)
+        wet = sensor.getRawLevel();
+
+    int result = sensor.setCalibration(dry, wet, curve);
+
+    if (result != MICROBIT_OK)
+        return result;
+
+    // Show the new scale without waiting for the next reading
+    sensor.setNextSample(0);
+
+    MicroBitConfigData data = config.get();
+    data.moistureCurve = curve;
+    data.moistureDry = dry;
+    data.moistureWet = wet;
+    config.update(data);
+
+    return MICROBIT_OK;
+}
+
+/**
+ * Handler for command batches: applies every command of the batch, settings first, then
+ * acknowledges it. Watering commands and the calibration apply to zone 0, sampling periods
+ * and the temperature compensation to every zone.
+ */
+void onCommandReceived(MicroBitEvent)
+{
+    const MicroBitCommandBatch &batch = commandService->getBatch();
+
+    // Checked first: points taken from the probe are only known now, and nothing is
+    // applied if they are not valid
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_SET_CALIBRATION))
     {
-        // Check for watering
-        if (canWater())
+        if (calibrateProbe(batch.calibrationDry, batch.calibrationWet, batch.calibrationCurve) != MICROBIT_OK)
         {
-            MicroBitEvent evt = MicroBitEvent(WATERING_EVENT_ID, WATERING_EVENT_REQUESTED);
-            evt.fire();
+            commandService->acknowledge(MICROBIT_COMMAND_STATUS_INVALID);
+            return;
         }
+    }
+
+    // Only a running pump can be extended, checked before anything is applied as well
+    if ((batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_EXTEND_WATERING)) && !wateringActuators[0].isWatering())
+    {
+        commandService->acknowledge(MICROBIT_COMMAND_STATUS_INVALID);
+        return;
+    }
+
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_SET_PULSE))
+        forcedPulse = batch.pulse;
 
-        // Sleep a bit before update again
-        uBit.sleep(UPDATE_TIMEOUT);
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_SET_COMPENSATION))
+    {
+        for (int i = 0; i < ZONE_COUNT; i++)
+            moistureSensors[i].setTemperatureCompensation(batch.compensation);
+
+        MicroBitConfigData data = config.get();
+        data.moistureCompensation = batch.compensation;
+        config.update(data);
+    }
+
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_SET_PERIODS))
+    {
+        for (int i = 0; i < ZONE_COUNT; i++)
+            moistureSensors[i].setAdaptivePeriod(batch.minPeriod, batch.maxPeriod);
+
+        maxSamplePeriod = batch.maxPeriod;
+    }
+
+    // Saved and checked against the moisture by onMoistureUpdated
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_SET_TRESHOLD))
+        moistureService->setMoistureLevelTreshold(batch.treshold);
+
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_STOP_WATERING))
+        stopWatering(0, false);
+
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_ABORT_WATERING))
+        stopWatering(0, true);
+
+    // Like a shortened pulse, a lengthened one is not used to learn the soil response
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_EXTEND_WATERING))
+    {
+        wateringControllers[0].pulseCancelled();
+        wateringActuators[0].extendWatering(batch.extension);
+    }
+
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_START_WATERING))
+    {
+        forceWatering[0] = true;
+        checkWatering(0);
     }
+
+    if (batch.commands & MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_REQUEST_HISTORY))
+        historyService->stream(batch.historyFrom, batch.historyCount);
+
+    commandService->acknowledge();
 }
 
 /**
- * Handles watering.
+ * Handler for Button A click: forces the watering of every zone.
  */
-void wateringFiber()
+void onButtonAPressed(MicroBitEvent)
 {
-    while (1)
+    for (int i = 0; i < ZONE_COUNT; i++)
     {
-        // Wait for the watering event
-        fiber_wait_for_event(WATERING_EVENT_ID, WATERING_EVENT_REQUESTED);
-        performWatering();
+        forceWatering[i] = true;
+        checkWatering(i);
     }
 }
 
-void onWateringRequested(MicroBitEvent)
+/**
+ * Handler for Button B click: the tank has been refilled. Shows the water available, in ml.
+ */
+void onButtonBPressed(MicroBitEvent)
 {
-    MicroBitEvent evt = MicroBitEvent(WATERING_EVENT_ID, WATERING_EVENT_REQUESTED);
-    evt.fire();
+    reservoir.refill();
+
+    scrollAsync((int)(reservoir.getVolume() / 1000));
 }
 
 /**
- * Handler for Button A click.
+ * Stores the readings of zone 0 in the history, once every MICROBIT_HISTORY_PERIOD.
  */
-void onButtonAPressed(MicroBitEvent)
+void onHistoryUpdate(MicroBitEvent)
 {
-    forceWatering = true;
+    uint64_t now = system_timer_current_time();
+
+    if (now < nextHistoryTime)
+        return;
+
+    nextHistoryTime = now + MICROBIT_HISTORY_PERIOD;
+
+    MicroBitHistorySample sample;
+    sample.time = now / 1000;
+    sample.moisture = moistureSensors[0].getMoistureLevel();
+    sample.light = lightSensor.getLightLevel();
+    sample.temperature = temperature;
+    sample.flags = wateredSinceHistory ? MICROBIT_HISTORY_FLAG_WATERING : 0;
+
+    // Before the thermometer is calibrated
+    if (!temperatureKnown)
+        sample.flags |= MICROBIT_HISTORY_FLAG_NO_TEMPERATURE;
+
+    history.record(sample);
+    wateredSinceHistory = false;
 }
 
-void onButtonBPressed(MicroBitEvent)
+/**
+ * Follows the watering of a zone: shows it, tells the controller, remembers it for the next
+ * history record, and samples the moisture fast while the water soaks in.
+ */
+void onWateringUpdate(MicroBitEvent e)
+{
+    int zone = zoneScheduler.zoneOf(e.source);
+
+    if (zone < 0)
+        return;
+
+    MicroBitWateringActuator &actuator = wateringActuators[zone];
+
+    if (actuator.isWatering())
+    {
+        wateringControllers[zone].pulseStarted(actuator.getPulseLength(), moistureSensors[zone].getMoistureLevel());
+        dryingForecasts[zone].restart();
+        wateredSinceHistory = true;
+    }
+
+    // Show the drop while any pump runs
+    bool watering = false;
+
+    for (int i = 0; i < ZONE_COUNT; i++)
+        watering = watering || wateringActuators[i].isWatering();
+
+    if (watering)
+    {
+        if (!showingDrop)
+            power.acquireDisplay();
+
+        uBit.display.printAsync(drop);
+    }
+    else if (showingDrop)
+    {
+        uBit.display.clear();
+        power.releaseDisplay();
+    }
+
+    showingDrop = watering;
+
+    moistureSensors[zone].boost();
+}
+
+/**
+ * Once the water has soaked in, learns from the moisture reached and checks again.
+ */
+void onWateringSoaked(MicroBitEvent e)
 {
-    wateringActuator.setWateringCount(MICROBIT_WATERINGS_COUNT);
-    uBit.display.scrollAsync(wateringActuator.getWateringCount());
+    int zone = zoneScheduler.zoneOf(e.source);
+
+    if (zone < 0)
+        return;
+
+    wateringControllers[zone].pulseSoaked(moistureSensors[zone].getMoistureLevel(), moistureTreshold());
+
+    checkWatering(zone);
 }
 
 void onMoistureUpdated(MicroBitEvent)
 {
-    int t = (int)(*moistureService).getMoistureLevelTreshold();
-    uBit.display.scrollAsync(t);
+    int t = (int)moistureService->getMoistureLevelTreshold();
+    scrollAsync(t);
+
+    MicroBitConfigData data = config.get();
+    data.moistureTreshold = t;
+    config.update(data);
+
+    for (int i = 0; i < ZONE_COUNT; i++)
+        checkWatering(i);
+}
+
+/**
+ * Saves the water level after every change.
+ */
+void onReservoirUpdate(MicroBitEvent)
+{
+    MicroBitConfigData data = config.get();
+    data.reservoir = reservoir.getState();
+    config.update(data);
 }
 
-int main()
+/**
+ * Plans the next moisture readings of a zone from the drying forecast: while the
+ * threshold is predicted to be far away the readings are spread out, up to
+ * FORECAST_MAX_PERIOD, and they get closer as it approaches. The slowest reading period
+ * set by the gateway still bounds them, so that the readings and their keep-alive
+ * notifications keep the pace it asked for.
+ *
+ * @param zone the zone.
+ */
+void planSamples(int zone)
+{
+    MicroBitMoistureSensor &sensor = moistureSensors[zone];
+    MicroBitWateringActuator &actuator = wateringActuators[zone];
+    int32_t moisture = sensor.getMoistureLevel();
+
+    dryingForecasts[zone].update(moisture, evapotranspiration.getTotal());
+
+    // Follow the water closely while it is given and soaks in
+    if (actuator.isWatering() || actuator.isSoaking())
+        return;
+
+    // Nothing learned yet
+    if (dryingForecasts[zone].getCost() == 0)
+    {
+        sensor.setMaxPeriod(maxSamplePeriod);
+        return;
+    }
+
+    // Until the watering, one point under the threshold. In seconds, MICROBIT_DRYING_UNKNOWN if
+    // beyond the forecast horizon
+    uint32_t eta = dryingForecasts[zone].timeToThreshold(moisture, moistureTreshold() - 1, evapotranspiration);
+    uint32_t maxPeriod = maxSamplePeriod < FORECAST_MAX_PERIOD ? maxSamplePeriod : FORECAST_MAX_PERIOD;
+
+    // The filtered moisture lags the soil by MICROBIT_MOISTURE_FILTER_LAG readings: fit those
+    // before the threshold too, so that the crossing is seen on time. Near the threshold this
+    // reads faster than maxSamplePeriod, down to the shortest period.
+    if (eta < maxPeriod / 1000 * (FORECAST_READINGS + MICROBIT_MOISTURE_FILTER_LAG))
+        maxPeriod = eta * 1000 / (FORECAST_READINGS + MICROBIT_MOISTURE_FILTER_LAG);
+
+    sensor.setMaxPeriod(maxPeriod);
+}
+
+/**
+ * Evaluates the watering decision on every new moisture reading.
+ */
+void onMoistureSample(MicroBitEvent e)
+{
+    int zone = zoneScheduler.zoneOf(e.source);
+
+    if (zone < 0)
+        return;
+
+    checkWatering(zone);
+    planSamples(zone);
+}
+
+/**
+ * Caches every new temperature reading, and in the moisture sensors for their temperature
+ * compensation: the thermometer is not read again for each moisture or light reading.
+ */
+void onTemperatureSample(MicroBitEvent)
+{
+    temperature = uBit.thermometer.getTemperature();
+    temperatureKnown = true;
+
+    for (int i = 0; i < ZONE_COUNT; i++)
+        moistureSensors[i].setTemperature(temperature);
+}
+
+/**
+ * Integrates the evaporative demand on every new light reading, once the temperature is known.
+ */
+void onLightSample(MicroBitEvent)
+{
+    if (temperatureKnown)
+        evapotranspiration.update(lightSensor.getLightLevel(), temperature);
+}
+
+/**
+ * Brings up what is needed to monitor the moisture and drive the pumps safely: the saved
+ * settings, the sensors and the control loop. Kept short, so that the vase is back in
+ * control right after a reset.
+ */
+void startControl()
+{
+    // Restore the settings and the water level saved before the reset
+    config.load();
+    reservoir.setState(config.get().reservoir);
+
+    // Convert the zone 0 probe readings with its saved calibration
+    const MicroBitConfigData &settings = config.get();
+    moistureSensors[0].setCalibration(settings.moistureDry, settings.moistureWet, settings.moistureCurve);
+
+    // Measure the sleep time, and save power if asked to
+    power.start();
+
+#if CONFIG_ENABLED(SMART_VASE_LOW_POWER)
+    power.setLowPower(true);
+    uBit.thermometer.setPeriod(LOW_POWER_TEMPERATURE_PERIOD);
+#endif
+
+    uBit.messageBus.listen(MICROBIT_ID_DISPLAY, MICROBIT_DISPLAY_EVT_ANIMATION_COMPLETE, onAnimationComplete);
+
+    // Do not read all the probes in the same idle tick, nor run too many pumps at once.
+    // Started first: configuring a sensor takes a sample, and would register the sensor
+    // in the idle thread on its own.
+    zoneScheduler.interleave();
+    zoneScheduler.start();
+
+    for (int i = 0; i < ZONE_COUNT; i++)
+    {
+        // Average a burst of conversions for each moisture reading
+        moistureSensors[i].setBurst(MOISTURE_BURST_SIZE, MOISTURE_REDUCTION_TRIMMED_MEAN);
+
+        // Sample fast only while the moisture changes
+        moistureSensors[i].setAdaptivePeriod(MICROBIT_MOISTURE_PERIOD, MICROBIT_MOISTURE_MAX_PERIOD);
+
+        // Same probes and thermometer for every zone
+        moistureSensors[i].setTemperatureCompensation(settings.moistureCompensation);
+    }
+
+    uBit.messageBus.listen(MICROBIT_ID_BUTTON_A, MICROBIT_BUTTON_EVT_CLICK, onButtonAPressed);
+    uBit.messageBus.listen(MICROBIT_ID_BUTTON_B, MICROBIT_BUTTON_EVT_CLICK, onButtonBPressed);
+    uBit.messageBus.listen(MICROBIT_ID_RESERVOIR, MICROBIT_RESERVOIR_EVT_UPDATE, onReservoirUpdate);
+
+    // Control loop, for every zone
+    for (int i = 0; i < ZONE_COUNT; i++)
+    {
+        uBit.messageBus.listen(moistureSensors[i].id, MICROBIT_MOISTURE_EVT_UPDATE, onMoistureSample);
+        uBit.messageBus.listen(wateringActuators[i].id, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE, onWateringUpdate);
+        uBit.messageBus.listen(wateringActuators[i].id, MICROBIT_WATERING_ACTUATOR_EVT_SOAKED, onWateringSoaked);
+    }
+
+    // History
+    uBit.messageBus.listen(moistureSensors[0].id, MICROBIT_MOISTURE_EVT_UPDATE, onHistoryUpdate);
+
+    // Drying forecast
+    uBit.messageBus.listen(lightSensor.id, MICROBIT_AMBIENT_LIGHT_EVT_UPDATE, onLightSample);
+
+    // Start sampling: the sensors take their first reading in their slot
+    for (int i = 0; i < ZONE_COUNT; i++)
+        moistureSensors[i].updateSample();
+
+    lightSensor.updateSample();
+}
+
+/**
+ * Calibrates the sensors and registers the BLE services, once the control loop is running.
+ */
+void bootFiber()
 {
-    init();
+    // Measure how long the moisture probes need to be powered before reading them.
+    // Until then the probes are read with the longest settling time.
+    for (int i = 0; i < ZONE_COUNT; i++)
+    {
+        moistureSensors[i].calibrateExcitation();
+
+        // Let the control loop run between the steps
+        schedule();
+    }
+
+    // Calibrate termometer
+    uBit.thermometer.setCalibration(uBit.thermometer.getTemperature());
+
+    // Temperature compensation and demand estimate, from the first calibrated reading on
+    uBit.messageBus.listen(MICROBIT_ID_THERMOMETER, MICROBIT_THERMOMETER_EVT_UPDATE, onTemperatureSample);
+    onTemperatureSample(MicroBitEvent());
+
+    PROFILER_MILESTONE(PROFILER_BOOT_CALIBRATED);
+
+    schedule();
 
     // BLE setup
     uBit.messageBus.listen(MICROBIT_ID_BLE, MICROBIT_BLE_EVT_CONNECTED, onConnected);
     uBit.messageBus.listen(MICROBIT_ID_BLE, MICROBIT_BLE_EVT_DISCONNECTED, onDisconnected);
-    uBit.messageBus.listen(MICROBIT_ID_BUTTON_A, MICROBIT_BUTTON_EVT_CLICK, onButtonAPressed);
     uBit.messageBus.listen(MICROBIT_ID_WATERING_SERVICE, WATERING_EVT_REQUESTED, onWateringRequested);
+    uBit.messageBus.listen(MICROBIT_ID_WATERING_SERVICE, WATERING_EVT_STOP_REQUESTED, onWateringStopRequested);
     uBit.messageBus.listen(MICROBIT_ID_MOISTURE_SERVICE, MOISTURE_TRESHOLD_UPDATED, onMoistureUpdated);
+    uBit.messageBus.listen(MICROBIT_ID_COMMAND_SERVICE, COMMAND_EVT_RECEIVED, onCommandReceived);
 
-    uBit.messageBus.listen(MICROBIT_ID_BUTTON_B, MICROBIT_BUTTON_EVT_CLICK, onButtonBPressed);
+    lightService.create(*uBit.ble, lightSensor);
+    temperatureService.create(*uBit.ble, uBit.thermometer);
+    moistureService.create(*uBit.ble, moistureSensors[0], moistureTreshold());
+    wateringService.create(*uBit.ble, wateringActuators[0]);
+    reservoirService.create(*uBit.ble, reservoir);
+    historyService.create(*uBit.ble, history);
+    commandService.create(*uBit.ble);
 
-    lightService = new MicroBitLightService(*uBit.ble, uBit.display);
-    temperatureService = new MicroBitTemperatureService(*uBit.ble, uBit.thermometer);
-    moistureService = new MicroBitMoistureService(*uBit.ble, moistureSensor);
-    wateringService = new MicroBitWateringService(*uBit.ble, wateringActuator);
+#if CONFIG_ENABLED(SMART_VASE_TELEMETRY_SERVICE)
+    telemetryService.create(*uBit.ble, lightSensor, uBit.thermometer, moistureSensors[0], wateringActuators[0]);
+#endif
 
-    // Setup fibers
-    create_fiber(updateFiber);
-    create_fiber(wateringFiber);
+    // A service whose handler count is out of date would leave the check above blind
+    if (MicroBitWriteDispatcher::getCount() != WRITE_HANDLER_COUNT)
+        microbit_panic(MICROBIT_WRITE_DISPATCHER_PANIC);
+
+    PROFILER_MILESTONE(PROFILER_BOOT_SERVICES);
+
+#if CONFIG_ENABLED(SMART_VASE_PROFILING)
+    MicroBitProfiler::reportBoot(uBit.serial);
+#endif
+}
+
+int main()
+{
+    PROFILER_MILESTONE(PROFILER_BOOT_START);
+
+    // Initialise the micro:bit runtime.
+    uBit.init();
+
+    PROFILER_MILESTONE(PROFILER_BOOT_RUNTIME);
+
+    startControl();
+
+    PROFILER_MILESTONE(PROFILER_BOOT_CONTROL);
+
+    // Calibrations and BLE services are brought up in the background
+    create_fiber(bootFiber);
+
+#if CONFIG_ENABLED(SMART_VASE_PROFILING)
+    create_fiber(profilerFiber);
+#endif
 
     release_fiber();
-}
\ No newline at end of file
+}
@@ -0,0 +1,202 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "mbed.h"
+#include "MicroBitConfig.h"
+#include "MicroBitAmbientLightSensor.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitFiber.h"
+#include "MicroBitEvent.h"
+
+/**
+  * Constructor.
+  * Create new MicroBitAmbientLightSensor that gives an indication of the current light level.
+  *
+  * @param _display the display whose LEDs are used as light sensors.
+  * @param id the unique EventModel id of this component. Defaults to MICROBIT_ID_AMBIENT_LIGHT.
+  *
+  * @code
+  * MicroBitAmbientLightSensor lightSensor(uBit.display);
+  * @endcode
+  */
+MicroBitAmbientLightSensor::MicroBitAmbientLightSensor(MicroBitDisplay &_display, uint16_t id) : display(_display)
+{
+    this->id = id;
+    this->samplePeriod = MICROBIT_AMBIENT_LIGHT_PERIOD;
+    this->sampleTime = 0;
+    this->level = 0;
+}
+
+/**
+  * Gets the current light level, filtered.
+  *
+  * @return the light level, from 0 (dark) to 255 (bright).
+  */
+int32_t MicroBitAmbientLightSensor::getLightLevel()
+{
+    updateSample();
+    return level;
+}
+
+/**
+  * Updates the light sample of this instance of MicroBitAmbientLightSensor
+  * only if isSampleNeeded() indicates that an update is required.
+  *
+  * This call also will add the sensor to fiber components to receive
+  * periodic callbacks.
+  *
+  * @return MICROBIT_OK on success.
+  */
+int MicroBitAmbientLightSensor::updateSample()
+{
+    if(!(status & MICROBIT_AMBIENT_LIGHT_ADDED_TO_IDLE))
+    {
+        // Without room for the callback, try again on the next read
+        if (fiber_add_idle_component(this) == MICROBIT_OK)
+            status |= MICROBIT_AMBIENT_LIGHT_ADDED_TO_IDLE;
+    }
+
+    if(isSampleNeeded())
+    {
+        level = filter.apply(acquire());
+
+        // Schedule our next sample.
+        sampleTime = system_timer_current_time() + samplePeriod;
+
+        // Send an event to indicate that we've updated our light level.
+        MicroBitEvent e(id, MICROBIT_AMBIENT_LIGHT_EVT_UPDATE);
+    }
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Read the light through the LEDs.
+  *
+  * Rows (anodes) are driven low and each column (cathode) charged high, reverse biasing
+  * its LEDs. The column is then left floating: the brighter the light, the larger the
+  * photocurrent and the lower the voltage left after the discharge time.
+  *
+  * @return the light level, from 0 (dark) to 255 (bright).
+  */
+int MicroBitAmbientLightSensor::acquire()
+{
+    bool running = display.status & MICROBIT_COMPONENT_RUNNING;
+    int32_t sum = 0;
+
+    // Stop the multiplexing while we use the pins
+    if (running)
+        display.disable();
+
+    for (int i = 0; i < MICROBIT_AMBIENT_LIGHT_ROWS; i++)
+        DigitalOut row((PinName)(MICROBIT_AMBIENT_LIGHT_ROW_START + i), 0);
+
+    for (int i = 0; i < MICROBIT_AMBIENT_LIGHT_COLUMNS; i++)
+    {
+        PinName pin = (PinName)(MICROBIT_AMBIENT_LIGHT_COLUMN_START + i);
+
+        {
+            DigitalOut charge(pin, 1);
+        }
+
+        {
+            DigitalIn discharge(pin, PullNone);
+        }
+
+        wait_us(MICROBIT_AMBIENT_LIGHT_DISCHARGE_TIME);
+
+        {
+            AnalogIn sense(pin);
+            sum += sense.read_u16() >> 6;
+        }
+
+        // Leave the column as the display expects it: LEDs off
+        DigitalOut off(pin, 1);
+    }
+
+    if (running)
+        display.enable();
+
+    int32_t raw = sum / MICROBIT_AMBIENT_LIGHT_COLUMNS;
+
+    if (raw < MICROBIT_AMBIENT_LIGHT_MIN_VALUE)
+        raw = MICROBIT_AMBIENT_LIGHT_MIN_VALUE;
+
+    if (raw > MICROBIT_AMBIENT_LIGHT_MAX_VALUE)
+        raw = MICROBIT_AMBIENT_LIGHT_MAX_VALUE;
+
+    return (MICROBIT_AMBIENT_LIGHT_MAX_VALUE - raw) * 255 / (MICROBIT_AMBIENT_LIGHT_MAX_VALUE - MICROBIT_AMBIENT_LIGHT_MIN_VALUE);
+}
+
+/**
+  * Periodic callback from MicroBit idle thread.
+  */
+void MicroBitAmbientLightSensor::idleTick()
+{
+    updateSample();
+}
+
+#ifdef MICROBIT_SIM
+/**
+  * Returns the system time, in ms, of the next sample.
+  */
+uint64_t MicroBitAmbientLightSensor::getWakeupTime()
+{
+    return sampleTime;
+}
+#endif
+
+/**
+  * Determines if we're due to take another light reading
+  *
+  * @return 1 if we're due to take a light reading, 0 otherwise.
+  */
+int MicroBitAmbientLightSensor::isSampleNeeded()
+{
+    return  system_timer_current_time() >= sampleTime;
+}
+
+/**
+  * Set the sample rate at which the light is read (in ms).
+  *
+  * The default sample period is MICROBIT_AMBIENT_LIGHT_PERIOD.
+  *
+  * @param period the requested time between samples, in milliseconds.
+  */
+void MicroBitAmbientLightSensor::setPeriod(int period)
+{
+    updateSample();
+    samplePeriod = period;
+}
+
+/**
+  * Reads the currently configured sample rate of the sensor.
+  *
+  * @return The time between samples, in milliseconds.
+  */
+int MicroBitAmbientLightSensor::getPeriod()
+{
+    return samplePeriod;
+}
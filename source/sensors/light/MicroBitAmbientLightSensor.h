@@ -0,0 +1,163 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_AMBIENT_LIGHT_SENSOR_H
+#define MICROBIT_AMBIENT_LIGHT_SENSOR_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "MicroBitDisplay.h"
+
+#include "../../utils/filters/MicroBitFilters.h"
+
+#define MICROBIT_ID_AMBIENT_LIGHT               1239
+
+#define MICROBIT_AMBIENT_LIGHT_PERIOD           5000
+
+// LED matrix pins, as nRF51 GPIO numbers: the anodes (rows) and the cathodes (columns)
+// wired to an analog input.
+#define MICROBIT_AMBIENT_LIGHT_ROW_START        13
+#define MICROBIT_AMBIENT_LIGHT_ROWS             3
+#define MICROBIT_AMBIENT_LIGHT_COLUMN_START     4
+#define MICROBIT_AMBIENT_LIGHT_COLUMNS          3
+
+// Time the reverse biased LEDs are left to discharge through their photocurrent, in microseconds
+#define MICROBIT_AMBIENT_LIGHT_DISCHARGE_TIME   1500
+
+// Range of the raw ADC readings, from bright to dark
+#define MICROBIT_AMBIENT_LIGHT_MIN_VALUE        75
+#define MICROBIT_AMBIENT_LIGHT_MAX_VALUE        338
+
+/*
+ * Light events
+ */
+#define MICROBIT_AMBIENT_LIGHT_EVT_UPDATE       1
+
+#define MICROBIT_AMBIENT_LIGHT_ADDED_TO_IDLE    2
+
+/**
+  * Filter applied to each light reading: a median of 3 drops isolated spikes, e.g. a
+  * shadow passing by, and an EMA averages the rest.
+  */
+typedef MicroBitFilterChain<MicroBitMedianFilter<3>, MicroBitEmaFilter<1> > MicroBitAmbientLightFilter;
+
+/**
+  * Class definition for MicroBit Ambient Light Sensor.
+  *
+  * Reads the light level (0 - 255) with the LEDs of the display, in the same way as the
+  * display light sense mode, but on its own schedule: the display does not need to be
+  * multiplexed, and can be switched off. Each reading reverse biases the LEDs, lets them
+  * discharge for MICROBIT_AMBIENT_LIGHT_DISCHARGE_TIME, and converts the voltage left on the
+  * three analog columns. If the display is running, it is paused for the few ms this takes.
+  *
+  * The display light sense mode must not be used at the same time.
+  */
+class MicroBitAmbientLightSensor : public MicroBitComponent
+{
+    unsigned long               sampleTime;
+    uint32_t                    samplePeriod;
+    int32_t                     level;
+    MicroBitDisplay             &display;
+    MicroBitAmbientLightFilter  filter;
+
+    public:
+
+    /**
+      * Constructor.
+      * Create new MicroBitAmbientLightSensor that gives an indication of the current light level.
+      *
+      * @param _display the display whose LEDs are used as light sensors.
+      * @param id the unique EventModel id of this component. Defaults to MICROBIT_ID_AMBIENT_LIGHT.
+      *
+      * @code
+      * MicroBitAmbientLightSensor lightSensor(uBit.display);
+      * @endcode
+      */
+    MicroBitAmbientLightSensor(MicroBitDisplay &_display, uint16_t id = MICROBIT_ID_AMBIENT_LIGHT);
+
+    /**
+      * Set the sample rate at which the light is read (in ms).
+      *
+      * The default sample period is MICROBIT_AMBIENT_LIGHT_PERIOD.
+      *
+      * @param period the requested time between samples, in milliseconds.
+      */
+    void setPeriod(int period);
+
+    /**
+      * Reads the currently configured sample rate of the sensor.
+      *
+      * @return The time between samples, in milliseconds.
+      */
+    int getPeriod();
+
+    /**
+      * Gets the current light level, filtered.
+      *
+      * @return the light level, from 0 (dark) to 255 (bright).
+      */
+    int32_t getLightLevel();
+
+    /**
+      * Updates the light sample of this instance of MicroBitAmbientLightSensor
+      * only if isSampleNeeded() indicates that an update is required.
+      *
+      * This call also will add the sensor to fiber components to receive
+      * periodic callbacks.
+      *
+      * @return MICROBIT_OK on success.
+      */
+    int updateSample();
+
+    /**
+      * Periodic callback from MicroBit idle thread.
+      */
+    virtual void idleTick();
+
+#ifdef MICROBIT_SIM
+    /**
+      * Returns the system time, in ms, of the next sample.
+      */
+    virtual uint64_t getWakeupTime();
+#endif
+
+    private:
+
+    /**
+      * Read the light through the LEDs.
+      *
+      * @return the light level, from 0 (dark) to 255 (bright).
+      */
+    int acquire();
+
+    /**
+      * Determines if we're due to take another light reading
+      *
+      * @return 1 if we're due to take a light reading, 0 otherwise.
+      */
+    int isSampleNeeded();
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "MicroBitConfig.h"
+#include "MicroBitMoistureCalibration.h"
+
+typedef MicroBitCurveTable<MicroBitLinearCurve> MicroBitLinearTable;
+typedef MicroBitCurveTable<MicroBitResistiveCurve> MicroBitResistiveTable;
+
+// Both curves run from 0% at the dry point to MICROBIT_MOISTURE_VWC_WET at the wet point
+static_assert(MicroBitLinearTable::values[0] == 0 && MicroBitLinearTable::values[MICROBIT_MOISTURE_CURVE_SEGMENTS] == MICROBIT_MOISTURE_VWC_WET << MICROBIT_MOISTURE_VWC_SHIFT,
+              "Linear moisture curve does not span the calibration points");
+static_assert(MicroBitResistiveTable::values[0] == 0 && MicroBitResistiveTable::values[MICROBIT_MOISTURE_CURVE_SEGMENTS] == MICROBIT_MOISTURE_VWC_WET << MICROBIT_MOISTURE_VWC_SHIFT,
+              "Resistive moisture curve does not span the calibration points");
+
+// Positions along the curve must not overflow for the narrowest span
+static_assert((uint64_t)1023 * ((MICROBIT_MOISTURE_CURVE_SEGMENTS << MICROBIT_MOISTURE_CURVE_SHIFT) / MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN) <= 0xFFFFFFFF,
+              "MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN too small for the curve resolution");
+
+// Indexed by MICROBIT_MOISTURE_CURVE_*
+static const uint16_t * const curves[MICROBIT_MOISTURE_CURVE_COUNT] = {
+    MicroBitLinearTable::values,
+    MicroBitResistiveTable::values
+};
+
+/**
+  * Constructor.
+  * Create a calibration with the default points and the linear curve.
+  */
+MicroBitMoistureCalibration::MicroBitMoistureCalibration()
+{
+    set(MICROBIT_MOISTURE_DRY_RAW, MICROBIT_MOISTURE_WET_RAW, MICROBIT_MOISTURE_CURVE_LINEAR);
+}
+
+/**
+  * Set the calibration points and the curve.
+  *
+  * @param dry the raw reading of the probe in dry soil.
+  * @param wet the raw reading of the probe in saturated soil, at least
+  *        MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN above dry.
+  * @param curve one of MICROBIT_MOISTURE_CURVE_LINEAR or MICROBIT_MOISTURE_CURVE_RESISTIVE.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the points or the curve are not valid.
+  */
+int MicroBitMoistureCalibration::set(int dry, int wet, int curve)
+{
+    if (dry < 0 || wet > 1023 || wet - dry < MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN || curve < 0 || curve >= MICROBIT_MOISTURE_CURVE_COUNT)
+        return MICROBIT_INVALID_PARAMETER;
+
+    this->dry = dry;
+    this->wet = wet;
+    this->curve = curve;
+    this->table = curves[curve];
+
+    // Segments per raw step: readings are then placed on the curve with a multiplication
+    this->scale = ((uint32_t)MICROBIT_MOISTURE_CURVE_SEGMENTS << MICROBIT_MOISTURE_CURVE_SHIFT) / (wet - dry);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Reads the raw reading of the dry point.
+  */
+int MicroBitMoistureCalibration::getDry()
+{
+    return dry;
+}
+
+/**
+  * Reads the raw reading of the wet point.
+  */
+int MicroBitMoistureCalibration::getWet()
+{
+    return wet;
+}
+
+/**
+  * Reads the curve, a MICROBIT_MOISTURE_CURVE_* value.
+  */
+int MicroBitMoistureCalibration::getCurve()
+{
+    return curve;
+}
+
+/**
+  * Convert a raw reading.
+  *
+  * @param raw the raw ADC reading, in the range 0 - 1023.
+  *
+  * @return the volumetric water content, in the range 0 - MICROBIT_MOISTURE_VWC_WET %.
+  */
+int32_t MicroBitMoistureCalibration::apply(int32_t raw)
+{
+    if (raw <= dry)
+        return 0;
+
+    uint32_t position = (uint32_t)(raw - dry) * scale;
+    uint32_t segment = position >> MICROBIT_MOISTURE_CURVE_SHIFT;
+
+    if (segment >= MICROBIT_MOISTURE_CURVE_SEGMENTS)
+        return MICROBIT_MOISTURE_VWC_WET;
+
+    // Interpolate within the segment, with 8 bits of the position
+    int32_t fraction = (position >> (MICROBIT_MOISTURE_CURVE_SHIFT - 8)) & 0xFF;
+    int32_t low = table[segment];
+    int32_t vwc = low + (((table[segment + 1] - low) * fraction) >> 8);
+
+    return (vwc + (1 << (MICROBIT_MOISTURE_VWC_SHIFT - 1))) >> MICROBIT_MOISTURE_VWC_SHIFT;
+}
@@ -0,0 +1,156 @@
+#ifndef MICROBIT_MOISTURE_CALIBRATION_H
+#define MICROBIT_MOISTURE_CALIBRATION_H
+
+#include "MicroBitConfig.h"
+
+// Volumetric water content at the wet calibration point (saturated potting soil), in %.
+// The dry calibration point is 0%.
+#define MICROBIT_MOISTURE_VWC_WET           50
+
+// Default calibration points, in raw ADC steps: the probe reads about 24% of the ADC
+// range in dry soil and the full range in water
+#define MICROBIT_MOISTURE_DRY_RAW           245
+#define MICROBIT_MOISTURE_WET_RAW           1023
+
+// Smallest accepted difference between the dry and wet points, in raw ADC steps
+#define MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN  64
+
+// Number of segments the range between the dry and wet points is split into
+#define MICROBIT_MOISTURE_CURVE_SEGMENTS    32
+
+// Fractional bits of the positions along the curve, and of the curve values
+#define MICROBIT_MOISTURE_CURVE_SHIFT       16
+#define MICROBIT_MOISTURE_VWC_SHIFT         8
+
+// Curves, from the position between the dry and wet points to the water content
+#define MICROBIT_MOISTURE_CURVE_LINEAR      0
+#define MICROBIT_MOISTURE_CURVE_RESISTIVE   1
+#define MICROBIT_MOISTURE_CURVE_COUNT       2
+
+/**
+  * Compile time sequence of the integers 0 to N - 1, used to expand the curve tables.
+  */
+template <int... I>
+struct MicroBitIndexSequence
+{
+};
+
+template <int N, int... I>
+struct MicroBitMakeIndexSequence : MicroBitMakeIndexSequence<N - 1, N - 1, I...>
+{
+};
+
+template <int... I>
+struct MicroBitMakeIndexSequence<0, I...>
+{
+    typedef MicroBitIndexSequence<I...> type;
+};
+
+/**
+  * Water content proportional to the position between the dry and wet points: a plain
+  * two-point calibration.
+  */
+struct MicroBitLinearCurve
+{
+    static constexpr uint16_t at(int i)
+    {
+        return ((MICROBIT_MOISTURE_VWC_WET << MICROBIT_MOISTURE_VWC_SHIFT) * i + MICROBIT_MOISTURE_CURVE_SEGMENTS / 2) / MICROBIT_MOISTURE_CURVE_SEGMENTS;
+    }
+};
+
+/**
+  * Typical resistive probe: the reading climbs quickly as dry soil gets damp and levels off
+  * towards saturation, so the water content grows with the square of the position.
+  */
+struct MicroBitResistiveCurve
+{
+    static constexpr uint16_t at(int i)
+    {
+        return ((MICROBIT_MOISTURE_VWC_WET << MICROBIT_MOISTURE_VWC_SHIFT) * i * i + MICROBIT_MOISTURE_CURVE_SEGMENTS * MICROBIT_MOISTURE_CURVE_SEGMENTS / 2) /
+               (MICROBIT_MOISTURE_CURVE_SEGMENTS * MICROBIT_MOISTURE_CURVE_SEGMENTS);
+    }
+};
+
+/**
+  * Table of a curve, sampled at the bounds of every segment and generated by the compiler.
+  *
+  * @param Curve provides a constexpr at(i), the water content at the bound i, in % with
+  *        MICROBIT_MOISTURE_VWC_SHIFT fractional bits.
+  */
+template <typename Curve, typename Indexes = typename MicroBitMakeIndexSequence<MICROBIT_MOISTURE_CURVE_SEGMENTS + 1>::type>
+struct MicroBitCurveTable;
+
+template <typename Curve, int... I>
+struct MicroBitCurveTable<Curve, MicroBitIndexSequence<I...> >
+{
+    static constexpr uint16_t values[sizeof...(I)] = { Curve::at(I)... };
+};
+
+template <typename Curve, int... I>
+constexpr uint16_t MicroBitCurveTable<Curve, MicroBitIndexSequence<I...> >::values[sizeof...(I)];
+
+/**
+  * Class definition for MicroBitMoistureCalibration.
+  *
+  * Converts the raw probe readings into a volumetric water content, in %, from two
+  * calibration points taken with the probe in dry and in saturated soil, and a curve
+  * between them.
+  *
+  * The curves are tables built at compile time. The only division is done when the
+  * points are set: a reading is converted with a multiplication, a table lookup and a
+  * linear interpolation between the bounds of its segment.
+  */
+class MicroBitMoistureCalibration
+{
+    const uint16_t  *table;
+    uint32_t        scale;
+    uint16_t        dry;
+    uint16_t        wet;
+    uint8_t         curve;
+
+    public:
+
+    /**
+      * Constructor.
+      * Create a calibration with the default points and the linear curve.
+      */
+    MicroBitMoistureCalibration();
+
+    /**
+      * Set the calibration points and the curve.
+      *
+      * @param dry the raw reading of the probe in dry soil.
+      * @param wet the raw reading of the probe in saturated soil, at least
+      *        MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN above dry.
+      * @param curve one of MICROBIT_MOISTURE_CURVE_LINEAR or MICROBIT_MOISTURE_CURVE_RESISTIVE.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the points or the curve are not valid.
+      */
+    int set(int dry, int wet, int curve);
+
+    /**
+      * Reads the raw reading of the dry point.
+      */
+    int getDry();
+
+    /**
+      * Reads the raw reading of the wet point.
+      */
+    int getWet();
+
+    /**
+      * Reads the curve, a MICROBIT_MOISTURE_CURVE_* value.
+      */
+    int getCurve();
+
+    /**
+      * Convert a raw reading.
+      *
+      * @param raw the raw ADC reading, in the range 0 - 1023.
+      *
+      * @return the volumetric water content, in the range 0 - MICROBIT_MOISTURE_VWC_WET %.
+      */
+    int32_t apply(int32_t raw);
+};
+
+#endif
@@ -23,10 +23,27 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 
+#include "mbed.h"
 #include "MicroBitConfig.h"
 #include "MicroBitMoistureSensor.h"
 #include "MicroBitSystemTimer.h"
 #include "MicroBitFiber.h"
+#include "MicroBitEvent.h"
+
+#include "../../utils/profiling/MicroBitProfiler.h"
+
+// The mean of a burst is exact when every sum, up to n * 1023, times the rounding error of
+// the reciprocal of n, under 1, stays below 2^SHIFT / n
+static_assert(MICROBIT_MOISTURE_BURST_MAX * MICROBIT_MOISTURE_BURST_MAX * 1023 < (1 << MICROBIT_MOISTURE_MEAN_SHIFT),
+              "MICROBIT_MOISTURE_MEAN_SHIFT too small for an exact burst mean");
+
+/**
+  * Reciprocal of n, rounded up, with MICROBIT_MOISTURE_MEAN_SHIFT fractional bits.
+  */
+static uint32_t reciprocal(int n)
+{
+    return ((1 << MICROBIT_MOISTURE_MEAN_SHIFT) + n - 1) / n;
+}
 
 /**
   * Constructor.
@@ -39,18 +56,112 @@ DEALINGS IN THE SOFTWARE.
   * @endcode
   */
 MicroBitMoistureSensor::MicroBitMoistureSensor(MicroBitPin &_readPin, MicroBitPin &_writePin, uint16_t id) : 
-readPin(&_readPin), writePin(&_writePin)
+readPin(&_readPin), writePin(&_writePin),
+adaptivePeriod(MICROBIT_MOISTURE_PERIOD, MICROBIT_MOISTURE_MAX_PERIOD, MICROBIT_MOISTURE_ADAPTIVE_THRESHOLD)
 {
     this->id = id;
     this->samplePeriod = MICROBIT_MOISTURE_PERIOD;
     this->sampleTime = 0;
     this->moisture = 0;
+    this->raw = 0;
+    // Safe until calibrateExcitation() measures the actual settling time
+    this->settleTime = MICROBIT_MOISTURE_SETTLE_MAX;
+    this->burstSize = 1;
+    this->reduction = MOISTURE_REDUCTION_MEAN;
+    this->meanScale = reciprocal(1);
+    this->slotFrame = 0;
+    this->slotOffset = 0;
+    this->compensation = 0;
+    this->temperature = MICROBIT_MOISTURE_REFERENCE_TEMPERATURE;
+}
+
+/**
+  * Set how the raw readings of the probe are converted into a water content.
+  * The readings filtered so far are discarded.
+  *
+  * @param dry the raw reading of the probe in dry soil.
+  * @param wet the raw reading of the probe in saturated soil.
+  * @param curve one of MICROBIT_MOISTURE_CURVE_LINEAR or MICROBIT_MOISTURE_CURVE_RESISTIVE.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the calibration is not valid.
+  */
+int MicroBitMoistureSensor::setCalibration(int dry, int wet, int curve)
+{
+    int result = calibration.set(dry, wet, curve);
+
+    if (result == MICROBIT_OK)
+        filter.reset();
+
+    return result;
+}
+
+/**
+  * Reads the calibration of the probe.
+  */
+MicroBitMoistureCalibration &MicroBitMoistureSensor::getCalibration()
+{
+    return calibration;
+}
+
+/**
+  * Correct the readings for the soil temperature: the conductivity of the soil, and so
+  * the reading, rises with the temperature. A reading r taken at temperature t is
+  * brought back to MICROBIT_MOISTURE_REFERENCE_TEMPERATURE as
+  * r - r * coefficient * (t - reference) / 2^MICROBIT_MOISTURE_COMPENSATION_SHIFT.
+  *
+  * The temperature is the one last given to setTemperature(): the sensor never reads
+  * the thermometer itself. Readings are not corrected until a temperature is known.
+  *
+  * @param coefficient the change of the reading per degree, in 1/1024 of the reading
+  *        (about 0.1%), up to MICROBIT_MOISTURE_COMPENSATION_MAX. 0 disables the correction.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if coefficient is out of range.
+  */
+int MicroBitMoistureSensor::setTemperatureCompensation(int coefficient)
+{
+    if (coefficient < -MICROBIT_MOISTURE_COMPENSATION_MAX || coefficient > MICROBIT_MOISTURE_COMPENSATION_MAX)
+        return MICROBIT_INVALID_PARAMETER;
+
+    compensation = coefficient;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Reads the coefficient of the temperature compensation.
+  */
+int MicroBitMoistureSensor::getTemperatureCompensation()
+{
+    return compensation;
+}
+
+/**
+  * Set the soil temperature used by the temperature compensation, e.g. on every
+  * thermometer update.
+  *
+  * @param celsius the temperature, in degrees Celsius.
+  */
+void MicroBitMoistureSensor::setTemperature(int celsius)
+{
+    temperature = celsius < -128 ? -128 : celsius > 127 ? 127 : celsius;
+    status |= MICROBIT_MOISTURE_TEMPERATURE_KNOWN;
+}
+
+/**
+  * Gets the ADC value of the last reading, temperature compensated but before
+  * calibration and filtering, e.g. to calibrate the probe.
+  *
+  * @return the last raw reading, in the range 0 - 1023.
+  */
+int MicroBitMoistureSensor::getRawLevel()
+{
+    return raw;
 }
 
 /**
   * Gets the current moisture level read by the microbit.
   *
-  * @return the current moisture.
+  * @return the current volumetric water content, in %.
   *
   * @code
   * moistureSensor.getMoistureLevel();
@@ -73,34 +184,125 @@ int32_t MicroBitMoistureSensor::getMoistureLevel()
   */
 int MicroBitMoistureSensor::updateSample()
 {
-    if(!(status & MICROBIT_MOISTURE_ADDED_TO_IDLE))
+    if(!(status & (MICROBIT_MOISTURE_ADDED_TO_IDLE | MICROBIT_MOISTURE_EXTERNAL_IDLE)))
     {
         // If we're running under a fiber scheduer, register ourselves for a periodic callback to keep our data up to date.
         // Otherwise, we do just do this on demand, when polled through our read() interface.
-        fiber_add_idle_component(this);
-        status |= MICROBIT_MOISTURE_ADDED_TO_IDLE;
+        if (fiber_add_idle_component(this) == MICROBIT_OK)
+            status |= MICROBIT_MOISTURE_ADDED_TO_IDLE;
     }
 
     // check if we need to update our sample...
     if(isSampleNeeded())
     {
+        PROFILER_BEGIN(PROFILER_STAGE_SAMPLE);
+
         // Read moisture value
-        writePin->setAnalogValue(1023);
-        moisture = readPin->getAnalogValue();
-        writePin->setAnalogValue(0);
+        PROFILER_BEGIN(PROFILER_STAGE_ACQUIRE);
+        int reading = acquire();
+        PROFILER_END(PROFILER_STAGE_ACQUIRE);
 
-        moisture = (moisture * 100) / 1023;
+        // Bring the reading back to the reference temperature, then convert it
+        raw = compensate(reading);
+        moisture = filter.apply(calibration.apply(raw));
+
+        // Back off while the moisture is stable.
+        if (status & MICROBIT_MOISTURE_ADAPTIVE)
+            samplePeriod = adaptivePeriod.update(moisture);
 
         // Schedule our next sample.
-        sampleTime = system_timer_current_time() + samplePeriod;
+        sampleTime = align(system_timer_current_time() + samplePeriod);
 
         // Send an event to indicate that we'e updated our moisture.
+        PROFILER_BEGIN(PROFILER_STAGE_DISPATCH);
         MicroBitEvent e(id, MICROBIT_MOISTURE_EVT_UPDATE);
+
+        PROFILER_END(PROFILER_STAGE_SAMPLE);
     }
 
     return MICROBIT_OK;
 };
 
+/**
+  * Energise the probe once, wait for it to settle, take a burst of ADC conversions,
+  * switch it off and reduce the conversions.
+  *
+  * The probe is powered with a digital high rather than a full duty PWM, so it draws
+  * current only for the settling time and the conversions. Sum, minimum and maximum
+  * are tracked while converting, and conversions are kept sorted for the median, so
+  * the burst is reduced in the same pass that captures it.
+  *
+  * @return the reduced raw ADC value, in the range 0 - 1023.
+  */
+int MicroBitMoistureSensor::acquire()
+{
+    int32_t sum = 0;
+    int min = 1023;
+    int max = 0;
+
+    writePin->setDigitalValue(1);
+
+    if (settleTime)
+        wait_us(settleTime);
+
+    for (int i = 0; i < burstSize; i++)
+    {
+        int value = readPin->getAnalogValue();
+
+        sum += value;
+
+        if (value < min)
+            min = value;
+
+        if (value > max)
+            max = value;
+
+        if (reduction == MOISTURE_REDUCTION_MEDIAN)
+        {
+            int j = i;
+
+            for (; j > 0 && burst[j - 1] > value; j--)
+                burst[j] = burst[j - 1];
+
+            burst[j] = value;
+        }
+    }
+
+    writePin->setDigitalValue(0);
+
+    if (reduction == MOISTURE_REDUCTION_MEDIAN)
+        return burst[burstSize / 2];
+
+    // No division here: meanScale is the reciprocal of the number of conversions averaged
+    if (reduction == MOISTURE_REDUCTION_TRIMMED_MEAN && burstSize > 2)
+        sum -= min + max;
+
+    return ((uint32_t)sum * meanScale) >> MICROBIT_MOISTURE_MEAN_SHIFT;
+}
+
+/**
+  * Apply the temperature compensation to a reading.
+  *
+  * @param raw the raw ADC value, in the range 0 - 1023.
+  *
+  * @return the reading at MICROBIT_MOISTURE_REFERENCE_TEMPERATURE, in the range 0 - 1023.
+  */
+int MicroBitMoistureSensor::compensate(int raw)
+{
+    if (compensation == 0 || !(status & MICROBIT_MOISTURE_TEMPERATURE_KNOWN))
+        return raw;
+
+    int32_t corrected = raw - ((raw * compensation * (temperature - MICROBIT_MOISTURE_REFERENCE_TEMPERATURE)) >> MICROBIT_MOISTURE_COMPENSATION_SHIFT);
+
+    if (corrected < 0)
+        return 0;
+
+    if (corrected > 1023)
+        return 1023;
+
+    return corrected;
+}
+
 /**
   * Periodic callback from MicroBit idle thread.
   */
@@ -109,6 +311,29 @@ void MicroBitMoistureSensor::idleTick()
     updateSample();
 }
 
+#ifdef MICROBIT_SIM
+/**
+  * Returns the system time, in ms, of the next sample.
+  */
+uint64_t MicroBitMoistureSensor::getWakeupTime()
+{
+    return sampleTime;
+}
+#endif
+
+/**
+  * Leave the idle thread: the owner of the sensor calls idleTick() instead, e.g. so that
+  * several sensors take a single idle component.
+  */
+void MicroBitMoistureSensor::setExternalIdle()
+{
+    if (status & MICROBIT_MOISTURE_ADDED_TO_IDLE)
+        fiber_remove_idle_component(this);
+
+    status &= ~MICROBIT_MOISTURE_ADDED_TO_IDLE;
+    status |= MICROBIT_MOISTURE_EXTERNAL_IDLE;
+}
+
 /**
   * Determines if we're due to take another moisture reading
   *
@@ -132,9 +357,68 @@ int MicroBitMoistureSensor::isSampleNeeded()
 void MicroBitMoistureSensor::setPeriod(int period)
 {
     updateSample();
+    status &= ~MICROBIT_MOISTURE_ADAPTIVE;
     samplePeriod = period;
 }
 
+/**
+  * Let the sensor choose its sample period: samples are taken every minPeriod ms while
+  * the moisture changes, and the period doubles up to maxPeriod ms while it is stable.
+  *
+  * A later call to setPeriod() goes back to a fixed period.
+  *
+  * @param minPeriod the period used while the moisture changes, in milliseconds.
+  * @param maxPeriod the longest period used while the moisture is stable, in milliseconds.
+  * @param threshold the change (exclusive) between two readings under which the moisture is stable.
+  */
+void MicroBitMoistureSensor::setAdaptivePeriod(int minPeriod, int maxPeriod, int threshold)
+{
+    updateSample();
+    adaptivePeriod.configure(minPeriod, maxPeriod, threshold);
+    status |= MICROBIT_MOISTURE_ADAPTIVE;
+    samplePeriod = adaptivePeriod.get();
+}
+
+/**
+  * Change the longest period of the adaptive sampling, e.g. when the moisture is known
+  * to stay away from the watering threshold for a while. A shorter period brings the
+  * next sample forward.
+  *
+  * @param maxPeriod the longest period used while the moisture is stable, in milliseconds.
+  */
+void MicroBitMoistureSensor::setMaxPeriod(int maxPeriod)
+{
+    adaptivePeriod.setMaxPeriod(maxPeriod);
+
+    if (!(status & MICROBIT_MOISTURE_ADAPTIVE))
+        return;
+
+    samplePeriod = adaptivePeriod.get();
+
+    unsigned long next = align(system_timer_current_time() + samplePeriod);
+
+    if (sampleTime > next)
+        sampleTime = next;
+}
+
+/**
+  * Sample at the minimum period again, starting from the next sample, e.g. while
+  * watering. Has no effect on a fixed period.
+  */
+void MicroBitMoistureSensor::boost()
+{
+    if (!(status & MICROBIT_MOISTURE_ADAPTIVE))
+        return;
+
+    samplePeriod = adaptivePeriod.boost();
+
+    // Bring the next sample forward if it was scheduled further away.
+    unsigned long next = align(system_timer_current_time() + samplePeriod);
+
+    if (sampleTime > next)
+        sampleTime = next;
+}
+
 /**
   * Reads the currently configured sample rate of the sensor.
   *
@@ -146,12 +430,172 @@ int MicroBitMoistureSensor::getPeriod()
 }
 
 
+/**
+  * Schedule the next sample.
+  *
+  * @param delay the time from now to the next sample, in milliseconds.
+  */
+void MicroBitMoistureSensor::setNextSample(int delay)
+{
+    sampleTime = align(system_timer_current_time() + delay);
+}
+
+/**
+  * Take every sample at the same offset within a repeating frame of time, so that the
+  * probes sharing the board are read at different times. Samples are delayed by less
+  * than a frame to reach their slot.
+  *
+  * @param frame the length of the frame, in milliseconds, or 0 to sample as scheduled.
+  * @param offset the time from the start of the frame to the slot, in milliseconds, below frame.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if offset is not within the frame.
+  */
+int MicroBitMoistureSensor::setSampleSlot(int frame, int offset)
+{
+    if (frame < 0 || frame > 0xFFFF || offset < 0 || (frame > 0 && offset >= frame))
+        return MICROBIT_INVALID_PARAMETER;
+
+    slotFrame = frame;
+    slotOffset = frame > 0 ? offset : 0;
+
+    sampleTime = align(sampleTime);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Move a sample time forward to the sample slot, if any.
+  *
+  * @param time the time the sample is due, in ms of system time.
+  *
+  * @return the first time of the slot at or after time.
+  */
+unsigned long MicroBitMoistureSensor::align(unsigned long time)
+{
+    if (slotFrame == 0)
+        return time;
+
+    unsigned long late = (time + slotFrame - slotOffset) % slotFrame;
+
+    return late == 0 ? time : time + slotFrame - late;
+}
+
+/**
+  * Set how many ADC conversions are taken each time the probe is energised, and how
+  * they are reduced to a single reading.
+  *
+  * The default is a single conversion.
+  *
+  * @param size the number of conversions, between 1 and MICROBIT_MOISTURE_BURST_MAX.
+  * @param mode one of MOISTURE_REDUCTION_MEAN, MOISTURE_REDUCTION_MEDIAN or MOISTURE_REDUCTION_TRIMMED_MEAN.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if size is out of range.
+  */
+int MicroBitMoistureSensor::setBurst(int size, MicroBitMoistureReduction mode)
+{
+    if (size < 1 || size > MICROBIT_MOISTURE_BURST_MAX)
+        return MICROBIT_INVALID_PARAMETER;
+
+    burstSize = size;
+    reduction = mode;
+
+    // The only division of the mean, done once here rather than on every reading
+    meanScale = reciprocal(mode == MOISTURE_REDUCTION_TRIMMED_MEAN && size > 2 ? size - 2 : size);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Reads the number of ADC conversions taken for each reading.
+  */
+int MicroBitMoistureSensor::getBurstSize()
+{
+    return burstSize;
+}
+
+/**
+  * Measure how long the probe takes to settle once energised, and use it as the
+  * settling time of every following reading.
+  *
+  * The probe is energised and read every MICROBIT_MOISTURE_SETTLE_STEP us until
+  * MICROBIT_MOISTURE_SETTLE_COUNT consecutive readings stay within
+  * MICROBIT_MOISTURE_SETTLE_TOLERANCE, for at most MICROBIT_MOISTURE_SETTLE_MAX us.
+  * Until calibrated, the probe is energised for MICROBIT_MOISTURE_SETTLE_MAX us.
+  *
+  * @return the measured settling time, in microseconds.
+  */
+int MicroBitMoistureSensor::calibrateExcitation()
+{
+    int previous = -1;
+    int stable = 0;
+    uint64_t settled = 0;
+
+    writePin->setDigitalValue(1);
+
+    uint64_t start = system_timer_current_time_us();
+    uint64_t now = start;
+
+    while (stable < MICROBIT_MOISTURE_SETTLE_COUNT && now - start < MICROBIT_MOISTURE_SETTLE_MAX)
+    {
+        int value = readPin->getAnalogValue();
+        now = system_timer_current_time_us();
+
+        if (previous >= 0 && value - previous <= MICROBIT_MOISTURE_SETTLE_TOLERANCE && previous - value <= MICROBIT_MOISTURE_SETTLE_TOLERANCE)
+        {
+            // The probe settled when the first of the stable readings was taken.
+            if (stable == 0)
+                settled = now;
+
+            stable++;
+        }
+        else
+        {
+            stable = 0;
+        }
+
+        previous = value;
+        wait_us(MICROBIT_MOISTURE_SETTLE_STEP);
+    }
+
+    writePin->setDigitalValue(0);
+
+    settleTime = stable >= MICROBIT_MOISTURE_SETTLE_COUNT ? settled - start : MICROBIT_MOISTURE_SETTLE_MAX;
+
+    return settleTime;
+}
+
+/**
+  * Set the time the probe is energised before the ADC conversions.
+  *
+  * @param us the settling time, in microseconds, up to MICROBIT_MOISTURE_SETTLE_MAX.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if us is out of range.
+  */
+int MicroBitMoistureSensor::setSettleTime(int us)
+{
+    if (us < 0 || us > MICROBIT_MOISTURE_SETTLE_MAX)
+        return MICROBIT_INVALID_PARAMETER;
+
+    settleTime = us;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Reads the time the probe is energised before the ADC conversions, in microseconds.
+  */
+int MicroBitMoistureSensor::getSettleTime()
+{
+    return settleTime;
+}
+
 /**
  * Set the pin used by the sensor.
  */
 void MicroBitMoistureSensor::setWritePin(MicroBitPin &pin)
 {
     this->writePin = &pin;
+    filter.reset();
     updateSample();
 }
 
@@ -161,5 +605,6 @@ void MicroBitMoistureSensor::setWritePin(MicroBitPin &pin)
 void MicroBitMoistureSensor::setReadPin(MicroBitPin &pin)
 {
     this->readPin = &pin;
+    filter.reset();
     updateSample();
 }
@@ -26,16 +26,42 @@ DEALINGS IN THE SOFTWARE.
 #ifndef MICROBIT_MOISTURE_SENSOR_H
 #define MICROBIT_MOISTURE_SENSOR_H
 
-#include "mbed.h"
 #include "MicroBitConfig.h"
 #include "MicroBitComponent.h"
-#include "MicroBitStorage.h"
 #include "MicroBitPin.h"
 
+#include "MicroBitMoistureCalibration.h"
+#include "../../utils/filters/MicroBitFilters.h"
+#include "../../utils/scheduling/MicroBitAdaptivePeriod.h"
+
 #define MICROBIT_ID_MOISTURE                1234
 
 #define MICROBIT_MOISTURE_PERIOD             1000
 
+// Settling time calibration of the probe excitation, in microseconds
+#define MICROBIT_MOISTURE_SETTLE_STEP        50
+#define MICROBIT_MOISTURE_SETTLE_MAX         2000
+// Readings within this many ADC steps of each other are considered settled
+#define MICROBIT_MOISTURE_SETTLE_TOLERANCE   2
+// Consecutive settled readings needed to end the calibration
+#define MICROBIT_MOISTURE_SETTLE_COUNT       3
+
+// Defaults of the adaptive sample period
+#define MICROBIT_MOISTURE_MAX_PERIOD         60000
+#define MICROBIT_MOISTURE_ADAPTIVE_THRESHOLD 1
+
+// Maximum number of ADC conversions taken while the probe is energised.
+#define MICROBIT_MOISTURE_BURST_MAX          16
+
+// Fractional bits of the reciprocal the burst mean is taken with
+#define MICROBIT_MOISTURE_MEAN_SHIFT         18
+
+// Temperature compensation: soil temperature the readings are brought back to, in degrees
+// Celsius, fractional bits of the coefficient and largest coefficient accepted
+#define MICROBIT_MOISTURE_REFERENCE_TEMPERATURE  20
+#define MICROBIT_MOISTURE_COMPENSATION_SHIFT     10
+#define MICROBIT_MOISTURE_COMPENSATION_MAX       100
+
 
 /*
  * Temperature events
@@ -43,6 +69,31 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_MOISTURE_EVT_UPDATE         1
 
 #define MICROBIT_MOISTURE_ADDED_TO_IDLE      2
+#define MICROBIT_MOISTURE_ADAPTIVE           4
+#define MICROBIT_MOISTURE_TEMPERATURE_KNOWN  8
+#define MICROBIT_MOISTURE_EXTERNAL_IDLE      16
+
+/**
+  * How the ADC conversions of a burst are reduced to a single reading.
+  */
+enum MicroBitMoistureReduction
+{
+    MOISTURE_REDUCTION_MEAN = 0,
+    MOISTURE_REDUCTION_MEDIAN,
+    // Mean of the burst without its lowest and highest conversion.
+    MOISTURE_REDUCTION_TRIMMED_MEAN
+};
+
+/**
+  * Filter applied to each moisture reading: a median of 3 drops isolated spikes, an EMA
+  * smooths the remaining noise and a 1 point deadband stops the value flickering
+  * around the watering threshold.
+  */
+typedef MicroBitFilterChain<MicroBitMedianFilter<3>,
+        MicroBitFilterChain<MicroBitEmaFilter<2>, MicroBitDeadbandFilter<1> > > MicroBitMoistureFilter;
+
+// Readings the filter output lags behind a steadily drying soil: 1 for the median, 3 for the EMA
+#define MICROBIT_MOISTURE_FILTER_LAG         4
 
 /**
   * Class definition for MicroBit Moisture Sensor.
@@ -55,8 +106,21 @@ class MicroBitMoistureSensor : public MicroBitComponent
     unsigned long           sampleTime;
     uint32_t                samplePeriod;
     int32_t                 moisture;
+    uint16_t                raw;
     MicroBitPin*            readPin;
     MicroBitPin*            writePin;
+    uint16_t                settleTime;
+    uint8_t                 burstSize;
+    uint8_t                 reduction;
+    uint32_t                meanScale;
+    uint16_t                slotFrame;
+    uint16_t                slotOffset;
+    int8_t                  compensation;
+    int8_t                  temperature;
+    uint16_t                burst[MICROBIT_MOISTURE_BURST_MAX];
+    MicroBitMoistureFilter  filter;
+    MicroBitMoistureCalibration calibration;
+    MicroBitAdaptivePeriod  adaptivePeriod;
 
     public:
 
@@ -84,6 +148,52 @@ class MicroBitMoistureSensor : public MicroBitComponent
       */
     void setPeriod(int period);
 
+    /**
+      * Let the sensor choose its sample period: samples are taken every minPeriod ms while
+      * the moisture changes, and the period doubles up to maxPeriod ms while it is stable.
+      *
+      * A later call to setPeriod() goes back to a fixed period.
+      *
+      * @param minPeriod the period used while the moisture changes, in milliseconds.
+      * @param maxPeriod the longest period used while the moisture is stable, in milliseconds.
+      * @param threshold the change (exclusive) between two readings under which the moisture is stable.
+      */
+    void setAdaptivePeriod(int minPeriod, int maxPeriod, int threshold = MICROBIT_MOISTURE_ADAPTIVE_THRESHOLD);
+
+    /**
+      * Change the longest period of the adaptive sampling, e.g. when the moisture is known
+      * to stay away from the watering threshold for a while. A shorter period brings the
+      * next sample forward.
+      *
+      * @param maxPeriod the longest period used while the moisture is stable, in milliseconds.
+      */
+    void setMaxPeriod(int maxPeriod);
+
+    /**
+      * Sample at the minimum period again, starting from the next sample, e.g. while
+      * watering. Has no effect on a fixed period.
+      */
+    void boost();
+
+    /**
+      * Schedule the next sample.
+      *
+      * @param delay the time from now to the next sample, in milliseconds.
+      */
+    void setNextSample(int delay);
+
+    /**
+      * Take every sample at the same offset within a repeating frame of time, so that the
+      * probes sharing the board are read at different times. Samples are delayed by less
+      * than a frame to reach their slot.
+      *
+      * @param frame the length of the frame, in milliseconds, or 0 to sample as scheduled.
+      * @param offset the time from the start of the frame to the slot, in milliseconds, below frame.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if offset is not within the frame.
+      */
+    int setSampleSlot(int frame, int offset);
+
     /**
       * Reads the currently configured sample rate of the sensor.
       *
@@ -91,10 +201,110 @@ class MicroBitMoistureSensor : public MicroBitComponent
       */
     int getPeriod();
 
+    /**
+      * Set how many ADC conversions are taken each time the probe is energised, and how
+      * they are reduced to a single reading.
+      *
+      * The default is a single conversion.
+      *
+      * @param size the number of conversions, between 1 and MICROBIT_MOISTURE_BURST_MAX.
+      * @param mode one of MOISTURE_REDUCTION_MEAN, MOISTURE_REDUCTION_MEDIAN or MOISTURE_REDUCTION_TRIMMED_MEAN.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if size is out of range.
+      */
+    int setBurst(int size, MicroBitMoistureReduction mode = MOISTURE_REDUCTION_MEAN);
+
+    /**
+      * Reads the number of ADC conversions taken for each reading.
+      */
+    int getBurstSize();
+
+    /**
+      * Measure how long the probe takes to settle once energised, and use it as the
+      * settling time of every following reading.
+      *
+      * The probe is energised and read every MICROBIT_MOISTURE_SETTLE_STEP us until
+      * MICROBIT_MOISTURE_SETTLE_COUNT consecutive readings stay within
+      * MICROBIT_MOISTURE_SETTLE_TOLERANCE, for at most MICROBIT_MOISTURE_SETTLE_MAX us.
+      *
+      * Until calibrated, the probe is energised for MICROBIT_MOISTURE_SETTLE_MAX us.
+      *
+      * @return the measured settling time, in microseconds.
+      */
+    int calibrateExcitation();
+
+    /**
+      * Set the time the probe is energised before the ADC conversions.
+      *
+      * @param us the settling time, in microseconds, up to MICROBIT_MOISTURE_SETTLE_MAX.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if us is out of range.
+      */
+    int setSettleTime(int us);
+
+    /**
+      * Reads the time the probe is energised before the ADC conversions, in microseconds.
+      */
+    int getSettleTime();
+
+    /**
+      * Set how the raw readings of the probe are converted into a water content.
+      * The readings filtered so far are discarded.
+      *
+      * @param dry the raw reading of the probe in dry soil.
+      * @param wet the raw reading of the probe in saturated soil.
+      * @param curve one of MICROBIT_MOISTURE_CURVE_LINEAR or MICROBIT_MOISTURE_CURVE_RESISTIVE.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the calibration is not valid.
+      */
+    int setCalibration(int dry, int wet, int curve = MICROBIT_MOISTURE_CURVE_LINEAR);
+
+    /**
+      * Reads the calibration of the probe.
+      */
+    MicroBitMoistureCalibration &getCalibration();
+
+    /**
+      * Correct the readings for the soil temperature: the conductivity of the soil, and so
+      * the reading, rises with the temperature. A reading r taken at temperature t is
+      * brought back to MICROBIT_MOISTURE_REFERENCE_TEMPERATURE as
+      * r - r * coefficient * (t - reference) / 2^MICROBIT_MOISTURE_COMPENSATION_SHIFT.
+      *
+      * The temperature is the one last given to setTemperature(): the sensor never reads
+      * the thermometer itself. Readings are not corrected until a temperature is known.
+      *
+      * @param coefficient the change of the reading per degree, in 1/1024 of the reading
+      *        (about 0.1%), up to MICROBIT_MOISTURE_COMPENSATION_MAX. 0 disables the correction.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if coefficient is out of range.
+      */
+    int setTemperatureCompensation(int coefficient);
+
+    /**
+      * Reads the coefficient of the temperature compensation.
+      */
+    int getTemperatureCompensation();
+
+    /**
+      * Set the soil temperature used by the temperature compensation, e.g. on every
+      * thermometer update.
+      *
+      * @param celsius the temperature, in degrees Celsius.
+      */
+    void setTemperature(int celsius);
+
+    /**
+      * Gets the ADC value of the last reading, temperature compensated but before
+      * calibration and filtering, e.g. to calibrate the probe.
+      *
+      * @return the last raw reading, in the range 0 - 1023.
+      */
+    int getRawLevel();
+
     /**
       * Gets the current moisture level read by the microbit.
       *
-      * @return the current moisture.
+      * @return the current volumetric water content, in %.
       *
       * @code
       * moistureSensor.getMoistureLevel();
@@ -118,6 +328,19 @@ class MicroBitMoistureSensor : public MicroBitComponent
       */
     virtual void idleTick();
 
+#ifdef MICROBIT_SIM
+    /**
+      * Returns the system time, in ms, of the next sample.
+      */
+    virtual uint64_t getWakeupTime();
+#endif
+
+    /**
+      * Leave the idle thread: the owner of the sensor calls idleTick() instead, e.g. so that
+      * several sensors take a single idle component.
+      */
+    void setExternalIdle();
+
     /**
      * Set the pin used by the sensor.
      */
@@ -130,6 +353,32 @@ class MicroBitMoistureSensor : public MicroBitComponent
 
     private:
 
+    /**
+      * Move a sample time forward to the sample slot, if any.
+      *
+      * @param time the time the sample is due, in ms of system time.
+      *
+      * @return the first time of the slot at or after time.
+      */
+    unsigned long align(unsigned long time);
+
+    /**
+      * Energise the probe once, wait for it to settle, take a burst of ADC conversions,
+      * switch it off and reduce the conversions.
+      *
+      * @return the reduced raw ADC value, in the range 0 - 1023.
+      */
+    int acquire();
+
+    /**
+      * Apply the temperature compensation to a reading.
+      *
+      * @param raw the raw ADC value, in the range 0 - 1023.
+      *
+      * @return the reading at MICROBIT_MOISTURE_REFERENCE_TEMPERATURE, in the range 0 - 1023.
+      */
+    int compensate(int raw);
+
     /**
       * Determines if we're due to take another moisture reading
       *
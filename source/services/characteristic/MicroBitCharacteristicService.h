@@ -0,0 +1,262 @@
+#ifndef MICROBIT_CHARACTERISTIC_SERVICE_H
+#define MICROBIT_CHARACTERISTIC_SERVICE_H
+
+#include "MicroBitConfig.h"
+#include "ble/BLE.h"
+
+#include "../../utils/notify/MicroBitNotifyFlusher.h"
+#include "../../utils/notify/MicroBitNotifyPolicy.h"
+#include "../../utils/services/MicroBitWriteDispatcher.h"
+
+/**
+  * Little endian encoding of an integer value.
+  *
+  * Writes shorter than the value are accepted and zero extended, so that a peer can
+  * write a small value in a single byte.
+  */
+template <typename T>
+struct MicroBitLittleEndian
+{
+    static const int size = sizeof(T);
+
+    static void encode(const T &value, uint8_t *buffer)
+    {
+        for (int i = 0; i < size; i++)
+            buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+
+    static int decode(const uint8_t *data, int len, T &value)
+    {
+        if (len < 1 || len > size)
+            return MICROBIT_INVALID_PARAMETER;
+
+        value = 0;
+
+        for (int i = 0; i < len; i++)
+            value |= (T)data[i] << (8 * i);
+
+        return MICROBIT_OK;
+    }
+};
+
+/**
+  * Notify policy that lets every value through, for state changes that are rare and
+  * must all be seen by the peer.
+  */
+struct MicroBitNotifyAlways
+{
+    template <typename T>
+    bool offer(const T &)
+    {
+        return true;
+    }
+
+    int32_t pendingDelay()
+    {
+        return -1;
+    }
+
+    bool flush()
+    {
+        return false;
+    }
+
+    void reset()
+    {
+    }
+};
+
+/**
+  * Class definition for a MicroBitCharacteristicService.
+  *
+  * A BLE service holding a single characteristic of type T, that does the plumbing shared
+  * by the SmartVase services: the characteristic buffer and handle, the initial value, the
+  * policy that decides which values are notified, and the decoding of the writes.
+  *
+  * @param T the value type.
+  * @param Encoding how a value is laid out in the characteristic, see MicroBitLittleEndian.
+  *        Provides size, encode(const T &, uint8_t *) and decode(const uint8_t *, int, T &).
+  * @param Policy decides which updates are notified, see MicroBitNotifyPolicy and
+  *        MicroBitNotifyAlways. Provides offer(T), pendingDelay(), flush() and reset().
+  *
+  * Services derive from it, feed it with update(), override onWrite() if the
+  * characteristic is writable, and onNotify() if they count the notifications.
+  */
+template <typename T, typename Encoding = MicroBitLittleEndian<T>, typename Policy = MicroBitNotifyPolicy>
+class MicroBitCharacteristicService : public MicroBitWriteHandler, public MicroBitDeferredNotifier
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create the service and its characteristic, and add them to the GATT server.
+      *
+      * @param _ble The instance of a BLE device that we're running on.
+      * @param serviceUUID the UUID of the service.
+      * @param characteristicUUID the UUID of the characteristic.
+      * @param properties the GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_* of the characteristic.
+      * @param initial the initial value of the characteristic.
+      * @param policy the policy deciding which updates are notified.
+      */
+    MicroBitCharacteristicService(BLEDevice &_ble, const uint8_t *serviceUUID, const uint8_t *characteristicUUID, uint8_t properties, const T &initial, const Policy &policy = Policy()) :
+        ble(_ble), notifyPolicy(policy), flushing(false)
+    {
+        // Create the data structures that represent our characteristic in Soft Device.
+        GattCharacteristic  characteristic(characteristicUUID, buffer, 0, sizeof(buffer), properties);
+
+        // Initialise our characteristic value.
+        Encoding::encode(initial, buffer);
+
+        // Set default security requirements
+        characteristic.requireSecurity(SecurityManager::MICROBIT_BLE_SECURITY_LEVEL);
+
+        GattCharacteristic *characteristics[] = {&characteristic};
+        GattService         service(serviceUUID, characteristics, sizeof(characteristics) / sizeof(GattCharacteristic *));
+
+        ble.addService(service);
+
+        handle = characteristic.getValueHandle();
+
+        ble.gattServer().write(handle, buffer, sizeof(buffer), true);
+
+        // A service that cannot receive its writes must not pass for working
+        if ((properties & (GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE_WITHOUT_RESPONSE)) &&
+            MicroBitWriteDispatcher::add(ble, handle, this) != MICROBIT_OK)
+            microbit_panic(MICROBIT_WRITE_DISPATCHER_PANIC);
+    }
+
+    /**
+      * Offer the current value. It becomes the value read by the peers at once, and it is
+      * notified if a peer is connected and the policy lets it through. A value the policy
+      * holds back is notified at the end of its interval, unless a newer one replaces it.
+      * While no peer is connected the policy is reset, so that the first value is notified
+      * as soon as a peer connects again.
+      *
+      * @param value the current value.
+      *
+      * @return true if the value was notified.
+      */
+    bool update(const T &value)
+    {
+        // Reads get the latest value, whether it is notified or not
+        Encoding::encode(value, buffer);
+        ble.gattServer().write(handle, buffer, sizeof(buffer), true);
+
+        if (!ble.getGapState().connected)
+        {
+            notifyPolicy.reset();
+            return false;
+        }
+
+        if (!notifyPolicy.offer(value))
+        {
+            // The buffer keeps the coalesced value for the flush
+            int32_t delay = notifyPolicy.pendingDelay();
+
+            if (delay >= 0 && !flushing && MicroBitNotifyFlusher::defer(this, delay) == MICROBIT_OK)
+                flushing = true;
+
+            return false;
+        }
+
+        ble.gattServer().notify(handle, buffer, sizeof(buffer));
+        onNotify();
+
+        return true;
+    }
+
+    /**
+      * Set the value read by the peers, without notifying it.
+      *
+      * @param value the new value.
+      */
+    void set(const T &value)
+    {
+        Encoding::encode(value, buffer);
+        ble.gattServer().write(handle, buffer, sizeof(buffer), true);
+    }
+
+    /**
+      * Set when changes are notified. Only available with MicroBitNotifyPolicy.
+      *
+      * @param deadband the change (exclusive) under which a value is not notified.
+      * @param minInterval the minimum time between two notifications, in ms.
+      * @param maxSilence the time after which a value is notified even if unchanged, in ms. 0 disables it.
+      */
+    void setNotifyPolicy(int32_t deadband, uint32_t minInterval, uint32_t maxSilence)
+    {
+        notifyPolicy.configure(deadband, minInterval, maxSilence);
+    }
+
+    /**
+      * Callback. Invoked by MicroBitWriteDispatcher when our characteristic is written via BLE.
+      */
+    virtual void onDataWritten(const GattWriteCallbackParams *params)
+    {
+        T value;
+
+        if (Encoding::decode(params->data, params->len, value) == MICROBIT_OK)
+            onWrite(value);
+    }
+
+    protected:
+
+    /**
+      * Invoked with every valid value written by a peer.
+      *
+      * @param value the decoded value.
+      */
+    virtual void onWrite(const T &)
+    {
+    }
+
+    /**
+      * Invoked after every notification, including those of coalesced values.
+      */
+    virtual void onNotify()
+    {
+    }
+
+    // Bluetooth stack we're running on.
+    BLEDevice               &ble;
+
+    private:
+
+    /**
+      * Callback. Invoked by MicroBitNotifyFlusher: notifies the coalesced value once the
+      * policy lets it through.
+      *
+      * @return the time left before the value can be notified, in ms, or -1 once done.
+      */
+    virtual int32_t flushDeferred()
+    {
+        int32_t delay = notifyPolicy.pendingDelay();
+
+        if (delay > 0)
+            return delay;
+
+        if (delay == 0 && ble.getGapState().connected && notifyPolicy.flush())
+        {
+            ble.gattServer().notify(handle, buffer, sizeof(buffer));
+            onNotify();
+        }
+
+        flushing = false;
+
+        return -1;
+    }
+
+    // Decides which updates are notified
+    Policy                  notifyPolicy;
+
+    // Set while the flusher holds a coalesced value for us
+    bool                    flushing;
+
+    // Memory for our characteristic.
+    uint8_t                 buffer[Encoding::size];
+
+    // Handle to access the characteristic when it is held by Soft Device.
+    GattAttribute::Handle_t handle;
+};
+
+#endif
@@ -0,0 +1,298 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for the custom MicroBit Command Service.
+  * Provides a BLE service to send a batch of commands in a single write.
+  */
+#include "MicroBitConfig.h"
+#include "ble/UUID.h"
+#include "MicroBitEvent.h"
+
+#include "MicroBitCommandService.h"
+#include "../../actuators/watering/MicroBitWateringActuator.h"
+#include "../../storage/history/MicroBitHistory.h"
+
+/**
+  * Read a little endian 16 bit value.
+  */
+static uint32_t get16(const uint8_t *b)
+{
+    return b[0] | (b[1] << 8);
+}
+
+/**
+  * Read a little endian 32 bit value.
+  */
+static uint32_t get32(const uint8_t *b)
+{
+    return get16(b) | (get16(b + 2) << 16);
+}
+
+/**
+  * Returns true if value is a raw probe reading, or asks to keep the point or to read it.
+  */
+static bool isCalibrationPointValid(uint16_t value)
+{
+    return value <= 1023 || value == MICROBIT_COMMAND_CALIBRATION_KEEP || value == MICROBIT_COMMAND_CALIBRATION_CURRENT;
+}
+
+/**
+  * Constructor.
+  * Create a representation of the CommandService
+  * @param _ble The instance of a BLE device that we're running on.
+  */
+MicroBitCommandService::MicroBitCommandService(BLEDevice &_ble) :
+        ble(_ble)
+{
+    // Create the data structures that represent each of our characteristics in Soft Device.
+    GattCharacteristic  commandDataCharacteristic(MicroBitCommandServiceDataUUID, commandDataCharacteristicBuffer, 0,
+    sizeof(commandDataCharacteristicBuffer), GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+
+    // Initialise our characteristic values.
+    memset(commandDataCharacteristicBuffer, 0, sizeof(commandDataCharacteristicBuffer));
+    memset(&batch, 0, sizeof(batch));
+    pending = false;
+
+    // Set default security requirements
+    commandDataCharacteristic.requireSecurity(SecurityManager::MICROBIT_BLE_SECURITY_LEVEL);
+
+    GattCharacteristic *characteristics[] = {&commandDataCharacteristic};
+    GattService         service(MicroBitCommandServiceUUID, characteristics, sizeof(characteristics) / sizeof(GattCharacteristic *));
+
+    ble.addService(service);
+
+    commandDataCharacteristicHandle = commandDataCharacteristic.getValueHandle();
+
+    if (MicroBitWriteDispatcher::add(ble, commandDataCharacteristicHandle, this) != MICROBIT_OK)
+        microbit_panic(MICROBIT_WRITE_DISPATCHER_PANIC);
+}
+
+/**
+  * The batch waiting to be applied.
+  */
+const MicroBitCommandBatch &MicroBitCommandService::getBatch()
+{
+    return batch;
+}
+
+/**
+  * Tell the peer that the batch has been applied, and accept the next one.
+  *
+  * @param status MICROBIT_COMMAND_STATUS_OK, or the reason the batch could not be applied.
+  */
+void MicroBitCommandService::acknowledge(uint8_t status)
+{
+    if (!pending)
+        return;
+
+    pending = false;
+    notify(batch.sequence, status, 0);
+}
+
+/**
+  * Callback. Invoked by MicroBitWriteDispatcher when our characteristic is written via BLE.
+  */
+void MicroBitCommandService::onDataWritten(const GattWriteCallbackParams *params)
+{
+    uint8_t sequence = params->len > 0 ? params->data[0] : 0;
+
+    // The batch being applied must not change under the application's feet
+    if (pending)
+    {
+        notify(sequence, MICROBIT_COMMAND_STATUS_BUSY, 0);
+        return;
+    }
+
+    int offset = 0;
+    int status = decode(params->data, params->len, offset);
+
+    if (status != MICROBIT_COMMAND_STATUS_OK)
+    {
+        notify(sequence, status, offset);
+        return;
+    }
+
+    pending = true;
+
+    // fire received event
+    MicroBitEvent(MICROBIT_ID_COMMAND_SERVICE, COMMAND_EVT_RECEIVED);
+}
+
+/**
+  * Check a write and decode it into batch.
+  *
+  * @param data the bytes written.
+  * @param len the number of bytes written.
+  * @param offset set to the offset of the faulty command, if any.
+  *
+  * @return MICROBIT_COMMAND_STATUS_OK if the whole batch is valid, or the reason it is not.
+  */
+int MicroBitCommandService::decode(const uint8_t *data, int len, int &offset)
+{
+    const uint16_t watering = MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_START_WATERING) | MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_STOP_WATERING) | MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_ABORT_WATERING) |
+                              MICROBIT_COMMAND_BIT(MICROBIT_COMMAND_EXTEND_WATERING);
+
+    if (len < 1)
+        return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+    batch.sequence = data[0];
+    batch.commands = 0;
+
+    for (offset = 1; offset < len; offset += 2 + data[offset + 1])
+    {
+        if (offset + 2 > len || offset + 2 + data[offset + 1] > len)
+            return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+        uint8_t type = data[offset];
+        uint8_t size = data[offset + 1];
+        const uint8_t *value = data + offset + 2;
+
+        if (type < MICROBIT_COMMAND_SET_TRESHOLD || type > MICROBIT_COMMAND_EXTEND_WATERING)
+            return MICROBIT_COMMAND_STATUS_UNKNOWN;
+
+        uint16_t bit = MICROBIT_COMMAND_BIT(type);
+
+        // Each setting once, and a single watering action
+        if ((batch.commands & bit) || ((bit & watering) && (batch.commands & watering)))
+            return MICROBIT_COMMAND_STATUS_CONFLICT;
+
+        switch (type)
+        {
+            case MICROBIT_COMMAND_SET_TRESHOLD:
+                if (size != 1)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+                batch.treshold = value[0];
+
+                if (batch.treshold < 1 || batch.treshold > MICROBIT_COMMAND_TRESHOLD_MAX)
+                    return MICROBIT_COMMAND_STATUS_INVALID;
+                break;
+
+            case MICROBIT_COMMAND_SET_PULSE:
+                if (size != 2)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+                batch.pulse = get16(value);
+
+                if (batch.pulse == 0 || batch.pulse > MICROBIT_WATERING_MAX_PULSE)
+                    return MICROBIT_COMMAND_STATUS_INVALID;
+                break;
+
+            case MICROBIT_COMMAND_SET_PERIODS:
+                if (size != 8)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+                batch.minPeriod = get32(value);
+                batch.maxPeriod = get32(value + 4);
+
+                if (batch.minPeriod < MICROBIT_COMMAND_PERIOD_MIN || batch.maxPeriod < batch.minPeriod || batch.maxPeriod > 0x7FFFFFFF)
+                    return MICROBIT_COMMAND_STATUS_INVALID;
+                break;
+
+            case MICROBIT_COMMAND_START_WATERING:
+            case MICROBIT_COMMAND_STOP_WATERING:
+            case MICROBIT_COMMAND_ABORT_WATERING:
+                if (size != 0)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+                break;
+
+            case MICROBIT_COMMAND_REQUEST_HISTORY:
+                if (size != 4 && size != 6)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+                batch.historyFrom = get32(value);
+                batch.historyCount = size == 6 ? get16(value + 4) : MICROBIT_HISTORY_CAPACITY;
+                break;
+
+            case MICROBIT_COMMAND_SET_CALIBRATION:
+                if (size != 5)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+                batch.calibrationDry = get16(value);
+                batch.calibrationWet = get16(value + 2);
+                batch.calibrationCurve = value[4];
+
+                if (!isCalibrationPointValid(batch.calibrationDry) || !isCalibrationPointValid(batch.calibrationWet) ||
+                    batch.calibrationCurve >= MICROBIT_MOISTURE_CURVE_COUNT)
+                    return MICROBIT_COMMAND_STATUS_INVALID;
+
+                // Points kept or read from the probe are only known when the batch is applied
+                if (batch.calibrationDry <= 1023 && batch.calibrationWet <= 1023 &&
+                    batch.calibrationWet - batch.calibrationDry < MICROBIT_MOISTURE_CALIBRATION_MIN_SPAN)
+                    return MICROBIT_COMMAND_STATUS_INVALID;
+                break;
+
+            case MICROBIT_COMMAND_SET_COMPENSATION:
+                if (size != 1)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+                batch.compensation = (int8_t)value[0];
+
+                if (batch.compensation < -MICROBIT_MOISTURE_COMPENSATION_MAX || batch.compensation > MICROBIT_MOISTURE_COMPENSATION_MAX)
+                    return MICROBIT_COMMAND_STATUS_INVALID;
+                break;
+
+            case MICROBIT_COMMAND_EXTEND_WATERING:
+                if (size != 2)
+                    return MICROBIT_COMMAND_STATUS_MALFORMED;
+
+                batch.extension = get16(value);
+
+                if (batch.extension == 0 || batch.extension > MICROBIT_WATERING_MAX_PULSE)
+                    return MICROBIT_COMMAND_STATUS_INVALID;
+                break;
+        }
+
+        batch.commands |= bit;
+    }
+
+    offset = 0;
+
+    return MICROBIT_COMMAND_STATUS_OK;
+}
+
+/**
+  * Notify an acknowledgement.
+  */
+void MicroBitCommandService::notify(uint8_t sequence, uint8_t status, uint8_t offset)
+{
+    commandDataCharacteristicBuffer[0] = sequence;
+    commandDataCharacteristicBuffer[1] = status;
+    commandDataCharacteristicBuffer[2] = offset;
+
+    if (ble.getGapState().connected)
+        ble.gattServer().notify(commandDataCharacteristicHandle, commandDataCharacteristicBuffer, MICROBIT_COMMAND_ACK_SIZE);
+}
+
+// 5e3f0c03b1a94d2e8f3c6a1d2e7b9c40
+const uint8_t  MicroBitCommandServiceUUID[] = {
+    0x5e,0x3f,0x0c,0x03,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
+
+// 5e3fc0deb1a94d2e8f3c6a1d2e7b9c40
+const uint8_t  MicroBitCommandServiceDataUUID[] = {
+    0x5e,0x3f,0xc0,0xde,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
@@ -0,0 +1,207 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_COMMAND_SERVICE_H
+#define MICROBIT_COMMAND_SERVICE_H
+
+#include "MicroBitConfig.h"
+#include "ble/BLE.h"
+
+#include "../../sensors/moisture/MicroBitMoistureSensor.h"
+#include "../../utils/services/MicroBitServiceRegistry.h"
+#include "../../utils/services/MicroBitWriteDispatcher.h"
+
+#define MICROBIT_ID_COMMAND_SERVICE             1336
+#define COMMAND_EVT_RECEIVED                    45
+
+// Largest batch: fits the default ATT MTU
+#define MICROBIT_COMMAND_SIZE                   20
+
+// Size of the acknowledgement: sequence, status, offset of the faulty command
+#define MICROBIT_COMMAND_ACK_SIZE               3
+
+// Command types
+#define MICROBIT_COMMAND_SET_TRESHOLD           1
+#define MICROBIT_COMMAND_SET_PULSE              2
+#define MICROBIT_COMMAND_SET_PERIODS            3
+#define MICROBIT_COMMAND_START_WATERING         4
+#define MICROBIT_COMMAND_STOP_WATERING          5
+#define MICROBIT_COMMAND_ABORT_WATERING         6
+#define MICROBIT_COMMAND_REQUEST_HISTORY        7
+#define MICROBIT_COMMAND_SET_CALIBRATION        8
+#define MICROBIT_COMMAND_SET_COMPENSATION       9
+#define MICROBIT_COMMAND_EXTEND_WATERING        10
+
+// Bit of each command type in MicroBitCommandBatch::commands
+#define MICROBIT_COMMAND_BIT(type)              (1 << ((type) - 1))
+
+// Limits of the values, checked before a batch is applied
+#define MICROBIT_COMMAND_TRESHOLD_MAX           MICROBIT_MOISTURE_VWC_WET
+#define MICROBIT_COMMAND_PERIOD_MIN             100
+
+// Calibration point kept as it is, or taken from the current probe reading
+#define MICROBIT_COMMAND_CALIBRATION_KEEP       0xFFFE
+#define MICROBIT_COMMAND_CALIBRATION_CURRENT    0xFFFF
+
+// Acknowledgement status
+#define MICROBIT_COMMAND_STATUS_OK              0
+#define MICROBIT_COMMAND_STATUS_MALFORMED       1
+#define MICROBIT_COMMAND_STATUS_UNKNOWN         2
+#define MICROBIT_COMMAND_STATUS_INVALID         3
+#define MICROBIT_COMMAND_STATUS_CONFLICT        4
+#define MICROBIT_COMMAND_STATUS_BUSY            5
+
+// Attribute table bytes used by the service
+#define MICROBIT_COMMAND_SERVICE_GATT_SIZE      (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(MICROBIT_COMMAND_SIZE, 1))
+
+// Write dispatcher handlers registered by the service
+#define MICROBIT_COMMAND_SERVICE_WRITE_HANDLERS 1
+
+// UUIDs for our service and characteristics
+extern const uint8_t  MicroBitCommandServiceUUID[];
+extern const uint8_t  MicroBitCommandServiceDataUUID[];
+
+/**
+  * A validated batch of commands, waiting to be applied.
+  * Only the values of the commands flagged in commands are meaningful.
+  */
+struct MicroBitCommandBatch
+{
+    // Sequence number chosen by the peer, repeated in the acknowledgement
+    uint8_t     sequence;
+
+    // MICROBIT_COMMAND_BIT() of each command in the batch
+    uint16_t    commands;
+
+    int32_t     treshold;
+    uint32_t    pulse;
+    uint32_t    minPeriod;
+    uint32_t    maxPeriod;
+    uint32_t    historyFrom;
+    uint32_t    historyCount;
+    uint16_t    calibrationDry;
+    uint16_t    calibrationWet;
+    uint8_t     calibrationCurve;
+    int32_t     compensation;
+    uint32_t    extension;
+};
+
+/**
+  * Class definition for the custom MicroBit Command Service.
+  * Provides a BLE service to send several commands in a single write, e.g. to reconfigure
+  * a vase from a gateway.
+  *
+  * A write is a sequence number (uint8) followed by commands, each made of a type (uint8),
+  * a length (uint8) and a value of that length. All values are little endian.
+  *
+  * - MICROBIT_COMMAND_SET_TRESHOLD: moisture watering treshold (uint8, 1 - MICROBIT_MOISTURE_VWC_WET).
+  * - MICROBIT_COMMAND_SET_PULSE: length of the remote and button waterings in ms (uint16).
+  * - MICROBIT_COMMAND_SET_PERIODS: fastest and slowest moisture sampling periods in ms (2 x uint32).
+  * - MICROBIT_COMMAND_START_WATERING, MICROBIT_COMMAND_STOP_WATERING (soak time kept),
+  *   MICROBIT_COMMAND_ABORT_WATERING (soak time skipped): no value.
+  * - MICROBIT_COMMAND_REQUEST_HISTORY: first sequence number (uint32) and optionally a record
+  *   count (uint16), streamed by the history service.
+  * - MICROBIT_COMMAND_SET_CALIBRATION: raw readings of the probe in dry and saturated soil
+  *   (2 x uint16, or MICROBIT_COMMAND_CALIBRATION_KEEP / MICROBIT_COMMAND_CALIBRATION_CURRENT) and the
+  *   MICROBIT_MOISTURE_CURVE_* between them (uint8).
+  * - MICROBIT_COMMAND_SET_COMPENSATION: temperature compensation of the moisture readings
+  *   (int8, -MICROBIT_MOISTURE_COMPENSATION_MAX - MICROBIT_MOISTURE_COMPENSATION_MAX, 0: off).
+  * - MICROBIT_COMMAND_EXTEND_WATERING: time added to the running watering in ms (uint16,
+  *   1 - MICROBIT_WATERING_MAX_PULSE), within the longest pulse and the water left.
+  *
+  * The whole batch is checked before anything is applied: if any command is malformed,
+  * unknown, out of range, repeated or in conflict with another, none is applied. A batch
+  * holds at most one of the watering actions (start, stop, abort, extend).
+  * Once the batch has been applied, or rejected, the characteristic notifies the sequence
+  * number, a MICROBIT_COMMAND_STATUS_* and the offset in the write of the faulty command (0 if none).
+  *
+  * The service only checks the batch: it fires COMMAND_EVT_RECEIVED, and the application
+  * applies getBatch() and calls acknowledge(), with the status of the checks it could only
+  * do when applying the batch, such as a calibration from the current reading.
+  * A batch written before the previous one has been acknowledged is rejected with
+  * MICROBIT_COMMAND_STATUS_BUSY.
+  */
+class MicroBitCommandService : public MicroBitWriteHandler
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a representation of the CommandService
+      * @param _ble The instance of a BLE device that we're running on.
+      */
+    MicroBitCommandService(BLEDevice &_ble);
+
+    /**
+      * The batch waiting to be applied.
+      */
+    const MicroBitCommandBatch &getBatch();
+
+    /**
+      * Tell the peer that the batch has been applied, and accept the next one.
+      *
+      * @param status MICROBIT_COMMAND_STATUS_OK, or the reason the batch could not be applied.
+      */
+    void acknowledge(uint8_t status = MICROBIT_COMMAND_STATUS_OK);
+
+    /**
+      * Callback. Invoked by MicroBitWriteDispatcher when our characteristic is written via BLE.
+      */
+    virtual void onDataWritten(const GattWriteCallbackParams *params);
+
+    private:
+
+    /**
+      * Check a write and decode it into batch.
+      *
+      * @param data the bytes written.
+      * @param len the number of bytes written.
+      * @param offset set to the offset of the faulty command, if any.
+      *
+      * @return MICROBIT_COMMAND_STATUS_OK if the whole batch is valid, or the reason it is not.
+      */
+    int decode(const uint8_t *data, int len, int &offset);
+
+    /**
+      * Notify an acknowledgement.
+      */
+    void notify(uint8_t sequence, uint8_t status, uint8_t offset);
+
+    // Bluetooth stack we're running on.
+    BLEDevice           &ble;
+
+    // Batch checked and waiting to be applied
+    MicroBitCommandBatch batch;
+    bool                pending;
+
+    // memory for our characteristic.
+    uint8_t             commandDataCharacteristicBuffer[MICROBIT_COMMAND_SIZE];
+
+    // Handles to access each characteristic when they are held by Soft Device.
+    GattAttribute::Handle_t commandDataCharacteristicHandle;
+};
+
+
+#endif
@@ -0,0 +1,267 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for the custom MicroBit History Service.
+  * Provides a BLE service to download the readings stored on the micro:bit.
+  */
+#include "MicroBitConfig.h"
+#include "ble/UUID.h"
+#include "MicroBitSystemTimer.h"
+#include "EventModel.h"
+#include "MicroBitFiber.h"
+#include "MicroBitBLEManager.h"
+
+#include "MicroBitHistoryService.h"
+
+/**
+  * Write a little endian 16 bit value.
+  */
+static void put16(uint8_t *b, uint16_t v)
+{
+    b[0] = v & 0xFF;
+    b[1] = v >> 8;
+}
+
+/**
+  * Write a little endian 32 bit value.
+  */
+static void put32(uint8_t *b, uint32_t v)
+{
+    put16(b, v & 0xFFFF);
+    put16(b + 2, v >> 16);
+}
+
+/**
+  * Constructor.
+  * Create a representation of the HistoryService
+  * @param _ble The instance of a BLE device that we're running on.
+  * @param _history The history to stream.
+  */
+MicroBitHistoryService::MicroBitHistoryService(BLEDevice &_ble, MicroBitHistory &_history) :
+        ble(_ble), history(_history)
+{
+    // Create the data structures that represent each of our characteristics in Soft Device.
+    GattCharacteristic  historyDataCharacteristic(MicroBitHistoryServiceDataUUID, historyDataCharacteristicBuffer, 0,
+    sizeof(historyDataCharacteristicBuffer), GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+
+    // Initialise our characteristic values.
+    memset(historyDataCharacteristicBuffer, 0, sizeof(historyDataCharacteristicBuffer));
+    streaming = false;
+    chunkReady = false;
+    chunkIndex = 0;
+    startSeq = 0;
+    nextSeq = 0;
+    endSeq = 0;
+    sentSeq = 0;
+    connectPending = false;
+    connectTime = 0;
+
+    // Set default security requirements
+    historyDataCharacteristic.requireSecurity(SecurityManager::MICROBIT_BLE_SECURITY_LEVEL);
+
+    GattCharacteristic *characteristics[] = {&historyDataCharacteristic};
+    GattService         service(MicroBitHistoryServiceUUID, characteristics, sizeof(characteristics) / sizeof(GattCharacteristic *));
+
+    ble.addService(service);
+
+    historyDataCharacteristicHandle = historyDataCharacteristic.getValueHandle();
+
+    if (MicroBitWriteDispatcher::add(ble, historyDataCharacteristicHandle, this) != MICROBIT_OK)
+        microbit_panic(MICROBIT_WRITE_DISPATCHER_PANIC);
+    ble.gattServer().onDataSent(this, &MicroBitHistoryService::onDataSent);
+
+    if (EventModel::defaultEventBus)
+    {
+        EventModel::defaultEventBus->listen(MICROBIT_ID_HISTORY_SERVICE, MICROBIT_HISTORY_SERVICE_EVT_PUMP, this, &MicroBitHistoryService::onPump);
+        EventModel::defaultEventBus->listen(MICROBIT_ID_BLE, MICROBIT_BLE_EVT_CONNECTED, this, &MicroBitHistoryService::onConnected, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        EventModel::defaultEventBus->listen(MICROBIT_ID_BLE, MICROBIT_BLE_EVT_CONNECTED, this, &MicroBitHistoryService::backfill);
+    }
+}
+
+/**
+  * Start streaming records to the peer. Any stream in progress is restarted.
+  *
+  * @param from the first sequence number requested. Older records that are not kept anymore are skipped.
+  * @param count the maximum number of records to send.
+  */
+void MicroBitHistoryService::stream(uint32_t from, uint32_t count)
+{
+    // As asked: records older than the first kept count as sent with the stream
+    startSeq = from;
+
+    if (from < history.first())
+        from = history.first();
+
+    if (from > history.end())
+        from = history.end();
+
+    nextSeq = from;
+    endSeq = history.end() - from > count ? from + count : history.end();
+    chunkIndex = 0;
+    chunkReady = false;
+    streaming = true;
+    connectPending = false;
+
+    MicroBitEvent(MICROBIT_ID_HISTORY_SERVICE, MICROBIT_HISTORY_SERVICE_EVT_PUMP);
+}
+
+/**
+  * Callback. Invoked by MicroBitWriteDispatcher when our characteristic is written via BLE.
+  */
+void MicroBitHistoryService::onDataWritten(const GattWriteCallbackParams *params)
+{
+    if (params->len >= 4)
+    {
+        const uint8_t *d = params->data;
+        uint32_t from = d[0] | (d[1] << 8) | (d[2] << 16) | ((uint32_t)d[3] << 24);
+        uint32_t count = params->len >= 6 ? (uint32_t)(d[4] | (d[5] << 8)) : MICROBIT_HISTORY_CAPACITY;
+
+        stream(from, count);
+    }
+}
+
+/**
+  * Callback. Invoked when notifications have been sent, and room is available for more.
+  */
+void MicroBitHistoryService::onDataSent(unsigned)
+{
+    if (streaming || chunkReady)
+        MicroBitEvent(MICROBIT_ID_HISTORY_SERVICE, MICROBIT_HISTORY_SERVICE_EVT_PUMP);
+}
+
+/**
+  * Note that a peer has connected. Immediate listener of MICROBIT_BLE_EVT_CONNECTED.
+  */
+void MicroBitHistoryService::onConnected(MicroBitEvent)
+{
+    connectPending = true;
+    connectTime = system_timer_current_time();
+}
+
+/**
+  * Stream the records the peer has not received, unless it asks for records itself in
+  * the meantime. Listener of MICROBIT_BLE_EVT_CONNECTED.
+  */
+void MicroBitHistoryService::backfill(MicroBitEvent)
+{
+    // Notifications sent before the peer subscribes are lost: give it time to, and to ask
+    // for other records instead. Counted from the last connection, if the peer reconnected.
+    uint64_t now;
+
+    while ((now = system_timer_current_time()) < connectTime + MICROBIT_HISTORY_SERVICE_CONNECT_DELAY)
+        fiber_sleep(connectTime + MICROBIT_HISTORY_SERVICE_CONNECT_DELAY - now);
+
+    if (connectPending && ble.getGapState().connected)
+        stream(sentSeq, MICROBIT_HISTORY_CAPACITY);
+}
+
+/**
+  * Send the pending chunks. Listener of MICROBIT_HISTORY_SERVICE_EVT_PUMP.
+  */
+void MicroBitHistoryService::onPump(MicroBitEvent)
+{
+    pump();
+}
+
+/**
+  * Fill the chunk buffer with the next chunk to send.
+  */
+void MicroBitHistoryService::prepareChunk()
+{
+    uint8_t *b = historyDataCharacteristicBuffer;
+
+    memset(b, 0, MICROBIT_HISTORY_CHUNK_SIZE);
+
+    // The oldest records may have been overwritten while streaming.
+    if (nextSeq < history.first())
+    {
+        put16(b, MICROBIT_HISTORY_CHUNK_END);
+        b[2] = MICROBIT_HISTORY_STATUS_OVERRUN;
+        streaming = false;
+    }
+    else if (chunkIndex == 0)
+    {
+        MicroBitHistorySample state;
+        history.stateBefore(nextSeq, state);
+
+        put16(b, 0);
+        put32(b + 2, nextSeq);
+        put16(b + 6, endSeq - nextSeq);
+        put32(b + 8, state.time);
+        b[12] = state.moisture;
+        b[13] = state.light;
+        b[14] = (uint8_t)state.temperature;
+        put32(b + 15, (uint32_t)(system_timer_current_time() / 1000));
+    }
+    else if (nextSeq < endSeq)
+    {
+        put16(b, chunkIndex);
+
+        for (int i = 0; i < MICROBIT_HISTORY_RECORDS_PER_CHUNK && nextSeq < endSeq; i++)
+            history.read(nextSeq++, b + 2 + i * MICROBIT_HISTORY_RECORD_SIZE);
+    }
+    else
+    {
+        put16(b, MICROBIT_HISTORY_CHUNK_END);
+        b[2] = MICROBIT_HISTORY_STATUS_COMPLETE;
+        streaming = false;
+
+        // The peer now has every record up to the end of the stream
+        if (startSeq <= sentSeq && endSeq > sentSeq)
+            sentSeq = endSeq;
+    }
+
+    chunkIndex++;
+    chunkReady = true;
+}
+
+/**
+  * Notify chunks until the stream is over or the radio is out of buffers.
+  */
+void MicroBitHistoryService::pump()
+{
+    while (ble.getGapState().connected && (streaming || chunkReady))
+    {
+        if (!chunkReady)
+            prepareChunk();
+
+        // Out of buffers: keep the chunk and retry once some have been sent.
+        if (ble.gattServer().notify(historyDataCharacteristicHandle, historyDataCharacteristicBuffer, sizeof(historyDataCharacteristicBuffer)) != BLE_ERROR_NONE)
+            return;
+
+        chunkReady = false;
+    }
+}
+
+// 5e3f0c02b1a94d2e8f3c6a1d2e7b9c40
+const uint8_t  MicroBitHistoryServiceUUID[] = {
+    0x5e,0x3f,0x0c,0x02,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
+
+// 5e3f415bb1a94d2e8f3c6a1d2e7b9c40
+const uint8_t  MicroBitHistoryServiceDataUUID[] = {
+    0x5e,0x3f,0x41,0x5b,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
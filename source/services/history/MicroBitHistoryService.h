@@ -0,0 +1,175 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_HISTORY_SERVICE_H
+#define MICROBIT_HISTORY_SERVICE_H
+
+#include "MicroBitConfig.h"
+#include "ble/BLE.h"
+#include "MicroBitEvent.h"
+
+#include "../../storage/history/MicroBitHistory.h"
+#include "../../utils/services/MicroBitServiceRegistry.h"
+#include "../../utils/services/MicroBitWriteDispatcher.h"
+
+#define MICROBIT_ID_HISTORY_SERVICE             1337
+
+// Chunks are ready to send, or radio buffers have been freed
+#define MICROBIT_HISTORY_SERVICE_EVT_PUMP       1
+
+// Size of a notified chunk: fits the default ATT MTU.
+#define MICROBIT_HISTORY_CHUNK_SIZE             20
+#define MICROBIT_HISTORY_RECORDS_PER_CHUNK      ((MICROBIT_HISTORY_CHUNK_SIZE - 2) / MICROBIT_HISTORY_RECORD_SIZE)
+
+// Index of the chunk that ends a stream
+#define MICROBIT_HISTORY_CHUNK_END              0xFFFF
+
+// Status reported in the end chunk
+#define MICROBIT_HISTORY_STATUS_COMPLETE        0
+#define MICROBIT_HISTORY_STATUS_OVERRUN         1
+
+// Time left to a peer that connects to subscribe, or to ask for records itself, in ms
+#define MICROBIT_HISTORY_SERVICE_CONNECT_DELAY  1000
+
+// Attribute table bytes used by the service
+#define MICROBIT_HISTORY_SERVICE_GATT_SIZE    (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(MICROBIT_HISTORY_CHUNK_SIZE, 1))
+
+// Write dispatcher handlers registered by the service
+#define MICROBIT_HISTORY_SERVICE_WRITE_HANDLERS 1
+
+// UUIDs for our service and characteristics
+extern const uint8_t  MicroBitHistoryServiceUUID[];
+extern const uint8_t  MicroBitHistoryServiceDataUUID[];
+
+/**
+  * Class definition for the custom MicroBit History Service.
+  * Provides a BLE service to download the readings stored in a MicroBitHistory.
+  *
+  * The peer writes the first sequence number it wants (uint32) and optionally how many
+  * records (uint16). The service then notifies the records in chunks of
+  * MICROBIT_HISTORY_CHUNK_SIZE bytes, starting each chunk with its index (uint16),
+  * as fast as the radio accepts them. All values are little endian.
+  *
+  * - Chunk 0 is the header: first sequence number (uint32), record count (uint16),
+  *   state before the first record (time in s (uint32), moisture, light, temperature),
+  *   current device time in s (uint32).
+  * - Chunks 1 to N hold MICROBIT_HISTORY_RECORDS_PER_CHUNK encoded records each, see MicroBitHistory.
+  * - Chunk MICROBIT_HISTORY_CHUNK_END closes the stream, followed by a MICROBIT_HISTORY_STATUS_* byte.
+  *
+  * A peer that connects is sent the records it has not received yet, from the end of the
+  * last stream that completed on or after them, unless it asks for records itself within
+  * MICROBIT_HISTORY_SERVICE_CONNECT_DELAY ms.
+  *
+  * The BLE callbacks run in interrupt context: they only fire MICROBIT_HISTORY_SERVICE_EVT_PUMP,
+  * and the chunks are read and notified by its listener.
+  */
+class MicroBitHistoryService : public MicroBitWriteHandler
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a representation of the HistoryService
+      * @param _ble The instance of a BLE device that we're running on.
+      * @param _history The history to stream.
+      */
+    MicroBitHistoryService(BLEDevice &_ble, MicroBitHistory &_history);
+
+    /**
+      * Start streaming records to the peer. Any stream in progress is restarted.
+      *
+      * @param from the first sequence number requested. Older records that are not kept anymore are skipped.
+      * @param count the maximum number of records to send.
+      */
+    void stream(uint32_t from, uint32_t count);
+
+    /**
+      * Callback. Invoked by MicroBitWriteDispatcher when our characteristic is written via BLE.
+      */
+    virtual void onDataWritten(const GattWriteCallbackParams *params);
+
+    /**
+      * Callback. Invoked when notifications have been sent, and room is available for more.
+      */
+    void onDataSent(unsigned count);
+
+    private:
+
+    /**
+      * Note that a peer has connected. Immediate listener of MICROBIT_BLE_EVT_CONNECTED.
+      */
+    void onConnected(MicroBitEvent e);
+
+    /**
+      * Stream the records the peer has not received, unless it asks for records itself in
+      * the meantime. Listener of MICROBIT_BLE_EVT_CONNECTED.
+      */
+    void backfill(MicroBitEvent e);
+
+    /**
+      * Send the pending chunks. Listener of MICROBIT_HISTORY_SERVICE_EVT_PUMP.
+      */
+    void onPump(MicroBitEvent e);
+
+    /**
+      * Fill the chunk buffer with the next chunk to send.
+      */
+    void prepareChunk();
+
+    /**
+      * Notify chunks until the stream is over or the radio is out of buffers.
+      */
+    void pump();
+
+    // Bluetooth stack we're running on.
+    BLEDevice           	&ble;
+
+    // Records to stream
+    MicroBitHistory     &history;
+
+    // memory for the chunk being sent.
+    uint8_t             historyDataCharacteristicBuffer[MICROBIT_HISTORY_CHUNK_SIZE];
+
+    // Stream state
+    bool                streaming;
+    bool                chunkReady;
+    uint16_t            chunkIndex;
+    uint32_t            startSeq;
+    uint32_t            nextSeq;
+    uint32_t            endSeq;
+
+    // Sequence number of the first record the peer has not received
+    uint32_t            sentSeq;
+
+    // A peer has connected and not asked for records yet, and when
+    bool                connectPending;
+    uint64_t            connectTime;
+
+    // Handles to access each characteristic when they are held by Soft Device.
+    GattAttribute::Handle_t historyDataCharacteristicHandle;
+};
+
+
+#endif
@@ -25,45 +25,27 @@ DEALINGS IN THE SOFTWARE.
 
 /**
   * Class definition for the custom MicroBit Light Service.
-  * Provides a BLE service to remotely read the light on the micro:bit display.
+  * Provides a BLE service to remotely read the light sensed through the micro:bit display LEDs.
   */
 #include "MicroBitConfig.h"
 #include "ble/UUID.h"
 
 #include "MicroBitLightService.h"
-#include "MicroBitSystemTimer.h"
 
 /**
   * Constructor.
   * Create a representation of the LightService
   * @param _ble The instance of a BLE device that we're running on.
-  * @param _display An instance of MicroBitDisplay to use as our display source.
+  * @param _sensor An instance of MicroBitAmbientLightSensor to use as our light source.
   */
-MicroBitLightService::MicroBitLightService(BLEDevice &_ble, MicroBitDisplay &_display) :
-        ble(_ble), display(_display)
+MicroBitLightService::MicroBitLightService(BLEDevice &_ble, MicroBitAmbientLightSensor &_sensor) :
+        MicroBitCharacteristicService<uint8_t>(_ble, MicroBitLightServiceUUID, MicroBitLightServiceDataUUID,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, _sensor.getLightLevel(),
+            MicroBitNotifyPolicy(MICROBIT_LIGHT_SERVICE_DEADBAND, MICROBIT_LIGHT_SERVICE_PERIOD, MICROBIT_LIGHT_SERVICE_MAX_SILENCE)),
+        sensor(_sensor)
 {
-    // Create the data structures that represent each of our characteristics in Soft Device.
-    GattCharacteristic  lightDataCharacteristic(MicroBitLightServiceDataUUID, (uint8_t *)&lightDataCharacteristicBuffer, 0,
-    sizeof(lightDataCharacteristicBuffer), GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
-
-    // Initialise our characteristic values.
-    lightDataCharacteristicBuffer = display.readLightLevel();
-    lastUpdate = system_timer_current_time();
-
-    // Set default security requirements
-    lightDataCharacteristic.requireSecurity(SecurityManager::MICROBIT_BLE_SECURITY_LEVEL);
-
-    GattCharacteristic *characteristics[] = {&lightDataCharacteristic};
-    GattService         service(MicroBitLightServiceUUID, characteristics, sizeof(characteristics) / sizeof(GattCharacteristic *));
-
-    ble.addService(service);
-
-    lightDataCharacteristicHandle = lightDataCharacteristic.getValueHandle();
-
-    ble.gattServer().write(lightDataCharacteristicHandle,(uint8_t *)&lightDataCharacteristicBuffer, sizeof(lightDataCharacteristicBuffer));
-
     if (EventModel::defaultEventBus)
-        EventModel::defaultEventBus->listen(MICROBIT_ID_DISPLAY, MICROBIT_DISPLAY_EVT_LIGHT_SENSE, this, &MicroBitLightService::lightUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        EventModel::defaultEventBus->listen(sensor.id, MICROBIT_AMBIENT_LIGHT_EVT_UPDATE, this, &MicroBitLightService::lightUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
 }
 
 /**
@@ -71,13 +53,7 @@ MicroBitLightService::MicroBitLightService(BLEDevice &_ble, MicroBitDisplay &_di
   */
 void MicroBitLightService::lightUpdate(MicroBitEvent)
 {
-    if (ble.getGapState().connected && lastUpdate + MICROBIT_LIGHT_SERVICE_PERIOD <= system_timer_current_time())
-    {
-        lightDataCharacteristicBuffer = display.readLightLevel();
-        ble.gattServer().notify(lightDataCharacteristicHandle,(uint8_t *)&lightDataCharacteristicBuffer, sizeof(lightDataCharacteristicBuffer));
-
-        lastUpdate = system_timer_current_time();
-    }
+    update(sensor.getLightLevel());
 }
 
 // 02751625523e493b8f941765effa1b20
@@ -88,4 +64,4 @@ const uint8_t  MicroBitLightServiceUUID[] = {
 // 02759250523e493b8f941765effa1b20
 const uint8_t  MicroBitLightServiceDataUUID[] = {
     0x02,0x75,0x92,0x50,0x52,0x3e,0x49,0x3b,0x8f,0x94,0x17,0x65,0xef,0xfa,0x1b,0x20
-};
\ No newline at end of file
+};
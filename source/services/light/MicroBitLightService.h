@@ -26,32 +26,44 @@ DEALINGS IN THE SOFTWARE.
 #ifndef MICROBIT_LIGHT_SERVICE_H
 #define MICROBIT_LIGHT_SERVICE_H
 
+// Default notification policy of the light characteristic
 #define MICROBIT_LIGHT_SERVICE_PERIOD 5000
+#define MICROBIT_LIGHT_SERVICE_DEADBAND 4
+#define MICROBIT_LIGHT_SERVICE_MAX_SILENCE 60000
 
 #include "MicroBitConfig.h"
 #include "ble/BLE.h"
-#include "MicroBitDisplay.h"
 #include "EventModel.h"
 
+#include "../characteristic/MicroBitCharacteristicService.h"
+#include "../../sensors/light/MicroBitAmbientLightSensor.h"
+#include "../../utils/services/MicroBitServiceRegistry.h"
+
+// Attribute table bytes used by the service
+#define MICROBIT_LIGHT_SERVICE_GATT_SIZE      (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(1, 1))
+
+// Write dispatcher handlers registered by the service
+#define MICROBIT_LIGHT_SERVICE_WRITE_HANDLERS 0
+
 // UUIDs for our service and characteristics
 extern const uint8_t  MicroBitLightServiceUUID[];
 extern const uint8_t  MicroBitLightServiceDataUUID[];
 
 /**
-  * Class definition for the custom MicroBit Temperature Service.
-  * Provides a BLE service to remotely read the silicon temperature of the nRF51822.
+  * Class definition for the custom MicroBit Light Service.
+  * Provides a BLE service to remotely read the light level (0 - 255) sensed through the micro:bit display LEDs.
   */
-class MicroBitLightService
+class MicroBitLightService : public MicroBitCharacteristicService<uint8_t>
 {
     public:
 
     /**
       * Constructor.
-      * Create a representation of the TemperatureService
+      * Create a representation of the LightService
       * @param _ble The instance of a BLE device that we're running on.
-      * @param _thermometer An instance of MicroBitThermometer to use as our temperature source.
+      * @param _sensor An instance of MicroBitAmbientLightSensor to use as our light source.
       */
-    MicroBitLightService(BLEDevice &_ble, MicroBitDisplay &_display);
+    MicroBitLightService(BLEDevice &_ble, MicroBitAmbientLightSensor &_sensor);
 
     /**
      * Light update callback
@@ -60,19 +72,8 @@ class MicroBitLightService
 
     private:
 
-    // Bluetooth stack we're running on.
-    BLEDevice           	&ble;
-    MicroBitDisplay     &display;
-
-    // Memory for our 8 bit temperature characteristic.
-    int8_t             lightDataCharacteristicBuffer;
-
-    // Last light update
-    uint64_t lastUpdate;
-
-    // Handles to access each characteristic when they are held by Soft Device.
-    GattAttribute::Handle_t lightDataCharacteristicHandle;
+    MicroBitAmbientLightSensor  &sensor;
 };
 
 
-#endif
\ No newline at end of file
+#endif
@@ -32,12 +32,13 @@ DEALINGS IN THE SOFTWARE.
 
 #include "MicroBitMoistureService.h"
 #include "../../sensors/moisture/MicroBitMoistureSensor.h"
+#include "../../utils/profiling/MicroBitProfiler.h"
 
 /**
  * Returns true if value is a valid moisture level.
  */
 bool isMoistureTresholdValid(int32_t value) {
-  return value > 0;
+  return value > 0 && value <= MICROBIT_MOISTURE_VWC_WET;
 }
 
 /**
@@ -45,32 +46,16 @@ bool isMoistureTresholdValid(int32_t value) {
   * Create a representation of the MoistureService
   * @param _ble The instance of a BLE device that we're running on.
   * @param _sensor An instance of MicroBitMoistureSensor to use as our moisture source.
+  * @param treshold The initial moisture level treshold, e.g. the one saved before a reset.
   */
-MicroBitMoistureService::MicroBitMoistureService(BLEDevice &_ble, MicroBitMoistureSensor &_sensor) :
-        ble(_ble), sensor(_sensor)
+MicroBitMoistureService::MicroBitMoistureService(BLEDevice &_ble, MicroBitMoistureSensor &_sensor, int32_t treshold) :
+        MicroBitCharacteristicService<uint16_t>(_ble, MicroBitMoistureServiceUUID, MicroBitMoistureServiceDataUUID,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE, _sensor.getMoistureLevel(),
+            MicroBitNotifyPolicy(MICROBIT_MOISTURE_SERVICE_DEADBAND, MICROBIT_MOISTURE_SERVICE_MIN_INTERVAL, MICROBIT_MOISTURE_SERVICE_MAX_SILENCE)),
+        moistureTreshold(treshold), sensor(_sensor)
 {
-    // Create the data structures that represent each of our characteristics in Soft Device.
-    GattCharacteristic  moistureDataCharacteristic(MicroBitMoistureServiceDataUUID, (uint8_t *)&moistureDataCharacteristicBuffer, 0,
-    sizeof(moistureDataCharacteristicBuffer), GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE);
-
-    // Initialise our characteristic values.
-    moistureDataCharacteristicBuffer = sensor.getMoistureLevel();
-
-    // Set default security requirements
-    moistureDataCharacteristic.requireSecurity(SecurityManager::MICROBIT_BLE_SECURITY_LEVEL);
-
-    GattCharacteristic *characteristics[] = {&moistureDataCharacteristic};
-    GattService         service(MicroBitMoistureServiceUUID, characteristics, sizeof(characteristics) / sizeof(GattCharacteristic *));
-
-    ble.addService(service);
-
-    moistureDataCharacteristicHandle = moistureDataCharacteristic.getValueHandle();
-
-    ble.gattServer().write(moistureDataCharacteristicHandle,(uint8_t *)&moistureDataCharacteristicBuffer, sizeof(moistureDataCharacteristicBuffer));
-
-    ble.onDataWritten(this, &MicroBitMoistureService::onDataWritten);
     if (EventModel::defaultEventBus)
-        EventModel::defaultEventBus->listen(MICROBIT_ID_MOISTURE, MICROBIT_MOISTURE_EVT_UPDATE, this, &MicroBitMoistureService::moistureUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        EventModel::defaultEventBus->listen(sensor.id, MICROBIT_MOISTURE_EVT_UPDATE, this, &MicroBitMoistureService::moistureUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
 }
 
 /**
@@ -78,34 +63,27 @@ MicroBitMoistureService::MicroBitMoistureService(BLEDevice &_ble, MicroBitMoistu
   */
 void MicroBitMoistureService::moistureUpdate(MicroBitEvent)
 {
-    if (ble.getGapState().connected)
-    {
-        moistureDataCharacteristicBuffer = sensor.getMoistureLevel();
-        ble.gattServer().notify(moistureDataCharacteristicHandle,(uint8_t *)&moistureDataCharacteristicBuffer, sizeof(moistureDataCharacteristicBuffer));
-    }
+    PROFILER_END(PROFILER_STAGE_DISPATCH);
+    PROFILER_BEGIN(PROFILER_STAGE_HANDLER);
+
+    int32_t level = sensor.getMoistureLevel();
+
+    PROFILER_BEGIN(PROFILER_STAGE_NOTIFY);
+    update(level);
+    PROFILER_END(PROFILER_STAGE_NOTIFY);
+
+    PROFILER_END(PROFILER_STAGE_HANDLER);
 }
 
 /**
-  * Callback. Invoked when any of our attributes are written via BLE.
+  * Sets the treshold written by a peer.
   */
-void MicroBitMoistureService::onDataWritten(const GattWriteCallbackParams *params)
+void MicroBitMoistureService::onWrite(const uint16_t &value)
 {
-    if (params->handle == moistureDataCharacteristicHandle && params->len >= sizeof(moistureDataCharacteristicBuffer))
-    {
-        moistureDataCharacteristicBuffer = *((uint16_t *)params->data);
-        if(isMoistureTresholdValid(moistureDataCharacteristicBuffer))
-        {
-            // update value
-            moistureTreshold = moistureDataCharacteristicBuffer;
-
-            // fire update event
-            MicroBitEvent evt = MicroBitEvent(MICROBIT_ID_MOISTURE_SERVICE, MOISTURE_TRESHOLD_UPDATED);
-            evt.fire();
-        }
-
-        moistureDataCharacteristicBuffer = sensor.getMoistureLevel();
-        ble.gattServer().notify(moistureDataCharacteristicHandle,(uint8_t *)&moistureDataCharacteristicBuffer, sizeof(moistureDataCharacteristicBuffer));
-    }
+    setMoistureLevelTreshold(value);
+
+    // Show the reading again, rather than the written treshold
+    set(sensor.getMoistureLevel());
 }
 
 /**
@@ -115,6 +93,26 @@ int32_t MicroBitMoistureService::getMoistureLevelTreshold() {
   return moistureTreshold;
 }
 
+/**
+  * Set the moisture level treshold.
+  *
+  * @param treshold the new treshold.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if treshold is not a valid moisture level.
+  */
+int MicroBitMoistureService::setMoistureLevelTreshold(int32_t treshold)
+{
+    if (!isMoistureTresholdValid(treshold))
+        return MICROBIT_INVALID_PARAMETER;
+
+    moistureTreshold = treshold;
+
+    // fire update event
+    MicroBitEvent(MICROBIT_ID_MOISTURE_SERVICE, MOISTURE_TRESHOLD_UPDATED);
+
+    return MICROBIT_OK;
+}
+
 // 73cd5e04d32c4345a543487435c70c48
 const uint8_t  MicroBitMoistureServiceUUID[] = {
     0x73,0xcd,0x5e,0x04,0xd3,0x2c,0x43,0x45,0xa5,0x43,0x48,0x74,0x35,0xc7,0x0c,0x48
@@ -30,20 +30,34 @@ DEALINGS IN THE SOFTWARE.
 #include "ble/BLE.h"
 #include "EventModel.h"
 
+#include "../characteristic/MicroBitCharacteristicService.h"
 #include "../../sensors/moisture/MicroBitMoistureSensor.h"
+#include "../../utils/services/MicroBitServiceRegistry.h"
 
 #define MICROBIT_ID_MOISTURE_SERVICE          1335
 #define MOISTURE_TRESHOLD_UPDATED             43
 
+// Default notification policy of the moisture characteristic
+#define MICROBIT_MOISTURE_SERVICE_DEADBAND        1
+#define MICROBIT_MOISTURE_SERVICE_MIN_INTERVAL    1000
+#define MICROBIT_MOISTURE_SERVICE_MAX_SILENCE     60000
+
+// Attribute table bytes used by the service
+#define MICROBIT_MOISTURE_SERVICE_GATT_SIZE   (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(2, 1))
+
+// Write dispatcher handlers registered by the service
+#define MICROBIT_MOISTURE_SERVICE_WRITE_HANDLERS 1
+
 // UUIDs for our service and characteristics
 extern const uint8_t  MicroBitMoistureServiceUUID[];
 extern const uint8_t  MicroBitMoistureServiceDataUUID[];
 
 /**
-  * Class definition for the custom MicroBit Temperature Service.
-  * Provides a BLE service to remotely read the moisture level read by the micro:bit.
+  * Class definition for the custom MicroBit Moisture Service.
+  * Provides a BLE service to remotely read the moisture level read by the micro:bit, as a
+  * volumetric water content in % (little endian uint16). Writing the characteristic sets the watering treshold.
   */
-class MicroBitMoistureService
+class MicroBitMoistureService : public MicroBitCharacteristicService<uint16_t>
 {
     public:
 
@@ -52,8 +66,9 @@ class MicroBitMoistureService
       * Create a representation of the MicroBitMoistureService
       * @param _ble The instance of a BLE device that we're running on.
       * @param _sensor An instance of MicroBitMoistureSensor to use as our moisture source.
+      * @param treshold The initial moisture level treshold, e.g. the one saved before a reset.
       */
-    MicroBitMoistureService(BLEDevice &_ble, MicroBitMoistureSensor &_sensor);
+    MicroBitMoistureService(BLEDevice &_ble, MicroBitMoistureSensor &_sensor, int32_t treshold);
 
     /**
      * Moisture update callback
@@ -66,26 +81,29 @@ class MicroBitMoistureService
     int32_t getMoistureLevelTreshold();
 
     /**
-    * Callback. Invoked when any of our attributes are written via BLE.
-    */
-    void onDataWritten(const GattWriteCallbackParams *params);
+     * Set the moisture level treshold.
+     *
+     * @param treshold the new treshold.
+     *
+     * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if treshold is not a valid moisture level.
+     */
+    int setMoistureLevelTreshold(int32_t treshold);
+
+    protected:
+
+    /**
+     * Sets the treshold written by a peer.
+     */
+    virtual void onWrite(const uint16_t &value);
 
     private:
 
     // moisture level treshold
     int32_t moistureTreshold;
 
-    // Bluetooth stack we're running on.
-    BLEDevice           	&ble;
     // Pins for reading moisture
     MicroBitMoistureSensor     &sensor;
-
-    // memory for our 8 bit moisture characteristic.
-    int8_t             moistureDataCharacteristicBuffer;
-
-    // Handles to access each characteristic when they are held by Soft Device.
-    GattAttribute::Handle_t moistureDataCharacteristicHandle;
 };
 
 
-#endif
\ No newline at end of file
+#endif
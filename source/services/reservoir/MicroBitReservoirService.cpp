@@ -0,0 +1,138 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for the custom MicroBit Reservoir Service.
+  * Provides a BLE service to remotely read and set the water left in the tank.
+  */
+#include "MicroBitConfig.h"
+#include "ble/UUID.h"
+
+#include "MicroBitReservoirService.h"
+
+/**
+  * Write a MicroBitReservoirValue into the characteristic buffer.
+  */
+void MicroBitReservoirEncoding::encode(const MicroBitReservoirValue &value, uint8_t *b)
+{
+    MicroBitLittleEndian<uint16_t>::encode(value.volume, b);
+    MicroBitLittleEndian<uint16_t>::encode(value.capacity, b + 2);
+    MicroBitLittleEndian<uint16_t>::encode(value.flowRate, b + 4);
+    MicroBitLittleEndian<uint32_t>::encode(value.timeToEmpty, b + 6);
+}
+
+/**
+  * Read a written MicroBitReservoirValue: the water left, optionally followed by the
+  * tank size and the flow rate. The fields not written are 0.
+  */
+int MicroBitReservoirEncoding::decode(const uint8_t *data, int len, MicroBitReservoirValue &value)
+{
+    if (len != 2 && len != 4 && len != 6)
+        return MICROBIT_INVALID_PARAMETER;
+
+    memset(&value, 0, sizeof(value));
+
+    MicroBitLittleEndian<uint16_t>::decode(data, 2, value.volume);
+
+    if (len >= 4)
+        MicroBitLittleEndian<uint16_t>::decode(data + 2, 2, value.capacity);
+
+    if (len >= 6)
+        MicroBitLittleEndian<uint16_t>::decode(data + 4, 2, value.flowRate);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Constructor.
+  * Create a representation of the ReservoirService
+  * @param _ble The instance of a BLE device that we're running on.
+  * @param _reservoir The tank the pump draws from.
+  */
+MicroBitReservoirService::MicroBitReservoirService(BLEDevice &_ble, MicroBitReservoir &_reservoir) :
+        MicroBitCharacteristicService<MicroBitReservoirValue, MicroBitReservoirEncoding, MicroBitNotifyAlways>(_ble, MicroBitReservoirServiceUUID, MicroBitReservoirServiceDataUUID,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE, MicroBitReservoirValue()),
+        reservoir(_reservoir)
+{
+    set(read());
+
+    if (EventModel::defaultEventBus)
+        EventModel::defaultEventBus->listen(MICROBIT_ID_RESERVOIR, MICROBIT_RESERVOIR_EVT_UPDATE, this, &MicroBitReservoirService::reservoirUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+}
+
+/**
+  * Reservoir update callback
+  */
+void MicroBitReservoirService::reservoirUpdate(MicroBitEvent)
+{
+    MicroBitReservoirValue value = read();
+
+    // Keep the value read by the peers up to date while none is connected
+    if (!update(value))
+        set(value);
+}
+
+/**
+  * Records the refill and the calibration written by a peer.
+  */
+void MicroBitReservoirService::onWrite(const MicroBitReservoirValue &value)
+{
+    if (value.capacity)
+        reservoir.setCapacity((uint32_t)value.capacity * 1000);
+
+    if (value.flowRate)
+        reservoir.setFlowRate(((uint32_t)value.flowRate * 1000) / 60);
+
+    // Fires the update, that writes the new value back
+    reservoir.refill(value.volume == RESERVOIR_FULL ? MICROBIT_RESERVOIR_UNKNOWN : (uint32_t)value.volume * 1000);
+}
+
+/**
+  * Returns the current state of the reservoir, in the units of the characteristic.
+  */
+MicroBitReservoirValue MicroBitReservoirService::read()
+{
+    MicroBitReservoirValue value;
+
+    value.volume = reservoir.getVolume() / 1000;
+    value.capacity = reservoir.getCapacity() / 1000;
+    value.flowRate = (reservoir.getFlowRate() * 60) / 1000;
+    value.timeToEmpty = reservoir.getTimeToEmpty();
+
+    if (value.timeToEmpty != MICROBIT_RESERVOIR_UNKNOWN)
+        value.timeToEmpty /= 60;
+
+    return value;
+}
+
+// ce9eafe5c44341db9cb581e567f3ba93
+const uint8_t  MicroBitReservoirServiceUUID[] = {
+    0xce,0x9e,0xaf,0xe5,0xc4,0x43,0x41,0xdb,0x9c,0xb5,0x81,0xe5,0x67,0xf3,0xba,0x93
+};
+
+// ce9e7e5ec44341db9cb581e567f3ba93
+const uint8_t  MicroBitReservoirServiceDataUUID[] = {
+    0xce,0x9e,0x7e,0x5e,0xc4,0x43,0x41,0xdb,0x9c,0xb5,0x81,0xe5,0x67,0xf3,0xba,0x93
+};
@@ -0,0 +1,128 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_RESERVOIR_SERVICE_H
+#define MICROBIT_RESERVOIR_SERVICE_H
+
+#include "MicroBitConfig.h"
+#include "ble/BLE.h"
+#include "EventModel.h"
+
+#include "../characteristic/MicroBitCharacteristicService.h"
+#include "../../actuators/watering/MicroBitReservoir.h"
+#include "../../utils/services/MicroBitServiceRegistry.h"
+
+// Size of the reservoir value, see MicroBitReservoirService.
+#define RESERVOIR_VALUE_SIZE                  10
+
+// Level to write to the reservoir characteristic for a full tank.
+#define RESERVOIR_FULL                        0xFFFF
+
+// Attribute table bytes used by the service
+#define MICROBIT_RESERVOIR_SERVICE_GATT_SIZE  (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(RESERVOIR_VALUE_SIZE, 1))
+
+// Write dispatcher handlers registered by the service
+#define MICROBIT_RESERVOIR_SERVICE_WRITE_HANDLERS 1
+
+// UUIDs for our service and characteristics
+extern const uint8_t  MicroBitReservoirServiceUUID[];
+extern const uint8_t  MicroBitReservoirServiceDataUUID[];
+
+/**
+  * Value of the reservoir characteristic.
+  */
+struct MicroBitReservoirValue
+{
+    // Water left, tank size (ml) and flow rate of the pump (ml/min). 0 if not written.
+    uint16_t    volume;
+    uint16_t    capacity;
+    uint16_t    flowRate;
+
+    // Estimated time before the tank is empty, in minutes, or MICROBIT_RESERVOIR_UNKNOWN
+    uint32_t    timeToEmpty;
+};
+
+/**
+  * Little endian encoding of MicroBitReservoirValue, see MicroBitReservoirService.
+  */
+struct MicroBitReservoirEncoding
+{
+    static const int size = RESERVOIR_VALUE_SIZE;
+
+    static void encode(const MicroBitReservoirValue &value, uint8_t *buffer);
+
+    static int decode(const uint8_t *data, int len, MicroBitReservoirValue &value);
+};
+
+/**
+  * Class definition for the custom MicroBit Reservoir Service.
+  * Provides a BLE service to remotely read the water left in the tank, little endian:
+  *
+  *  offset  size  field
+  *  0       2     water left, in ml
+  *  2       2     tank size, in ml
+  *  4       2     flow rate of the pump, in ml/min
+  *  6       4     estimated time before the tank is empty, in minutes (0xFFFFFFFF: unknown)
+  *
+  * Write the water left after a refill (RESERVOIR_FULL for a full tank), optionally
+  * followed by the tank size and the calibrated flow rate, with the same layout.
+  */
+class MicroBitReservoirService : public MicroBitCharacteristicService<MicroBitReservoirValue, MicroBitReservoirEncoding, MicroBitNotifyAlways>
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a representation of the ReservoirService
+      * @param _ble The instance of a BLE device that we're running on.
+      * @param _reservoir The tank the pump draws from.
+      */
+    MicroBitReservoirService(BLEDevice &_ble, MicroBitReservoir &_reservoir);
+
+    /**
+     * Reservoir update callback
+     */
+    void reservoirUpdate(MicroBitEvent e);
+
+    protected:
+
+    /**
+     * Records the refill and the calibration written by a peer.
+     */
+    virtual void onWrite(const MicroBitReservoirValue &value);
+
+    private:
+
+    /**
+     * Returns the current state of the reservoir, in the units of the characteristic.
+     */
+    MicroBitReservoirValue read();
+
+    // Tank the pump draws from
+    MicroBitReservoir             &reservoir;
+};
+
+
+#endif
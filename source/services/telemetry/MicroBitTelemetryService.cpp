@@ -0,0 +1,126 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for the custom MicroBit Telemetry Service.
+  * Provides a BLE service to remotely read all the readings of the micro:bit at once.
+  */
+#include "MicroBitConfig.h"
+#include "ble/UUID.h"
+#include "MicroBitSystemTimer.h"
+
+#include "MicroBitTelemetryService.h"
+
+/**
+  * Constructor.
+  * Create a representation of the TelemetryService
+  * @param _ble The instance of a BLE device that we're running on.
+  * @param _lightSensor An instance of MicroBitAmbientLightSensor to use as our light source.
+  * @param _thermometer An instance of MicroBitThermometer to use as our temperature source.
+  * @param _sensor An instance of MicroBitMoistureSensor to use as our moisture source.
+  * @param _actuator An instance of MicroBitWateringActuator used to read the watering status.
+  */
+MicroBitTelemetryService::MicroBitTelemetryService(BLEDevice &_ble, MicroBitAmbientLightSensor &_lightSensor, MicroBitThermometer &_thermometer,
+                                                   MicroBitMoistureSensor &_sensor, MicroBitWateringActuator &_actuator) :
+        MicroBitCharacteristicService<MicroBitTelemetrySnapshot, MicroBitTelemetryEncoding, MicroBitTelemetryNotifyPolicy>(_ble,
+            MicroBitTelemetryServiceUUID, MicroBitTelemetryServiceDataUUID,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, MicroBitTelemetrySnapshot()),
+        lightSensor(_lightSensor), thermometer(_thermometer), sensor(_sensor), actuator(_actuator), sequence(0)
+{
+    // Initialise our characteristic value.
+    set(read());
+
+    if (EventModel::defaultEventBus)
+    {
+        EventModel::defaultEventBus->listen(sensor.id, MICROBIT_MOISTURE_EVT_UPDATE, this, &MicroBitTelemetryService::telemetryUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        EventModel::defaultEventBus->listen(actuator.id, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE, this, &MicroBitTelemetryService::telemetryUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+    }
+}
+
+/**
+  * Update callback, invoked once per update cycle.
+  */
+void MicroBitTelemetryService::telemetryUpdate(MicroBitEvent)
+{
+    update(read());
+}
+
+/**
+  * Counts the notifications, for the sequence number.
+  */
+void MicroBitTelemetryService::onNotify()
+{
+    sequence++;
+}
+
+/**
+  * Read all the sources.
+  *
+  * @return the current readings, with the sequence number of the next notification.
+  */
+MicroBitTelemetrySnapshot MicroBitTelemetryService::read()
+{
+    MicroBitTelemetrySnapshot snapshot;
+
+    snapshot.sequence = sequence;
+    snapshot.timestamp = (uint32_t)system_timer_current_time();
+    snapshot.moisture = sensor.getMoistureLevel();
+    snapshot.light = lightSensor.getLightLevel();
+    snapshot.temperature = thermometer.getTemperature();
+    snapshot.flags = actuator.isWatering() ? MICROBIT_TELEMETRY_FLAG_WATERING : 0;
+
+    return snapshot;
+}
+
+/**
+  * Encode a snapshot into the characteristic buffer.
+  *
+  * @param snapshot the readings.
+  * @param b the characteristic buffer, MICROBIT_TELEMETRY_PACKET_SIZE bytes.
+  */
+void MicroBitTelemetryEncoding::encode(const MicroBitTelemetrySnapshot &snapshot, uint8_t *b)
+{
+    b[0] = snapshot.sequence & 0xFF;
+    b[1] = snapshot.sequence >> 8;
+    b[2] = snapshot.timestamp & 0xFF;
+    b[3] = (snapshot.timestamp >> 8) & 0xFF;
+    b[4] = (snapshot.timestamp >> 16) & 0xFF;
+    b[5] = snapshot.timestamp >> 24;
+    b[6] = snapshot.moisture & 0xFF;
+    b[7] = (snapshot.moisture >> 8) & 0xFF;
+    b[8] = snapshot.light;
+    b[9] = (uint8_t)snapshot.temperature;
+    b[10] = snapshot.flags;
+}
+
+// 5e3f0c01b1a94d2e8f3c6a1d2e7b9c40
+const uint8_t  MicroBitTelemetryServiceUUID[] = {
+    0x5e,0x3f,0x0c,0x01,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
+
+// 5e3f7e1eb1a94d2e8f3c6a1d2e7b9c40
+const uint8_t  MicroBitTelemetryServiceDataUUID[] = {
+    0x5e,0x3f,0x7e,0x1e,0xb1,0xa9,0x4d,0x2e,0x8f,0x3c,0x6a,0x1d,0x2e,0x7b,0x9c,0x40
+};
@@ -0,0 +1,178 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_TELEMETRY_SERVICE_H
+#define MICROBIT_TELEMETRY_SERVICE_H
+
+#include "MicroBitConfig.h"
+#include "ble/BLE.h"
+#include "MicroBitThermometer.h"
+#include "EventModel.h"
+
+#include "../characteristic/MicroBitCharacteristicService.h"
+#include "../../sensors/moisture/MicroBitMoistureSensor.h"
+#include "../../sensors/light/MicroBitAmbientLightSensor.h"
+#include "../../actuators/watering/MicroBitWateringActuator.h"
+#include "../../utils/notify/MicroBitNotifyPolicy.h"
+#include "../../utils/services/MicroBitServiceRegistry.h"
+
+// Size of the packed telemetry value, see MicroBitTelemetryService.
+#define MICROBIT_TELEMETRY_PACKET_SIZE              11
+
+#define MICROBIT_TELEMETRY_FLAG_WATERING            0x01
+
+// Default notification policy: any change, at most once per second, at least once a minute.
+#define MICROBIT_TELEMETRY_SERVICE_MIN_INTERVAL     1000
+#define MICROBIT_TELEMETRY_SERVICE_MAX_SILENCE      60000
+
+// Attribute table bytes used by the service
+#define MICROBIT_TELEMETRY_SERVICE_GATT_SIZE  (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(MICROBIT_TELEMETRY_PACKET_SIZE, 1))
+
+// Write dispatcher handlers registered by the service
+#define MICROBIT_TELEMETRY_SERVICE_WRITE_HANDLERS 0
+
+// UUIDs for our service and characteristics
+extern const uint8_t  MicroBitTelemetryServiceUUID[];
+extern const uint8_t  MicroBitTelemetryServiceDataUUID[];
+
+/**
+  * The readings held by the telemetry characteristic.
+  */
+struct MicroBitTelemetrySnapshot
+{
+    uint16_t    sequence;
+    uint32_t    timestamp;
+    int16_t     moisture;
+    uint8_t     light;
+    int8_t      temperature;
+    uint8_t     flags;
+
+    /**
+      * Returns the readings packed in a single word, used to detect changes. The sequence
+      * number and the timestamp are left out.
+      */
+    int32_t key() const
+    {
+        return (int32_t)(((uint32_t)(uint8_t)moisture) | ((uint32_t)light << 8) | ((uint32_t)(uint8_t)temperature << 16) | ((uint32_t)flags << 24));
+    }
+};
+
+/**
+  * Encoding of a MicroBitTelemetrySnapshot, see MicroBitTelemetryService. The
+  * characteristic is not writable.
+  */
+struct MicroBitTelemetryEncoding
+{
+    static const int size = MICROBIT_TELEMETRY_PACKET_SIZE;
+
+    static void encode(const MicroBitTelemetrySnapshot &snapshot, uint8_t *buffer);
+
+    static int decode(const uint8_t *, int, MicroBitTelemetrySnapshot &)
+    {
+        return MICROBIT_NOT_SUPPORTED;
+    }
+};
+
+/**
+  * MicroBitNotifyPolicy applied to the readings of a snapshot.
+  */
+struct MicroBitTelemetryNotifyPolicy : public MicroBitNotifyPolicy
+{
+    MicroBitTelemetryNotifyPolicy() :
+        MicroBitNotifyPolicy(0, MICROBIT_TELEMETRY_SERVICE_MIN_INTERVAL, MICROBIT_TELEMETRY_SERVICE_MAX_SILENCE)
+    {
+    }
+
+    bool offer(const MicroBitTelemetrySnapshot &snapshot)
+    {
+        return MicroBitNotifyPolicy::offer(snapshot.key());
+    }
+};
+
+/**
+  * Class definition for the custom MicroBit Telemetry Service.
+  * Provides a BLE service that holds light, temperature, moisture and watering state
+  * together in a single characteristic value. The value is updated on every moisture or
+  * watering update, and notified when the notify policy lets it through.
+  *
+  * The value is little endian:
+  *
+  *  offset  size  field
+  *  0       2     sequence number, incremented on every notification
+  *  2       4     timestamp, ms since boot
+  *  6       2     moisture level (int16)
+  *  8       1     light level (uint8)
+  *  9       1     temperature (int8)
+  *  10      1     flags (MICROBIT_TELEMETRY_FLAG_*)
+  */
+class MicroBitTelemetryService : public MicroBitCharacteristicService<MicroBitTelemetrySnapshot, MicroBitTelemetryEncoding, MicroBitTelemetryNotifyPolicy>
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a representation of the TelemetryService
+      * @param _ble The instance of a BLE device that we're running on.
+      * @param _lightSensor An instance of MicroBitAmbientLightSensor to use as our light source.
+      * @param _thermometer An instance of MicroBitThermometer to use as our temperature source.
+      * @param _sensor An instance of MicroBitMoistureSensor to use as our moisture source.
+      * @param _actuator An instance of MicroBitWateringActuator used to read the watering status.
+      */
+    MicroBitTelemetryService(BLEDevice &_ble, MicroBitAmbientLightSensor &_lightSensor, MicroBitThermometer &_thermometer,
+                             MicroBitMoistureSensor &_sensor, MicroBitWateringActuator &_actuator);
+
+    /**
+     * Update callback, invoked once per update cycle.
+     */
+    void telemetryUpdate(MicroBitEvent e);
+
+    protected:
+
+    /**
+     * Counts the notifications, for the sequence number.
+     */
+    virtual void onNotify();
+
+    private:
+
+    /**
+     * Read all the sources.
+     *
+     * @return the current readings, with the sequence number of the next notification.
+     */
+    MicroBitTelemetrySnapshot read();
+
+    // Sources of the telemetry
+    MicroBitAmbientLightSensor  &lightSensor;
+    MicroBitThermometer         &thermometer;
+    MicroBitMoistureSensor      &sensor;
+    MicroBitWateringActuator    &actuator;
+
+    // Sequence number of the next notification
+    uint16_t            sequence;
+};
+
+
+#endif
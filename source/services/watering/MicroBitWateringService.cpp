@@ -31,7 +31,6 @@ DEALINGS IN THE SOFTWARE.
 #include "ble/UUID.h"
 #include "MicroBitEvent.h"
 
-#include "../../actuators/watering/MicroBitWateringActuator.h"
 #include "MicroBitWateringService.h"
 
 /**
@@ -41,30 +40,12 @@ DEALINGS IN THE SOFTWARE.
   * @param _actuator The instance of a MicroBitWateringActuator used to read watering status.
   */
 MicroBitWateringService::MicroBitWateringService(BLEDevice &_ble, MicroBitWateringActuator &_actuator) :
-        ble(_ble), actuator(_actuator)
+        MicroBitCharacteristicService<uint8_t, MicroBitLittleEndian<uint8_t>, MicroBitNotifyAlways>(_ble, MicroBitWateringServiceUUID, MicroBitWateringServiceDataUUID,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE, _actuator.isWatering()),
+        actuator(_actuator)
 {
-    // Create the data structures that represent each of our characteristics in Soft Device.
-    GattCharacteristic  wateringDataCharacteristic(MicroBitWateringServiceDataUUID, (uint8_t *)&wateringDataCharacteristicBuffer, 0,
-    sizeof(wateringDataCharacteristicBuffer), GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE);
-
-    // Initialise our characteristic values.
-    wateringDataCharacteristicBuffer = actuator.isWatering();
-
-    // Set default security requirements
-    wateringDataCharacteristic.requireSecurity(SecurityManager::MICROBIT_BLE_SECURITY_LEVEL);
-
-    GattCharacteristic *characteristics[] = {&wateringDataCharacteristic};
-    GattService         service(MicroBitWateringServiceUUID, characteristics, sizeof(characteristics) / sizeof(GattCharacteristic *));
-
-    ble.addService(service);
-
-    wateringDataCharacteristicHandle = wateringDataCharacteristic.getValueHandle();
-
-    ble.gattServer().write(wateringDataCharacteristicHandle,(uint8_t *)&wateringDataCharacteristicBuffer, sizeof(wateringDataCharacteristicBuffer));
-
-    ble.onDataWritten(this, &MicroBitWateringService::onDataWritten);
     if (EventModel::defaultEventBus)
-        EventModel::defaultEventBus->listen(MICROBIT_ID_WATERING_ACTUATOR, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE, this, &MicroBitWateringService::wateringUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        EventModel::defaultEventBus->listen(actuator.id, MICROBIT_WATERING_ACTUATOR_EVT_UPDATE, this, &MicroBitWateringService::wateringUpdate, MESSAGE_BUS_LISTENER_IMMEDIATE);
 }
 
 /**
@@ -72,31 +53,26 @@ MicroBitWateringService::MicroBitWateringService(BLEDevice &_ble, MicroBitWateri
   */
 void MicroBitWateringService::wateringUpdate(MicroBitEvent)
 {
-    if (ble.getGapState().connected)
-    {
-        wateringDataCharacteristicBuffer = actuator.isWatering();
-        ble.gattServer().notify(wateringDataCharacteristicHandle,(uint8_t *)&wateringDataCharacteristicBuffer, sizeof(wateringDataCharacteristicBuffer));
-    }
+    update(actuator.isWatering());
 }
 
 /**
-  * Callback. Invoked when any of our attributes are written via BLE.
+  * Fires the watering or stop request written by a peer.
   */
-void MicroBitWateringService::onDataWritten(const GattWriteCallbackParams *params)
+void MicroBitWateringService::onWrite(const uint8_t &value)
 {
-    if (params->handle == wateringDataCharacteristicHandle && params->len >= sizeof(wateringDataCharacteristicBuffer))
+    if (value)
     {
-        wateringDataCharacteristicBuffer = *((uint16_t *)params->data);
-        if(wateringDataCharacteristicBuffer)
-        {
-            // fire watering event
-            MicroBitEvent evt = MicroBitEvent(MICROBIT_ID_WATERING_SERVICE, WATERING_EVT_REQUESTED);
-            evt.fire();
-        }
-
-        wateringDataCharacteristicBuffer = actuator.isWatering();
-        ble.gattServer().write(wateringDataCharacteristicHandle,(uint8_t *)&wateringDataCharacteristicBuffer, sizeof(wateringDataCharacteristicBuffer));
+        // fire watering event
+        MicroBitEvent(MICROBIT_ID_WATERING_SERVICE, WATERING_EVT_REQUESTED);
     }
+    else
+    {
+        // fire stop event
+        MicroBitEvent(MICROBIT_ID_WATERING_SERVICE, WATERING_EVT_STOP_REQUESTED);
+    }
+
+    set(actuator.isWatering());
 }
 
 
@@ -30,10 +30,19 @@ DEALINGS IN THE SOFTWARE.
 #include "ble/BLE.h"
 #include "EventModel.h"
 
+#include "../characteristic/MicroBitCharacteristicService.h"
 #include "../../actuators/watering/MicroBitWateringActuator.h"
+#include "../../utils/services/MicroBitServiceRegistry.h"
 
 #define MICROBIT_ID_WATERING_SERVICE          1334
 #define WATERING_EVT_REQUESTED                42
+#define WATERING_EVT_STOP_REQUESTED           44
+
+// Attribute table bytes used by the service
+#define MICROBIT_WATERING_SERVICE_GATT_SIZE   (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(1, 1))
+
+// Write dispatcher handlers registered by the service
+#define MICROBIT_WATERING_SERVICE_WRITE_HANDLERS 1
 
 // UUIDs for our service and characteristics
 extern const uint8_t  MicroBitWateringServiceUUID[];
@@ -41,9 +50,10 @@ extern const uint8_t  MicroBitWateringServiceDataUUID[];
 
 /**
   * Class definition for the custom MicroBit Watering Service.
-  * Provides a BLE service to remotely read the watering activity performed by the micro:bit.
+  * Provides a BLE service to remotely read the watering activity performed by the micro:bit,
+  * and to start (non-zero write) or stop (zero write) a watering.
   */
-class MicroBitWateringService
+class MicroBitWateringService : public MicroBitCharacteristicService<uint8_t, MicroBitLittleEndian<uint8_t>, MicroBitNotifyAlways>
 {
     public:
 
@@ -59,26 +69,19 @@ class MicroBitWateringService
      * Watering update callback
      */
     void wateringUpdate(MicroBitEvent e);
-    
+
+    protected:
+
     /**
-      * Callback. Invoked when any of our attributes are written via BLE.
-      */
-    void onDataWritten(const GattWriteCallbackParams *params);
+     * Fires the watering or stop request written by a peer.
+     */
+    virtual void onWrite(const uint8_t &value);
 
     private:
 
-    // Bluetooth stack we're running on.
-    BLEDevice           	&ble;
-
     // Actuator used to read the watering process status
     MicroBitWateringActuator      &actuator;
-
-    // memory for our 8 bit watering characteristic.
-    int8_t             wateringDataCharacteristicBuffer;
-
-    // Handles to access each characteristic when they are held by Soft Device.
-    GattAttribute::Handle_t wateringDataCharacteristicHandle;
 };
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,254 @@
+#include "MicroBitConfig.h"
+#include "mbed.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitFiber.h"
+#include "EventModel.h"
+#include "MicroBitConfigStore.h"
+
+static_assert(PAGE_SIZE % sizeof(MicroBitConfigData) == 0 && sizeof(MicroBitConfigData) % 4 == 0, "MicroBitConfigData must divide the flash page in words");
+
+// Offset of the settings, after the header
+#define CONFIG_PAYLOAD_OFFSET       offsetof(MicroBitConfigData, reservoir)
+
+/**
+  * Constructor.
+  * Create a store holding the default settings.
+  *
+  * @param _flash the flash the settings are written with.
+  * @param _page the first of MICROBIT_CONFIG_STORE_PAGES consecutive pages the records are
+  *        written to, NULL for the ones at MICROBIT_CONFIG_STORE_PAGE_OFFSET.
+  */
+MicroBitConfigStore::MicroBitConfigStore(MicroBitFlash &_flash, uint32_t *_page) :
+    flash(_flash)
+{
+    this->id = MICROBIT_ID_CONFIG_STORE;
+    this->page = _page;
+    this->slot = 0;
+
+    if (page == NULL)
+    {
+#ifdef MICROBIT_SIM
+        // The simulation holds the last pages of the flash in RAM
+        page = sim_flash_page(MICROBIT_CONFIG_STORE_PAGE_OFFSET);
+#else
+        page = (uint32_t *)(PAGE_SIZE * (NRF_FICR->CODESIZE - MICROBIT_CONFIG_STORE_PAGE_OFFSET));
+#endif
+    }
+
+    memset(&data, 0, sizeof(data));
+
+    data.reservoir.volume = MICROBIT_RESERVOIR_CAPACITY;
+    data.reservoir.capacity = MICROBIT_RESERVOIR_CAPACITY;
+    data.reservoir.flowRate = MICROBIT_RESERVOIR_FLOW_RATE;
+    data.moistureTreshold = MICROBIT_CONFIG_MOISTURE_TRESHOLD;
+    data.moistureCurve = MICROBIT_MOISTURE_CURVE_LINEAR;
+    data.moistureDry = MICROBIT_MOISTURE_DRY_RAW;
+    data.moistureWet = MICROBIT_MOISTURE_WET_RAW;
+    data.moistureCompensation = MICROBIT_CONFIG_MOISTURE_COMPENSATION;
+
+    commitTime = 0;
+}
+
+/**
+  * Destructor. Stops the pending save, if any.
+  */
+MicroBitConfigStore::~MicroBitConfigStore()
+{
+    if (status & MICROBIT_CONFIG_STORE_ADDED_TO_TICK)
+        system_timer_remove_component(this);
+
+    if (EventModel::defaultEventBus)
+        EventModel::defaultEventBus->ignore(MICROBIT_ID_CONFIG_STORE, MICROBIT_CONFIG_STORE_EVT_COMMIT, this, &MicroBitConfigStore::onCommit);
+}
+
+/**
+  * Load the saved settings, and start saving the changes.
+  * Must be called once the message bus is available.
+  *
+  * @return MICROBIT_OK if saved settings were loaded, MICROBIT_NO_DATA if the defaults are used.
+  */
+int MicroBitConfigStore::load()
+{
+    int newest = -1;
+
+    // The newest record is the one with the highest sequence number, with wrapping: the ring
+    // holds fewer records than half the sequence range
+    for (int i = 0; i < MICROBIT_CONFIG_STORE_SLOTS; i++)
+        if (isValid(*record(i)) && (newest < 0 || (int8_t)(record(i)->sequence - record(newest)->sequence) > 0))
+            newest = i;
+
+    int result = MICROBIT_NO_DATA;
+
+    if (newest >= 0)
+    {
+        memcpy(&data, record(newest), sizeof(data));
+        slot = (newest + 1) % MICROBIT_CONFIG_STORE_SLOTS;
+        result = MICROBIT_OK;
+    }
+
+    if (EventModel::defaultEventBus)
+        EventModel::defaultEventBus->listen(MICROBIT_ID_CONFIG_STORE, MICROBIT_CONFIG_STORE_EVT_COMMIT, this, &MicroBitConfigStore::onCommit);
+
+    return result;
+}
+
+/**
+  * Returns the record in a slot.
+  */
+MicroBitConfigData *MicroBitConfigStore::record(int slot)
+{
+    return (MicroBitConfigData *)page + slot;
+}
+
+/**
+  * Returns true if a record is of this layout version, with a valid checksum.
+  */
+bool MicroBitConfigStore::isValid(const MicroBitConfigData &saved)
+{
+    return saved.version == MICROBIT_CONFIG_STORE_VERSION && saved.checksum == checksum(saved);
+}
+
+/**
+  * Returns true if a slot was not written since its page was erased.
+  */
+bool MicroBitConfigStore::isErased(int slot)
+{
+    const uint32_t *word = (const uint32_t *)record(slot);
+
+    for (int i = 0; i < (int)(sizeof(MicroBitConfigData) / 4); i++)
+        if (word[i] != 0xFFFFFFFF)
+            return false;
+
+    return true;
+}
+
+/**
+  * Returns the current settings.
+  */
+const MicroBitConfigData &MicroBitConfigStore::get()
+{
+    return data;
+}
+
+/**
+  * Change the settings. They are saved after MICROBIT_CONFIG_STORE_COMMIT_DELAY, if they differ
+  * from the current ones.
+  *
+  * @param newData the new settings.
+  */
+void MicroBitConfigStore::update(const MicroBitConfigData &newData)
+{
+    if (memcmp((uint8_t *)&data + CONFIG_PAYLOAD_OFFSET, (uint8_t *)&newData + CONFIG_PAYLOAD_OFFSET, sizeof(data) - CONFIG_PAYLOAD_OFFSET) == 0)
+        return;
+
+    memcpy((uint8_t *)&data + CONFIG_PAYLOAD_OFFSET, (uint8_t *)&newData + CONFIG_PAYLOAD_OFFSET, sizeof(data) - CONFIG_PAYLOAD_OFFSET);
+
+    scheduleCommit();
+}
+
+/**
+  * Save the settings after MICROBIT_CONFIG_STORE_COMMIT_DELAY, unless a save is already pending.
+  */
+void MicroBitConfigStore::scheduleCommit()
+{
+    // Later changes join the pending save. systemTick() reads the time from the timer
+    // interrupt: set it in one go.
+    if (!(status & MICROBIT_CONFIG_STORE_DIRTY))
+    {
+        __disable_irq();
+        commitTime = system_timer_current_time() + MICROBIT_CONFIG_STORE_COMMIT_DELAY;
+        status |= MICROBIT_CONFIG_STORE_DIRTY;
+        __enable_irq();
+    }
+
+    // Retried with the next change if the system timer has no room left
+    if (!(status & MICROBIT_CONFIG_STORE_ADDED_TO_TICK) && system_timer_add_component(this) == MICROBIT_OK)
+        status |= MICROBIT_CONFIG_STORE_ADDED_TO_TICK;
+}
+
+/**
+  * Save the pending changes now.
+  */
+void MicroBitConfigStore::commit()
+{
+    if (status & MICROBIT_CONFIG_STORE_DIRTY)
+        onCommit(MicroBitEvent());
+}
+
+/**
+  * Periodic callback from MicroBit system timer: asks for the save once the delay is over.
+  * The save itself is done by the listener, in a fiber.
+  */
+void MicroBitConfigStore::systemTick()
+{
+    if ((status & MICROBIT_CONFIG_STORE_DIRTY) && system_timer_current_time() >= commitTime)
+    {
+        // Wait for the save to be done before asking again
+        commitTime = (uint64_t)-1;
+        MicroBitEvent(MICROBIT_ID_CONFIG_STORE, MICROBIT_CONFIG_STORE_EVT_COMMIT);
+    }
+}
+
+#ifdef MICROBIT_SIM
+/**
+  * Returns the system time, in ms, the pending save is asked for at, (uint64_t)-1 if none.
+  */
+uint64_t MicroBitConfigStore::getWakeupTime()
+{
+    return (status & MICROBIT_CONFIG_STORE_DIRTY) ? commitTime : (uint64_t)-1;
+}
+#endif
+
+/**
+  * Returns the checksum of the settings, excluding the header.
+  *
+  * @param data the saved settings.
+  */
+uint16_t MicroBitConfigStore::checksum(const MicroBitConfigData &data)
+{
+    // Fletcher-16
+    const uint8_t *b = (const uint8_t *)&data + CONFIG_PAYLOAD_OFFSET;
+    uint16_t s1 = 0;
+    uint16_t s2 = 0;
+
+    for (int i = 0; i < (int)(sizeof(data) - CONFIG_PAYLOAD_OFFSET); i++)
+    {
+        s1 = (s1 + b[i]) % 255;
+        s2 = (s2 + s1) % 255;
+    }
+
+    return (s2 << 8) | s1;
+}
+
+/**
+  * Write the settings. Listener of MICROBIT_CONFIG_STORE_EVT_COMMIT.
+  */
+void MicroBitConfigStore::onCommit(MicroBitEvent)
+{
+    if (!(status & MICROBIT_CONFIG_STORE_DIRTY))
+        return;
+
+    // Changes made during the write start a new pending save
+    status &= ~MICROBIT_CONFIG_STORE_DIRTY;
+
+    data.version = MICROBIT_CONFIG_STORE_VERSION;
+    data.sequence++;
+    data.checksum = checksum(data);
+
+    // A slot left written by a save cut short is skipped. A page is erased when the ring
+    // comes back to it, the other one still holding the newest records.
+    while (!isErased(slot) && slot % MICROBIT_CONFIG_STORE_PAGE_SLOTS != 0)
+        slot = (slot + 1) % MICROBIT_CONFIG_STORE_SLOTS;
+
+    if (!isErased(slot))
+        flash.erase_page((uint32_t *)record(slot));
+
+    // Retry later, in the next slot, unless the save reads back intact
+    MicroBitConfigData save = data;
+    MicroBitConfigData *written = record(slot);
+
+    slot = (slot + 1) % MICROBIT_CONFIG_STORE_SLOTS;
+
+    if (flash.flash_write(written, &save, sizeof(save)) != MICROBIT_OK || memcmp(written, &save, sizeof(save)) != 0)
+        scheduleCommit();
+}
@@ -0,0 +1,189 @@
+#ifndef MICROBIT_CONFIG_STORE_H
+#define MICROBIT_CONFIG_STORE_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "MicroBitFlash.h"
+#include "MicroBitEvent.h"
+
+#include "../../actuators/watering/MicroBitReservoir.h"
+#include "../../sensors/moisture/MicroBitMoistureCalibration.h"
+#include "../../SmartVaseConfig.h"
+
+#define MICROBIT_ID_CONFIG_STORE                1237
+#define MICROBIT_CONFIG_STORE_EVT_COMMIT        1
+
+// Layout version of MicroBitConfigData. Saved data of another version is ignored.
+#define MICROBIT_CONFIG_STORE_VERSION           1
+
+// Time between the first change and the write that saves it, in ms
+#define MICROBIT_CONFIG_STORE_COMMIT_DELAY      10000
+
+// Flash pages the saves are spread over, and offset of the first one from the end of the
+// flash, below the pages microbit-dal keeps there (MicroBitStorage is at 17)
+#define MICROBIT_CONFIG_STORE_PAGES             2
+#define MICROBIT_CONFIG_STORE_PAGE_OFFSET       22
+
+// Default moisture threshold, in % of volumetric water content
+#define MICROBIT_CONFIG_MOISTURE_TRESHOLD       10
+
+// Default temperature compensation of the moisture readings
+#define MICROBIT_CONFIG_MOISTURE_COMPENSATION   SMART_VASE_MOISTURE_COMPENSATION
+
+// Status flags
+#define MICROBIT_CONFIG_STORE_ADDED_TO_TICK     0x01
+#define MICROBIT_CONFIG_STORE_DIRTY             0x02
+
+/**
+  * Settings and state kept across resets, saved as one record. Its size must divide the
+  * flash page.
+  */
+struct MicroBitConfigData
+{
+    // Filled in by the store: layout version, save count and checksum of the rest
+    uint8_t                 version;
+    uint8_t                 sequence;
+    uint16_t                checksum;
+
+    MicroBitReservoirState  reservoir;
+    uint8_t                 moistureTreshold;
+
+    // Calibration of the zone 0 probe, see MicroBitMoistureCalibration
+    uint8_t                 moistureCurve;
+    uint16_t                moistureDry;
+    uint16_t                moistureWet;
+
+    // Temperature compensation of every probe, see MicroBitMoistureSensor::setTemperatureCompensation
+    int8_t                  moistureCompensation;
+
+    uint8_t                 reserved[1];
+};
+
+// Records a page holds, and in the whole ring
+#define MICROBIT_CONFIG_STORE_PAGE_SLOTS        (PAGE_SIZE / (int)sizeof(MicroBitConfigData))
+#define MICROBIT_CONFIG_STORE_SLOTS             (MICROBIT_CONFIG_STORE_PAGES * MICROBIT_CONFIG_STORE_PAGE_SLOTS)
+
+/**
+  * Class definition for MicroBitConfigStore.
+  *
+  * Keeps the settings in RAM and saves them in flash:
+  * - only when they changed, and batched: all the changes made in the
+  *   MICROBIT_CONFIG_STORE_COMMIT_DELAY following the first one are saved together;
+  * - with a layout version and a checksum, so that a save of another firmware or a corrupted
+  *   one is not used;
+  * - as a record in the next slot of a ring over MICROBIT_CONFIG_STORE_PAGES dedicated pages,
+  *   with a sequence number. A page is only erased when the ring comes back to it, once every
+  *   MICROBIT_CONFIG_STORE_PAGE_SLOTS saves, so the wear is spread over all the slots. The
+  *   other page keeps the newest records meanwhile, so a reset during a save or an erase
+  *   leaves the previous save. A record that does not read back intact is retried in the next
+  *   slot after the delay;
+  * - from a fiber, as flash writes block the caller.
+  *
+  * At startup the newest valid record is read, or the defaults are used.
+  */
+class MicroBitConfigStore : public MicroBitComponent
+{
+    public:
+
+    /**
+      * Constructor.
+      * Create a store holding the default settings.
+      *
+      * @param _flash the flash the settings are written with.
+      * @param _page the first of MICROBIT_CONFIG_STORE_PAGES consecutive pages the records are
+      *        written to, NULL for the ones at MICROBIT_CONFIG_STORE_PAGE_OFFSET.
+      */
+    MicroBitConfigStore(MicroBitFlash &_flash, uint32_t *_page = NULL);
+
+    /**
+      * Destructor. Stops the pending save, if any.
+      */
+    ~MicroBitConfigStore();
+
+    /**
+      * Load the saved settings, and start saving the changes.
+      * Must be called once the message bus is available.
+      *
+      * @return MICROBIT_OK if saved settings were loaded, MICROBIT_NO_DATA if the defaults are used.
+      */
+    int load();
+
+    /**
+      * Returns the current settings.
+      */
+    const MicroBitConfigData &get();
+
+    /**
+      * Change the settings. They are saved after MICROBIT_CONFIG_STORE_COMMIT_DELAY, if they differ
+      * from the current ones.
+      *
+      * @param newData the new settings.
+      */
+    void update(const MicroBitConfigData &newData);
+
+    /**
+      * Save the pending changes now.
+      */
+    void commit();
+
+    /**
+      * Periodic callback from MicroBit system timer: asks for the save once the delay is over.
+      */
+    virtual void systemTick();
+
+#ifdef MICROBIT_SIM
+    /**
+      * Returns the system time, in ms, the pending save is asked for at, (uint64_t)-1 if none.
+      */
+    virtual uint64_t getWakeupTime();
+#endif
+
+    private:
+
+    /**
+      * Returns the checksum of the settings, excluding the header.
+      *
+      * @param data the saved settings.
+      */
+    static uint16_t checksum(const MicroBitConfigData &data);
+
+    /**
+      * Save the settings after MICROBIT_CONFIG_STORE_COMMIT_DELAY, unless a save is already pending.
+      */
+    void scheduleCommit();
+
+    /**
+      * Returns the record in a slot.
+      */
+    MicroBitConfigData *record(int slot);
+
+    /**
+      * Returns true if a record is of this layout version, with a valid checksum.
+      */
+    static bool isValid(const MicroBitConfigData &saved);
+
+    /**
+      * Returns true if a slot was not written since its page was erased.
+      */
+    bool isErased(int slot);
+
+    /**
+      * Write the settings. Listener of MICROBIT_CONFIG_STORE_EVT_COMMIT.
+      */
+    void onCommit(MicroBitEvent e);
+
+    MicroBitFlash           &flash;
+
+    // First page of the ring
+    uint32_t                *page;
+
+    // Slot the next save is written to
+    int                     slot;
+
+    MicroBitConfigData      data;
+
+    // Time the pending changes are saved at, in ms of system time
+    uint64_t                commitTime;
+};
+
+#endif
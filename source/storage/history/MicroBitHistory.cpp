@@ -0,0 +1,168 @@
+#include "MicroBitHistory.h"
+
+/**
+  * Returns true if the delta between two readings fits a record.
+  */
+static bool fitsDelta(int delta)
+{
+    return delta >= -128 && delta <= 127;
+}
+
+/**
+  * Constructor.
+  * Create an empty history.
+  */
+MicroBitHistory::MicroBitHistory()
+{
+    total = 0;
+    count = 0;
+    memset(&base, 0, sizeof(base));
+    memset(&last, 0, sizeof(last));
+}
+
+/**
+  * Append a sample, overwriting the oldest record if the history is full.
+  *
+  * @param sample the readings to store. Samples must be appended in time order.
+  */
+void MicroBitHistory::record(const MicroBitHistorySample &sample)
+{
+    // The first record ever starts from its own state.
+    if (total == 0)
+    {
+        base = sample;
+        base.flags = 0;
+        last = base;
+    }
+
+    // Make room: the base moves on to the state after the record being dropped.
+    if (count == MICROBIT_HISTORY_CAPACITY)
+    {
+        decode(slot(first()), base);
+        count--;
+    }
+
+    uint32_t dt = sample.time - last.time;
+    int dm = sample.moisture - last.moisture;
+    int dl = sample.light - last.light;
+    int dt8 = sample.temperature - last.temperature;
+
+    uint8_t *r = slot(total);
+    uint8_t flags = sample.flags & ~MICROBIT_HISTORY_FLAG_KEYFRAME;
+
+    if (dt > 0xFFFF)
+        dt = 0xFFFF;
+
+    r[0] = dt & 0xFF;
+    r[1] = dt >> 8;
+
+    if (fitsDelta(dm) && fitsDelta(dl) && fitsDelta(dt8))
+    {
+        r[2] = (uint8_t)(int8_t)dm;
+        r[3] = (uint8_t)(int8_t)dl;
+        r[4] = (uint8_t)(int8_t)dt8;
+    }
+    else
+    {
+        r[2] = sample.moisture;
+        r[3] = sample.light;
+        r[4] = (uint8_t)sample.temperature;
+        flags |= MICROBIT_HISTORY_FLAG_KEYFRAME;
+    }
+
+    r[5] = flags;
+
+    // Track the decoded state, so that a saturated time delta is accounted the same way a reader sees it.
+    decode(r, last);
+
+    total++;
+    count++;
+}
+
+/**
+  * Sequence number of the oldest record kept.
+  */
+uint32_t MicroBitHistory::first()
+{
+    return total - count;
+}
+
+/**
+  * Sequence number the next record will get.
+  */
+uint32_t MicroBitHistory::end()
+{
+    return total;
+}
+
+/**
+  * Compute the absolute state right before a record.
+  *
+  * @param seq the sequence number of the record, between first() and end().
+  * @param sample the state before that record.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if seq is not kept.
+  */
+int MicroBitHistory::stateBefore(uint32_t seq, MicroBitHistorySample &sample)
+{
+    if (seq < first() || seq > end())
+        return MICROBIT_INVALID_PARAMETER;
+
+    sample = base;
+
+    for (uint32_t s = first(); s < seq; s++)
+        decode(slot(s), sample);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Copy an encoded record.
+  *
+  * @param seq the sequence number of the record.
+  * @param buffer at least MICROBIT_HISTORY_RECORD_SIZE bytes to copy the record into.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if seq is not kept.
+  */
+int MicroBitHistory::read(uint32_t seq, uint8_t *buffer)
+{
+    if (seq < first() || seq >= end())
+        return MICROBIT_INVALID_PARAMETER;
+
+    memcpy(buffer, slot(seq), MICROBIT_HISTORY_RECORD_SIZE);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Apply an encoded record to the previous state.
+  *
+  * @param record the encoded record.
+  * @param sample the previous state, updated to the state after the record.
+  */
+void MicroBitHistory::decode(const uint8_t *record, MicroBitHistorySample &sample)
+{
+    sample.time += record[0] | (record[1] << 8);
+    sample.flags = record[5];
+
+    if (record[5] & MICROBIT_HISTORY_FLAG_KEYFRAME)
+    {
+        sample.moisture = record[2];
+        sample.light = record[3];
+        sample.temperature = (int8_t)record[4];
+    }
+    else
+    {
+        sample.moisture += (int8_t)record[2];
+        sample.light += (int8_t)record[3];
+        sample.temperature += (int8_t)record[4];
+    }
+}
+
+/**
+  * Ring slot of a record.
+  */
+uint8_t *MicroBitHistory::slot(uint32_t seq)
+{
+    return records[seq % MICROBIT_HISTORY_CAPACITY];
+}
@@ -0,0 +1,124 @@
+#ifndef MICROBIT_HISTORY_H
+#define MICROBIT_HISTORY_H
+
+#include "MicroBitConfig.h"
+
+// Number of records kept in RAM
+#define MICROBIT_HISTORY_CAPACITY               128
+
+// Size of an encoded record, in bytes
+#define MICROBIT_HISTORY_RECORD_SIZE            6
+
+// Default time between two records, in ms
+#define MICROBIT_HISTORY_PERIOD                 300000
+
+// Record flags
+#define MICROBIT_HISTORY_FLAG_KEYFRAME          0x01
+#define MICROBIT_HISTORY_FLAG_WATERING          0x02
+// The temperature was not known yet: its field is not a reading
+#define MICROBIT_HISTORY_FLAG_NO_TEMPERATURE    0x04
+
+/**
+  * Decoded content of a history record.
+  */
+struct MicroBitHistorySample
+{
+    // Seconds since boot
+    uint32_t    time;
+    uint8_t     moisture;
+    uint8_t     light;
+    int8_t      temperature;
+    uint8_t     flags;
+};
+
+/**
+  * Class definition for MicroBitHistory.
+  *
+  * A fixed size RAM ring of readings. Each record is MICROBIT_HISTORY_RECORD_SIZE bytes:
+  *
+  *  offset  size  field
+  *  0       2     seconds since the previous record (uint16, little endian, saturated)
+  *  2       1     moisture
+  *  3       1     light
+  *  4       1     temperature
+  *  5       1     flags (MICROBIT_HISTORY_FLAG_*)
+  *
+  * Readings are stored as int8 deltas from the previous record. When a delta does not fit,
+  * the record is a keyframe (MICROBIT_HISTORY_FLAG_KEYFRAME) and holds the absolute readings.
+  *
+  * Records are decoded starting from the base sample, which is the state right before the
+  * oldest record kept; it is advanced every time the oldest record is overwritten.
+  *
+  * Every record gets a sequence number, that keeps increasing across overwrites, so that a
+  * reader can ask for the records it has not seen yet.
+  */
+class MicroBitHistory
+{
+    uint8_t                 records[MICROBIT_HISTORY_CAPACITY][MICROBIT_HISTORY_RECORD_SIZE];
+    uint32_t                total;
+    uint16_t                count;
+    MicroBitHistorySample   base;
+    MicroBitHistorySample   last;
+
+    public:
+
+    /**
+      * Constructor.
+      * Create an empty history.
+      */
+    MicroBitHistory();
+
+    /**
+      * Append a sample, overwriting the oldest record if the history is full.
+      *
+      * @param sample the readings to store. Samples must be appended in time order.
+      */
+    void record(const MicroBitHistorySample &sample);
+
+    /**
+      * Sequence number of the oldest record kept.
+      */
+    uint32_t first();
+
+    /**
+      * Sequence number the next record will get.
+      */
+    uint32_t end();
+
+    /**
+      * Compute the absolute state right before a record.
+      *
+      * @param seq the sequence number of the record, between first() and end().
+      * @param sample the state before that record.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if seq is not kept.
+      */
+    int stateBefore(uint32_t seq, MicroBitHistorySample &sample);
+
+    /**
+      * Copy an encoded record.
+      *
+      * @param seq the sequence number of the record.
+      * @param buffer at least MICROBIT_HISTORY_RECORD_SIZE bytes to copy the record into.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if seq is not kept.
+      */
+    int read(uint32_t seq, uint8_t *buffer);
+
+    /**
+      * Apply an encoded record to the previous state.
+      *
+      * @param record the encoded record.
+      * @param sample the previous state, updated to the state after the record.
+      */
+    static void decode(const uint8_t *record, MicroBitHistorySample &sample);
+
+    private:
+
+    /**
+      * Ring slot of a record.
+      */
+    uint8_t *slot(uint32_t seq);
+};
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef MICROBIT_FILTERS_H
+#define MICROBIT_FILTERS_H
+
+#include "MicroBitConfig.h"
+
+/**
+  * Fixed-point filter stages for sensor readings.
+  *
+  * Every stage is a small value type with an apply() method that takes a reading and
+  * returns the filtered one, and a reset() method. Stages use integer arithmetic only
+  * (no division, no floating point) and a fixed amount of memory, so they run in bounded
+  * time on the Cortex-M0. Stages are combined with MicroBitFilterChain.
+  */
+
+/**
+  * Exponential moving average with a smoothing factor of 1 / 2^SHIFT.
+  *
+  * The accumulator keeps SHIFT fractional bits, so small variations are not lost
+  * to rounding.
+  */
+template <int SHIFT>
+class MicroBitEmaFilter
+{
+    static_assert(SHIFT > 0 && SHIFT < 16, "MicroBitEmaFilter SHIFT must be in [1, 15]");
+
+    int32_t     accumulator;
+    bool        primed;
+
+    public:
+
+    MicroBitEmaFilter() : accumulator(0), primed(false) {}
+
+    /**
+      * Feed a reading to the filter.
+      *
+      * @param value the new reading.
+      *
+      * @return the filtered value.
+      */
+    int32_t apply(int32_t value)
+    {
+        // Start from the first reading rather than ramping up from zero.
+        if (!primed)
+        {
+            accumulator = value << SHIFT;
+            primed = true;
+        }
+        else
+        {
+            accumulator += value - (accumulator >> SHIFT);
+        }
+
+        return (accumulator + (1 << (SHIFT - 1))) >> SHIFT;
+    }
+
+    void reset()
+    {
+        primed = false;
+    }
+};
+
+/**
+  * Median of the last K readings. Removes isolated spikes.
+  */
+template <int K>
+class MicroBitMedianFilter
+{
+    static_assert(K > 0 && (K & 1) && K <= 15, "MicroBitMedianFilter K must be odd and at most 15");
+
+    int32_t     window[K];
+    uint8_t     next;
+    uint8_t     count;
+
+    public:
+
+    MicroBitMedianFilter() : next(0), count(0) {}
+
+    /**
+      * Feed a reading to the filter.
+      *
+      * @param value the new reading.
+      *
+      * @return the median of the last K readings (or of all readings seen so far, if fewer).
+      */
+    int32_t apply(int32_t value)
+    {
+        window[next] = value;
+        next = next + 1 == K ? 0 : next + 1;
+
+        if (count < K)
+            count++;
+
+        // Insertion sort into a scratch copy; K is small and fixed.
+        int32_t sorted[K];
+
+        for (int i = 0; i < count; i++)
+        {
+            int j = i;
+
+            for (; j > 0 && sorted[j - 1] > window[i]; j--)
+                sorted[j] = sorted[j - 1];
+
+            sorted[j] = window[i];
+        }
+
+        return sorted[count >> 1];
+    }
+
+    void reset()
+    {
+        next = 0;
+        count = 0;
+    }
+};
+
+/**
+  * Deadband: the output only follows the input once it moves by more than BAND away
+  * from the last output. Stops small oscillations around a value from propagating.
+  */
+template <int BAND>
+class MicroBitDeadbandFilter
+{
+    static_assert(BAND >= 0, "MicroBitDeadbandFilter BAND must not be negative");
+
+    int32_t     output;
+    bool        primed;
+
+    public:
+
+    MicroBitDeadbandFilter() : output(0), primed(false) {}
+
+    /**
+      * Feed a reading to the filter.
+      *
+      * @param value the new reading.
+      *
+      * @return the last output, or value if it moved outside the band.
+      */
+    int32_t apply(int32_t value)
+    {
+        if (!primed || value > output + BAND || value < output - BAND)
+        {
+            output = value;
+            primed = true;
+        }
+
+        return output;
+    }
+
+    void reset()
+    {
+        primed = false;
+    }
+};
+
+/**
+  * Runs a reading through FIRST, then through SECOND.
+  * Chains nest, so any number of stages can be combined.
+  */
+template <class FIRST, class SECOND>
+class MicroBitFilterChain
+{
+    FIRST       first;
+    SECOND      second;
+
+    public:
+
+    /**
+      * Feed a reading to the chain.
+      *
+      * @param value the new reading.
+      *
+      * @return the output of the last stage.
+      */
+    int32_t apply(int32_t value)
+    {
+        return second.apply(first.apply(value));
+    }
+
+    void reset()
+    {
+        first.reset();
+        second.reset();
+    }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "MicroBitConfig.h"
+#include "MicroBitFiber.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitNotifyFlusher.h"
+
+MicroBitNotifyFlusher MicroBitNotifyFlusher::instance;
+
+/**
+  * Constructor. The only instance is created statically.
+  */
+MicroBitNotifyFlusher::MicroBitNotifyFlusher()
+{
+    count = 0;
+}
+
+/**
+  * Call a notifier back once a delay has elapsed. A notifier already waiting keeps its time.
+  *
+  * @param notifier the object holding the notification back.
+  * @param delay the time before the notification is due, in ms.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_NO_RESOURCES if there are already
+  *         MICROBIT_NOTIFY_FLUSHER_SLOTS notifiers waiting, or no room for the idle callback.
+  */
+int MicroBitNotifyFlusher::defer(MicroBitDeferredNotifier *notifier, uint32_t delay)
+{
+    MicroBitNotifyFlusher &flusher = instance;
+
+    for (int i = 0; i < flusher.count; i++)
+        if (flusher.notifiers[i] == notifier)
+            return MICROBIT_OK;
+
+    if (flusher.count == MICROBIT_NOTIFY_FLUSHER_SLOTS)
+        return MICROBIT_NO_RESOURCES;
+
+    // Register for the idle callbacks on first use, and keep them: they cost nothing while
+    // no notifier waits
+    if (!(flusher.status & MICROBIT_NOTIFY_FLUSHER_ADDED_TO_IDLE))
+    {
+        if (fiber_add_idle_component(&flusher) != MICROBIT_OK)
+            return MICROBIT_NO_RESOURCES;
+
+        flusher.status |= MICROBIT_NOTIFY_FLUSHER_ADDED_TO_IDLE;
+    }
+
+    flusher.notifiers[flusher.count] = notifier;
+    flusher.due[flusher.count] = system_timer_current_time() + delay;
+    flusher.count++;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Periodic callback from MicroBit idle thread: calls back the notifiers that are due.
+  */
+void MicroBitNotifyFlusher::idleTick()
+{
+    uint64_t now = system_timer_current_time();
+    int i = 0;
+
+    // A notifier may defer another one from its callback: it is appended, and checked too
+    while (i < count)
+    {
+        if (due[i] > now)
+        {
+            i++;
+            continue;
+        }
+
+        int32_t delay = notifiers[i]->flushDeferred();
+
+        if (delay >= 0)
+        {
+            due[i] = now + delay;
+            i++;
+        }
+        else
+        {
+            count--;
+            notifiers[i] = notifiers[count];
+            due[i] = due[count];
+        }
+    }
+}
+
+#ifdef MICROBIT_SIM
+/**
+  * Returns the system time, in ms, of the earliest notification due, (uint64_t)-1 if none.
+  */
+uint64_t MicroBitNotifyFlusher::getWakeupTime()
+{
+    uint64_t wakeup = (uint64_t)-1;
+
+    for (int i = 0; i < count; i++)
+        if (due[i] < wakeup)
+            wakeup = due[i];
+
+    return wakeup;
+}
+#endif
@@ -0,0 +1,78 @@
+#ifndef MICROBIT_NOTIFY_FLUSHER_H
+#define MICROBIT_NOTIFY_FLUSHER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+
+// Number of notifiers that can wait at the same time
+#define MICROBIT_NOTIFY_FLUSHER_SLOTS           8
+
+// Status flags
+#define MICROBIT_NOTIFY_FLUSHER_ADDED_TO_IDLE   0x02
+
+/**
+  * Interface of the objects that hold a notification back, e.g. the coalesced value of a
+  * MicroBitNotifyPolicy.
+  */
+class MicroBitDeferredNotifier
+{
+    public:
+
+    /**
+      * Callback. Invoked by MicroBitNotifyFlusher once the notification held back is due.
+      *
+      * @return the time left before it is due, in ms, or -1 once there is nothing left to notify.
+      */
+    virtual int32_t flushDeferred() = 0;
+};
+
+/**
+  * Class definition for the MicroBitNotifyFlusher.
+  *
+  * A single idle component that calls back the notifiers with a notification held back,
+  * when it is due. Holding a value back costs a slot in a table, instead of a fiber, and the
+  * services take a single idle component between them.
+  */
+class MicroBitNotifyFlusher : public MicroBitComponent
+{
+    public:
+
+    /**
+      * Call a notifier back once a delay has elapsed. A notifier already waiting keeps its time.
+      *
+      * @param notifier the object holding the notification back.
+      * @param delay the time before the notification is due, in ms.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_NO_RESOURCES if there are already
+      *         MICROBIT_NOTIFY_FLUSHER_SLOTS notifiers waiting, or no room for the idle callback.
+      */
+    static int defer(MicroBitDeferredNotifier *notifier, uint32_t delay);
+
+    /**
+      * Periodic callback from MicroBit idle thread: calls back the notifiers that are due.
+      */
+    virtual void idleTick();
+
+#ifdef MICROBIT_SIM
+    /**
+      * Returns the system time, in ms, of the earliest notification due, (uint64_t)-1 if none.
+      */
+    virtual uint64_t getWakeupTime();
+#endif
+
+    private:
+
+    /**
+      * Constructor. The only instance is created statically.
+      */
+    MicroBitNotifyFlusher();
+
+    // Notifiers waiting, and the system time they are due at, in ms
+    MicroBitDeferredNotifier    *notifiers[MICROBIT_NOTIFY_FLUSHER_SLOTS];
+    uint64_t                    due[MICROBIT_NOTIFY_FLUSHER_SLOTS];
+    uint8_t                     count;
+
+    static MicroBitNotifyFlusher instance;
+};
+
+#endif
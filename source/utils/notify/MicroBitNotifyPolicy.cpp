@@ -0,0 +1,113 @@
+#include "MicroBitSystemTimer.h"
+#include "MicroBitNotifyPolicy.h"
+
+/**
+  * Constructor.
+  *
+  * @param deadband the change (exclusive) under which a value is not notified.
+  * @param minInterval the minimum time between two notifications, in ms.
+  * @param maxSilence the time after which a value is notified even if unchanged, in ms. 0 disables it.
+  */
+MicroBitNotifyPolicy::MicroBitNotifyPolicy(int32_t deadband, uint32_t minInterval, uint32_t maxSilence)
+{
+    configure(deadband, minInterval, maxSilence);
+    reset();
+}
+
+/**
+  * Offer the current value of the characteristic.
+  *
+  * @param value the current value.
+  *
+  * @return true if the value must be notified now. The value is then recorded as notified.
+  */
+bool MicroBitNotifyPolicy::offer(int32_t value)
+{
+    uint64_t now = system_timer_current_time();
+
+    if (primed)
+    {
+        bool changed = value > lastValue + deadband || value < lastValue - deadband;
+        bool silent = maxSilence && now - lastNotify >= maxSilence;
+
+        // Back within the deadband: a coalesced value is no longer worth sending
+        if (!changed && !silent)
+        {
+            pending = false;
+            return false;
+        }
+
+        // Too early: remember that something is waiting and send the latest value later.
+        if (now - lastNotify < minInterval)
+        {
+            pending = true;
+            pendingValue = value;
+            return false;
+        }
+    }
+
+    lastValue = value;
+    lastNotify = now;
+    primed = true;
+    pending = false;
+
+    return true;
+}
+
+/**
+  * Returns the time left before the coalesced value can be notified, in ms, or -1 if
+  * no value is waiting.
+  */
+int32_t MicroBitNotifyPolicy::pendingDelay()
+{
+    if (!pending)
+        return -1;
+
+    uint64_t elapsed = system_timer_current_time() - lastNotify;
+
+    return elapsed >= minInterval ? 0 : (int32_t)(minInterval - elapsed);
+}
+
+/**
+  * Take the coalesced value, once the minimum interval has elapsed.
+  *
+  * @return true if the last offered value must be notified now. It is then recorded as notified.
+  */
+bool MicroBitNotifyPolicy::flush()
+{
+    if (pendingDelay() != 0)
+        return false;
+
+    lastValue = pendingValue;
+    lastNotify = system_timer_current_time();
+    pending = false;
+
+    return true;
+}
+
+/**
+  * Forget the last notified value, so the next offered value is notified immediately.
+  * Used when the peer disconnects.
+  */
+void MicroBitNotifyPolicy::reset()
+{
+    lastValue = 0;
+    pendingValue = 0;
+    lastNotify = 0;
+    primed = false;
+    pending = false;
+}
+
+/**
+  * Change the policy parameters.
+  *
+  * @param deadband the change (exclusive) under which a value is not notified.
+  * @param minInterval the minimum time between two notifications, in ms.
+  * @param maxSilence the time after which a value is notified even if unchanged, in ms. 0 disables it.
+  */
+void MicroBitNotifyPolicy::configure(int32_t deadband, uint32_t minInterval, uint32_t maxSilence)
+{
+    this->deadband = deadband;
+    this->minInterval = minInterval;
+    this->maxSilence = maxSilence;
+}
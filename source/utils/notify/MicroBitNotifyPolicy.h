@@ -0,0 +1,78 @@
+#ifndef MICROBIT_NOTIFY_POLICY_H
+#define MICROBIT_NOTIFY_POLICY_H
+
+#include "MicroBitConfig.h"
+
+/**
+  * Class definition for a MicroBitNotifyPolicy.
+  *
+  * Decides when a characteristic value is worth a BLE notification:
+  * - only when it moved by more than the deadband since the last notified value,
+  *   or when nothing was notified for maxSilence ms (a keep-alive);
+  * - at most once every minInterval ms. Changes arriving faster than that are coalesced,
+  *   and the latest value is notified once the interval has elapsed: the owner waits for
+  *   pendingDelay() and calls flush(), even if no new value comes. A value back within
+  *   the deadband before then cancels it.
+  */
+class MicroBitNotifyPolicy
+{
+    int32_t     deadband;
+    uint32_t    minInterval;
+    uint32_t    maxSilence;
+
+    int32_t     lastValue;
+    int32_t     pendingValue;
+    uint64_t    lastNotify;
+    bool        primed;
+    bool        pending;
+
+    public:
+
+    /**
+      * Constructor.
+      *
+      * @param deadband the change (exclusive) under which a value is not notified.
+      * @param minInterval the minimum time between two notifications, in ms.
+      * @param maxSilence the time after which a value is notified even if unchanged, in ms. 0 disables it.
+      */
+    MicroBitNotifyPolicy(int32_t deadband, uint32_t minInterval, uint32_t maxSilence);
+
+    /**
+      * Offer the current value of the characteristic.
+      *
+      * @param value the current value.
+      *
+      * @return true if the value must be notified now. The value is then recorded as notified.
+      */
+    bool offer(int32_t value);
+
+    /**
+      * Returns the time left before the coalesced value can be notified, in ms, or -1 if
+      * no value is waiting.
+      */
+    int32_t pendingDelay();
+
+    /**
+      * Take the coalesced value, once the minimum interval has elapsed.
+      *
+      * @return true if the last offered value must be notified now. It is then recorded as notified.
+      */
+    bool flush();
+
+    /**
+      * Forget the last notified value, so the next offered value is notified immediately.
+      * Used when the peer disconnects.
+      */
+    void reset();
+
+    /**
+      * Change the policy parameters.
+      *
+      * @param deadband the change (exclusive) under which a value is not notified.
+      * @param minInterval the minimum time between two notifications, in ms.
+      * @param maxSilence the time after which a value is notified even if unchanged, in ms. 0 disables it.
+      */
+    void configure(int32_t deadband, uint32_t minInterval, uint32_t maxSilence);
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "MicroBitConfig.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitPowerManager.h"
+
+/**
+  * Constructor.
+  *
+  * @param _display the display to manage.
+  * @param id the ID of the new MicroBitPowerManager object.
+  */
+MicroBitPowerManager::MicroBitPowerManager(MicroBitDisplay &_display, uint16_t id) : display(_display)
+{
+    this->id = id;
+    this->status = 0;
+    this->displayUsers = 0;
+    this->tickPeriod = 0;
+    this->lastTick = 0;
+    this->idleFiber = NULL;
+    this->sleepTime = 0;
+    this->awakeTime = 0;
+}
+
+/**
+  * Start measuring the residency. Must be called once the runtime is initialised.
+  */
+void MicroBitPowerManager::start()
+{
+    if (status & MICROBIT_POWER_STARTED)
+        return;
+
+    tickPeriod = system_timer_get_period();
+    lastTick = system_timer_current_time();
+
+    fiber_add_idle_component(this);
+    system_timer_add_component(this);
+    status |= MICROBIT_POWER_STARTED;
+}
+
+/**
+  * Enable or disable the low power mode.
+  *
+  * @param enabled true to switch the display off, and slow down the system tick,
+  *        while the display has no user.
+  */
+void MicroBitPowerManager::setLowPower(bool enabled)
+{
+    start();
+
+    if (enabled)
+        status |= MICROBIT_POWER_LOW_POWER;
+    else
+        status &= ~MICROBIT_POWER_LOW_POWER;
+
+    apply();
+}
+
+/**
+  * Register a user of the display, switching it on if needed.
+  */
+void MicroBitPowerManager::acquireDisplay()
+{
+    if (displayUsers++ == 0)
+        apply();
+}
+
+/**
+  * Unregister a user of the display, switching it off if it was the last one.
+  */
+void MicroBitPowerManager::releaseDisplay()
+{
+    if (displayUsers > 0 && --displayUsers == 0)
+        apply();
+}
+
+/**
+  * Switch the display and the fast system tick on or off, as needed by the users.
+  */
+void MicroBitPowerManager::apply()
+{
+    if (!(status & MICROBIT_POWER_STARTED))
+        return;
+
+    if (displayUsers > 0 || !(status & MICROBIT_POWER_LOW_POWER))
+    {
+        // The display is multiplexed from the system tick: speed it up first
+        system_timer_set_period(tickPeriod);
+        display.enable();
+    }
+    else
+    {
+        display.disable();
+        system_timer_set_period(MICROBIT_POWER_IDLE_TICK_PERIOD);
+    }
+}
+
+/**
+  * Time spent in the idle loop since the last reset(), in ms.
+  */
+uint32_t MicroBitPowerManager::getSleepTime()
+{
+    return sleepTime;
+}
+
+/**
+  * Time spent running fibers since the last reset(), in ms.
+  */
+uint32_t MicroBitPowerManager::getAwakeTime()
+{
+    return awakeTime;
+}
+
+/**
+  * Clear the residency measurements.
+  */
+void MicroBitPowerManager::reset()
+{
+    sleepTime = 0;
+    awakeTime = 0;
+}
+
+/**
+  * Write the residency as a CSV line: power,sleep_ms,awake_ms,sleep_permille
+  *
+  * @param serial the serial port to write to.
+  */
+void MicroBitPowerManager::report(MicroBitSerial &serial)
+{
+    uint32_t sleep = sleepTime;
+    uint32_t awake = awakeTime;
+    uint32_t total = sleep + awake;
+
+    serial.printf("power,%d,%d,%d\r\n", (int)sleep, (int)awake, total ? (int)((uint64_t)sleep * 1000 / total) : 0);
+}
+
+/**
+  * Periodic callback from MicroBit system timer: accounts the time since the last tick to the
+  * sleep or awake time. Runs in interrupt context, so it sees the fiber the tick interrupted.
+  */
+void MicroBitPowerManager::systemTick()
+{
+    uint32_t now = system_timer_current_time();
+    uint32_t elapsed = now - lastTick;
+
+    lastTick = now;
+
+    if (idleFiber != NULL && currentFiber == idleFiber)
+        sleepTime += elapsed;
+    else
+        awakeTime += elapsed;
+}
+
+/**
+  * Callback from MicroBit idle thread: learns which fiber is the idle one, then leaves the
+  * idle thread its room for other components.
+  */
+void MicroBitPowerManager::idleTick()
+{
+    idleFiber = currentFiber;
+    fiber_remove_idle_component(this);
+}
+
+#ifdef MICROBIT_SIM
+/**
+  * Returns the system time, in ms, of the next tick with work to do: the accounting needs no
+  * tick in particular once the idle fiber is known.
+  */
+uint64_t MicroBitPowerManager::getWakeupTime()
+{
+    return idleFiber != NULL ? (uint64_t)-1 : 0;
+}
+#endif
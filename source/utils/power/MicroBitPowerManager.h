@@ -0,0 +1,136 @@
+#ifndef MICROBIT_POWER_MANAGER_H
+#define MICROBIT_POWER_MANAGER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "MicroBitFiber.h"
+#include "MicroBitDisplay.h"
+#include "MicroBitSerial.h"
+
+#define MICROBIT_ID_POWER_MANAGER               1238
+
+// System tick period while the display is off, in ms. Slower ticks mean fewer wake ups,
+// but coarser timers and slower button debouncing.
+#define MICROBIT_POWER_IDLE_TICK_PERIOD         20
+
+// Status flags
+#define MICROBIT_POWER_STARTED                  0x01
+#define MICROBIT_POWER_LOW_POWER                0x02
+
+/**
+  * Class definition for MicroBitPowerManager.
+  *
+  * Keeps the display, and the fast system tick its multiplexing needs, running only while
+  * something uses it: users call acquireDisplay() before showing something and
+  * releaseDisplay() once done. In low power mode the display is switched off and the
+  * system tick slowed down to MICROBIT_POWER_IDLE_TICK_PERIOD when it has no user, so that
+  * the CPU sleeps until the next tick, sample deadline or radio event.
+  *
+  * It also measures how the time is split between the idle loop, where the CPU sleeps,
+  * and the fibers, by looking at the running fiber on every system tick. The idle loop
+  * time includes the idle components, e.g. the probe readings, a few ms per sample.
+  */
+class MicroBitPowerManager : public MicroBitComponent
+{
+    public:
+
+    /**
+      * Constructor.
+      *
+      * @param _display the display to manage.
+      * @param id the ID of the new MicroBitPowerManager object.
+      */
+    MicroBitPowerManager(MicroBitDisplay &_display, uint16_t id = MICROBIT_ID_POWER_MANAGER);
+
+    /**
+      * Start measuring the residency. Must be called once the runtime is initialised.
+      */
+    void start();
+
+    /**
+      * Enable or disable the low power mode.
+      *
+      * @param enabled true to switch the display off, and slow down the system tick,
+      *        while the display has no user.
+      */
+    void setLowPower(bool enabled);
+
+    /**
+      * Register a user of the display, switching it on if needed.
+      */
+    void acquireDisplay();
+
+    /**
+      * Unregister a user of the display, switching it off if it was the last one.
+      */
+    void releaseDisplay();
+
+    /**
+      * Time spent in the idle loop since the last reset(), in ms.
+      */
+    uint32_t getSleepTime();
+
+    /**
+      * Time spent running fibers since the last reset(), in ms.
+      */
+    uint32_t getAwakeTime();
+
+    /**
+      * Clear the residency measurements.
+      */
+    void reset();
+
+    /**
+      * Write the residency as a CSV line: power,sleep_ms,awake_ms,sleep_permille
+      *
+      * @param serial the serial port to write to.
+      */
+    void report(MicroBitSerial &serial);
+
+    /**
+      * Periodic callback from MicroBit system timer: accounts the time since the last tick to the
+      * sleep or awake time.
+      */
+    virtual void systemTick();
+
+    /**
+      * Callback from MicroBit idle thread: learns which fiber is the idle one, then leaves the
+      * idle thread its room for other components.
+      */
+    virtual void idleTick();
+
+#ifdef MICROBIT_SIM
+    /**
+      * Returns the system time, in ms, of the next tick with work to do: the accounting needs no
+      * tick in particular once the idle fiber is known.
+      */
+    virtual uint64_t getWakeupTime();
+#endif
+
+    private:
+
+    /**
+      * Switch the display and the fast system tick on or off, as needed by the users.
+      */
+    void apply();
+
+    MicroBitDisplay         &display;
+
+    // Number of users of the display
+    uint8_t                 displayUsers;
+
+    // System tick period set by the runtime, in ms
+    int                     tickPeriod;
+
+    // System time of the last tick, in ms (wrapping)
+    uint32_t                lastTick;
+
+    // Fiber running the idle loop, NULL until known
+    Fiber                   *idleFiber;
+
+    // Residency, in ms
+    volatile uint32_t       sleepTime;
+    volatile uint32_t       awakeTime;
+};
+
+#endif
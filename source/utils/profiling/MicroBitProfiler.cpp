@@ -0,0 +1,89 @@
+#include "mbed.h"
+#include "MicroBitProfiler.h"
+
+static const char * const stageNames[PROFILER_STAGE_COUNT] = {
+    "sample", "acquire", "dispatch", "handler", "notify"
+};
+
+static const char * const milestoneNames[PROFILER_BOOT_COUNT] = {
+    "start", "runtime", "control", "calibrated", "services"
+};
+
+MicroBitProfilerRecord MicroBitProfiler::records[PROFILER_STAGE_COUNT];
+uint32_t MicroBitProfiler::milestones[PROFILER_BOOT_COUNT];
+
+/**
+  * Mark the beginning of a stage.
+  *
+  * @param stage the stage being measured.
+  */
+void MicroBitProfiler::begin(MicroBitProfilerStage stage)
+{
+    records[stage].start = us_ticker_read();
+}
+
+/**
+  * Mark the end of a stage, accounting the time elapsed since the matching begin().
+  *
+  * @param stage the stage being measured.
+  */
+void MicroBitProfiler::end(MicroBitProfilerStage stage)
+{
+    MicroBitProfilerRecord &r = records[stage];
+
+    // Unsigned arithmetic keeps this correct across a ticker wrap.
+    uint32_t elapsed = us_ticker_read() - r.start;
+
+    r.count++;
+    r.total += elapsed;
+
+    if (elapsed > r.max)
+        r.max = elapsed;
+}
+
+/**
+  * Clear all the collected statistics.
+  */
+void MicroBitProfiler::reset()
+{
+    memset(records, 0, sizeof(records));
+}
+
+/**
+  * Write the collected statistics as CSV lines:
+  * stage,count,total_us,max_us,avg_us,avg_cycles
+  *
+  * @param serial the serial port to write to.
+  */
+void MicroBitProfiler::report(MicroBitSerial &serial)
+{
+    for (int i = 0; i < PROFILER_STAGE_COUNT; i++)
+    {
+        MicroBitProfilerRecord &r = records[i];
+        uint32_t avg = r.count ? r.total / r.count : 0;
+
+        serial.printf("%s,%d,%d,%d,%d,%d\r\n", stageNames[i], (int)r.count, (int)r.total, (int)r.max, (int)avg, (int)(avg * MICROBIT_PROFILER_CPU_MHZ));
+    }
+}
+
+/**
+  * Record that a startup milestone has been reached.
+  *
+  * @param milestone the milestone reached.
+  */
+void MicroBitProfiler::milestone(MicroBitProfilerMilestone milestone)
+{
+    milestones[milestone] = us_ticker_read();
+}
+
+/**
+  * Write the time each startup milestone was reached, from PROFILER_BOOT_START, as CSV lines:
+  * boot,milestone,us
+  *
+  * @param serial the serial port to write to.
+  */
+void MicroBitProfiler::reportBoot(MicroBitSerial &serial)
+{
+    for (int i = 0; i < PROFILER_BOOT_COUNT; i++)
+        serial.printf("boot,%s,%d\r\n", milestoneNames[i], (int)(milestones[i] - milestones[PROFILER_BOOT_START]));
+}
@@ -0,0 +1,137 @@
+#ifndef MICROBIT_PROFILER_H
+#define MICROBIT_PROFILER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitSerial.h"
+
+#include "../../SmartVaseConfig.h"
+
+// Core clock of the nRF51822, used to convert microseconds into cycles.
+#define MICROBIT_PROFILER_CPU_MHZ               16
+
+/**
+  * Stages of the sensor-to-notify path.
+  */
+enum MicroBitProfilerStage
+{
+    // Whole MicroBitMoistureSensor::updateSample() call that took a reading.
+    PROFILER_STAGE_SAMPLE = 0,
+    // Probe excitation and ADC conversions only.
+    PROFILER_STAGE_ACQUIRE,
+    // From the MICROBIT_MOISTURE_EVT_UPDATE fire to the service handler.
+    PROFILER_STAGE_DISPATCH,
+    // Whole MicroBitMoistureService::moistureUpdate() call.
+    PROFILER_STAGE_HANDLER,
+    // gattServer().notify() only.
+    PROFILER_STAGE_NOTIFY,
+
+    PROFILER_STAGE_COUNT
+};
+
+/**
+  * Startup milestones, in the order they are reached.
+  */
+enum MicroBitProfilerMilestone
+{
+    // Entry of main(), the reference of the other milestones.
+    PROFILER_BOOT_START = 0,
+    // micro:bit runtime initialised.
+    PROFILER_BOOT_RUNTIME,
+    // Settings loaded and control loop listening: moisture is monitored and the pumps are safe.
+    PROFILER_BOOT_CONTROL,
+    // Probe excitation and thermometer calibrated.
+    PROFILER_BOOT_CALIBRATED,
+    // BLE services registered.
+    PROFILER_BOOT_SERVICES,
+
+    PROFILER_BOOT_COUNT
+};
+
+/**
+  * Timing statistics of a single stage.
+  */
+struct MicroBitProfilerRecord
+{
+    uint32_t    start;
+    uint32_t    count;
+    uint32_t    total;
+    uint32_t    max;
+};
+
+/**
+  * Class definition for the MicroBitProfiler.
+  *
+  * Collects the count, total and worst case time (in microseconds) spent in each stage
+  * of the sensor-to-notify path, based on the mbed microsecond ticker.
+  *
+  * The Cortex-M0 of the nRF51 has no DWT cycle counter, so cycles are derived from the
+  * elapsed microseconds at MICROBIT_PROFILER_CPU_MHZ.
+  *
+  * It also records when each startup milestone is reached.
+  *
+  * Use the PROFILER_BEGIN / PROFILER_END / PROFILER_MILESTONE macros, that compile to
+  * nothing unless SMART_VASE_PROFILING is enabled.
+  */
+class MicroBitProfiler
+{
+    public:
+
+    /**
+      * Mark the beginning of a stage.
+      *
+      * @param stage the stage being measured.
+      */
+    static void begin(MicroBitProfilerStage stage);
+
+    /**
+      * Mark the end of a stage, accounting the time elapsed since the matching begin().
+      *
+      * @param stage the stage being measured.
+      */
+    static void end(MicroBitProfilerStage stage);
+
+    /**
+      * Clear all the collected statistics.
+      */
+    static void reset();
+
+    /**
+      * Write the collected statistics as CSV lines:
+      * stage,count,total_us,max_us,avg_us,avg_cycles
+      *
+      * @param serial the serial port to write to.
+      */
+    static void report(MicroBitSerial &serial);
+
+    /**
+      * Record that a startup milestone has been reached.
+      *
+      * @param milestone the milestone reached.
+      */
+    static void milestone(MicroBitProfilerMilestone milestone);
+
+    /**
+      * Write the time each startup milestone was reached, from PROFILER_BOOT_START, as CSV lines:
+      * boot,milestone,us
+      *
+      * @param serial the serial port to write to.
+      */
+    static void reportBoot(MicroBitSerial &serial);
+
+    private:
+
+    static MicroBitProfilerRecord records[PROFILER_STAGE_COUNT];
+    static uint32_t milestones[PROFILER_BOOT_COUNT];
+};
+
+#if CONFIG_ENABLED(SMART_VASE_PROFILING)
+#define PROFILER_BEGIN(stage)   MicroBitProfiler::begin(stage)
+#define PROFILER_END(stage)     MicroBitProfiler::end(stage)
+#define PROFILER_MILESTONE(m)   MicroBitProfiler::milestone(m)
+#else
+#define PROFILER_BEGIN(stage)
+#define PROFILER_END(stage)
+#define PROFILER_MILESTONE(m)
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+#include "MicroBitAdaptivePeriod.h"
+
+/**
+  * Constructor.
+  *
+  * @param minPeriod the period used while readings change, in ms.
+  * @param maxPeriod the longest period used while readings are stable, in ms.
+  * @param threshold the change (exclusive) between two readings under which they are considered stable.
+  */
+MicroBitAdaptivePeriod::MicroBitAdaptivePeriod(uint32_t minPeriod, uint32_t maxPeriod, int32_t threshold)
+{
+    configure(minPeriod, maxPeriod, threshold);
+}
+
+/**
+  * Account a new reading.
+  *
+  * @param value the reading.
+  *
+  * @return the time until the next sample, in ms.
+  */
+uint32_t MicroBitAdaptivePeriod::update(int32_t value)
+{
+    if (primed && (value > last + threshold || value < last - threshold))
+        period = minPeriod;
+    else if (period < maxPeriod / 2)
+        period *= 2;
+    else
+        period = maxPeriod;
+
+    last = value;
+    primed = true;
+
+    return period;
+}
+
+/**
+  * Go back to the minimum period, e.g. when something is known to be changing the readings.
+  *
+  * @return the minimum period, in ms.
+  */
+uint32_t MicroBitAdaptivePeriod::boost()
+{
+    period = minPeriod;
+    return period;
+}
+
+/**
+  * The current period, in ms.
+  */
+uint32_t MicroBitAdaptivePeriod::get()
+{
+    return period;
+}
+
+/**
+  * Change the policy parameters. The current period restarts from the minimum.
+  *
+  * @param minPeriod the period used while readings change, in ms.
+  * @param maxPeriod the longest period used while readings are stable, in ms.
+  * @param threshold the change (exclusive) between two readings under which they are considered stable.
+  */
+void MicroBitAdaptivePeriod::configure(uint32_t minPeriod, uint32_t maxPeriod, int32_t threshold)
+{
+    this->minPeriod = minPeriod;
+    this->maxPeriod = maxPeriod < minPeriod ? minPeriod : maxPeriod;
+    this->threshold = threshold;
+    this->period = minPeriod;
+    this->primed = false;
+}
+
+/**
+  * Change the longest period only, keeping the current one if it is still within bounds.
+  *
+  * @param maxPeriod the longest period used while readings are stable, in ms.
+  */
+void MicroBitAdaptivePeriod::setMaxPeriod(uint32_t maxPeriod)
+{
+    this->maxPeriod = maxPeriod < minPeriod ? minPeriod : maxPeriod;
+
+    if (period > this->maxPeriod)
+        period = this->maxPeriod;
+}
@@ -0,0 +1,71 @@
+#ifndef MICROBIT_ADAPTIVE_PERIOD_H
+#define MICROBIT_ADAPTIVE_PERIOD_H
+
+#include "MicroBitConfig.h"
+
+/**
+  * Class definition for MicroBitAdaptivePeriod.
+  *
+  * Computes the time until the next sample of a sensor from its readings:
+  * the period drops to the minimum when a reading moves by more than a threshold
+  * from the previous one, and doubles (up to the maximum) while readings are stable.
+  */
+class MicroBitAdaptivePeriod
+{
+    uint32_t    minPeriod;
+    uint32_t    maxPeriod;
+    uint32_t    period;
+    int32_t     threshold;
+    int32_t     last;
+    bool        primed;
+
+    public:
+
+    /**
+      * Constructor.
+      *
+      * @param minPeriod the period used while readings change, in ms.
+      * @param maxPeriod the longest period used while readings are stable, in ms.
+      * @param threshold the change (exclusive) between two readings under which they are considered stable.
+      */
+    MicroBitAdaptivePeriod(uint32_t minPeriod, uint32_t maxPeriod, int32_t threshold);
+
+    /**
+      * Account a new reading.
+      *
+      * @param value the reading.
+      *
+      * @return the time until the next sample, in ms.
+      */
+    uint32_t update(int32_t value);
+
+    /**
+      * Go back to the minimum period, e.g. when something is known to be changing the readings.
+      *
+      * @return the minimum period, in ms.
+      */
+    uint32_t boost();
+
+    /**
+      * The current period, in ms.
+      */
+    uint32_t get();
+
+    /**
+      * Change the policy parameters. The current period restarts from the minimum.
+      *
+      * @param minPeriod the period used while readings change, in ms.
+      * @param maxPeriod the longest period used while readings are stable, in ms.
+      * @param threshold the change (exclusive) between two readings under which they are considered stable.
+      */
+    void configure(uint32_t minPeriod, uint32_t maxPeriod, int32_t threshold);
+
+    /**
+      * Change the longest period only, keeping the current one if it is still within bounds.
+      *
+      * @param maxPeriod the longest period used while readings are stable, in ms.
+      */
+    void setMaxPeriod(uint32_t maxPeriod);
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef MICROBIT_SERVICE_REGISTRY_H
+#define MICROBIT_SERVICE_REGISTRY_H
+
+#include <new>
+#include <utility>
+
+#include "MicroBitConfig.h"
+
+/**
+  * Estimated use of the SoftDevice attribute table (see gatt_table_size in config.json), in bytes.
+  *
+  * Each attribute costs a fixed header plus its UUID and value; the sizes below assume 128 bit
+  * UUIDs and are rounded up, so that the budget errs on the safe side.
+  */
+
+// Primary service declaration
+#define MICROBIT_GATT_SERVICE_SIZE                  24
+
+// Characteristic declaration and value, plus the client configuration descriptor if it notifies
+#define MICROBIT_GATT_CHARACTERISTIC_SIZE(len, notify)  (((27 + 24 + (len) + ((notify) ? 10 : 0)) + 3) & ~3)
+
+// Generic Access and Generic Attribute services, always present
+#define MICROBIT_GATT_CORE_SIZE                     96
+
+// Services added by the micro:bit runtime, as enabled in config.json
+#if CONFIG_ENABLED(MICROBIT_BLE_DFU_SERVICE)
+#define MICROBIT_GATT_DFU_SIZE                      (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(1, 1) + MICROBIT_GATT_CHARACTERISTIC_SIZE(4, 0))
+#else
+#define MICROBIT_GATT_DFU_SIZE                      0
+#endif
+
+#if CONFIG_ENABLED(MICROBIT_BLE_EVENT_SERVICE)
+#define MICROBIT_GATT_EVENT_SIZE                    (MICROBIT_GATT_SERVICE_SIZE + 4 * MICROBIT_GATT_CHARACTERISTIC_SIZE(20, 1))
+#else
+#define MICROBIT_GATT_EVENT_SIZE                    0
+#endif
+
+#if CONFIG_ENABLED(MICROBIT_BLE_DEVICE_INFORMATION_SERVICE)
+#define MICROBIT_GATT_DEVICE_INFO_SIZE              (MICROBIT_GATT_SERVICE_SIZE + 4 * MICROBIT_GATT_CHARACTERISTIC_SIZE(20, 0))
+#else
+#define MICROBIT_GATT_DEVICE_INFO_SIZE              0
+#endif
+
+#define MICROBIT_GATT_RUNTIME_SIZE                  (MICROBIT_GATT_CORE_SIZE + MICROBIT_GATT_DFU_SIZE + MICROBIT_GATT_EVENT_SIZE + MICROBIT_GATT_DEVICE_INFO_SIZE)
+
+// MicroBitTemperatureService of the runtime: temperature (notify) and period characteristics
+#define MICROBIT_TEMPERATURE_SERVICE_GATT_SIZE      (MICROBIT_GATT_SERVICE_SIZE + MICROBIT_GATT_CHARACTERISTIC_SIZE(1, 1) + MICROBIT_GATT_CHARACTERISTIC_SIZE(2, 0))
+
+// Its period writes reach it through a callback of its own, not the write dispatcher
+#define MICROBIT_TEMPERATURE_SERVICE_WRITE_HANDLERS 0
+
+/**
+  * Class definition for MicroBitStaticService.
+  *
+  * Statically allocated room for a single service of type T, constructed in place on demand.
+  * Declared at file scope, the service and its characteristic buffers end up in .bss, so their
+  * RAM is accounted for at link time instead of coming from the heap. Services are never
+  * destroyed, as they cannot be removed from the SoftDevice.
+  *
+  * @code
+  * MicroBitAmbientLightSensor lightSensor(uBit.display);
+  * MicroBitStaticService<MicroBitLightService> lightService;
+  *
+  * lightService.create(*uBit.ble, lightSensor);
+  * lightService->setNotifyPolicy(4, 5000, 60000);
+  * @endcode
+  */
+template <typename T>
+class MicroBitStaticService
+{
+    alignas(T) uint8_t  storage[sizeof(T)];
+    bool                created;
+
+    public:
+
+    /**
+      * Constructor.
+      * Create an empty slot. It is constant initialised, so it can be used before the
+      * constructors of the other globals run.
+      */
+    constexpr MicroBitStaticService() : storage(), created(false)
+    {
+    }
+
+    /**
+      * Construct the service in place, with the given constructor arguments.
+      * Has no effect if the service was already created.
+      *
+      * @return the service.
+      */
+    template <typename... Args>
+    T *create(Args&&... args)
+    {
+        if (!created)
+        {
+            new (storage) T(std::forward<Args>(args)...);
+            created = true;
+        }
+
+        return get();
+    }
+
+    /**
+      * Returns true once the service has been created.
+      */
+    bool isCreated() const
+    {
+        return created;
+    }
+
+    /**
+      * Returns the service, or NULL if it has not been created yet.
+      */
+    T *get()
+    {
+        return created ? reinterpret_cast<T *>(storage) : NULL;
+    }
+
+    T *operator->()
+    {
+        return get();
+    }
+};
+
+#endif
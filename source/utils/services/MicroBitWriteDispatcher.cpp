@@ -0,0 +1,66 @@
+#include "MicroBitWriteDispatcher.h"
+
+uint8_t MicroBitWriteDispatcher::slots[MICROBIT_WRITE_DISPATCHER_MAX_HANDLE + 1];
+MicroBitWriteHandler *MicroBitWriteDispatcher::handlers[MICROBIT_WRITE_DISPATCHER_HANDLERS];
+uint8_t MicroBitWriteDispatcher::count = 0;
+
+/**
+  * Send the writes of an attribute to a handler.
+  *
+  * @param ble The instance of a BLE device that we're running on.
+  * @param handle the attribute handle, e.g. the value handle of a characteristic.
+  * @param handler the object receiving the writes.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the handle is above
+  *         MICROBIT_WRITE_DISPATCHER_MAX_HANDLE, MICROBIT_NO_RESOURCES if there are
+  *         already MICROBIT_WRITE_DISPATCHER_HANDLERS handlers.
+  */
+int MicroBitWriteDispatcher::add(BLEDevice &ble, GattAttribute::Handle_t handle, MicroBitWriteHandler *handler)
+{
+    if (handle > MICROBIT_WRITE_DISPATCHER_MAX_HANDLE)
+        return MICROBIT_INVALID_PARAMETER;
+
+    // A handler added for several attributes takes a single entry.
+    int i = 0;
+
+    while (i < count && handlers[i] != handler)
+        i++;
+
+    if (i == count)
+    {
+        if (count == MICROBIT_WRITE_DISPATCHER_HANDLERS)
+            return MICROBIT_NO_RESOURCES;
+
+        // Register with the BLE stack on first use.
+        if (count == 0)
+            ble.onDataWritten(&MicroBitWriteDispatcher::dispatch);
+
+        handlers[count++] = handler;
+    }
+
+    slots[handle] = i + 1;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Callback. Invoked by the BLE stack on every write.
+  */
+void MicroBitWriteDispatcher::dispatch(const GattWriteCallbackParams *params)
+{
+    if (params->handle > MICROBIT_WRITE_DISPATCHER_MAX_HANDLE)
+        return;
+
+    uint8_t slot = slots[params->handle];
+
+    if (slot)
+        handlers[slot - 1]->onDataWritten(params);
+}
+
+/**
+  * Returns the number of handlers added.
+  */
+int MicroBitWriteDispatcher::getCount()
+{
+    return count;
+}
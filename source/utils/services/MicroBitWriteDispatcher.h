@@ -0,0 +1,76 @@
+#ifndef MICROBIT_WRITE_DISPATCHER_H
+#define MICROBIT_WRITE_DISPATCHER_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitDevice.h"
+#include "ble/BLE.h"
+
+// Highest attribute handle that can be dispatched. Handles are given out in order by the
+// SoftDevice, so this bounds the size of the attribute table rather than the number of writes.
+#define MICROBIT_WRITE_DISPATCHER_MAX_HANDLE    127
+
+// Number of handlers that can be registered
+#define MICROBIT_WRITE_DISPATCHER_HANDLERS      8
+
+// Panic code of a service that could not register its handler: a write to it would be lost
+#define MICROBIT_WRITE_DISPATCHER_PANIC         110
+
+/**
+  * Interface of the objects that receive the writes of some attributes.
+  */
+class MicroBitWriteHandler
+{
+    public:
+
+    /**
+      * Callback. Invoked when one of the attributes the handler was added for is written via BLE.
+      */
+    virtual void onDataWritten(const GattWriteCallbackParams *params) = 0;
+};
+
+/**
+  * Class definition for the MicroBitWriteDispatcher.
+  *
+  * Registers a single onDataWritten callback with the BLE stack, and hands each write over
+  * to the handler of the attribute written, found by indexing a table with the attribute
+  * handle. A write costs the same whatever the number of services, and runs no other
+  * service than the one written.
+  *
+  * The table holds one byte per handle, pointing into a short list of handlers.
+  */
+class MicroBitWriteDispatcher
+{
+    public:
+
+    /**
+      * Send the writes of an attribute to a handler.
+      *
+      * @param ble The instance of a BLE device that we're running on.
+      * @param handle the attribute handle, e.g. the value handle of a characteristic.
+      * @param handler the object receiving the writes.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the handle is above
+      *         MICROBIT_WRITE_DISPATCHER_MAX_HANDLE, MICROBIT_NO_RESOURCES if there are
+      *         already MICROBIT_WRITE_DISPATCHER_HANDLERS handlers.
+      */
+    static int add(BLEDevice &ble, GattAttribute::Handle_t handle, MicroBitWriteHandler *handler);
+
+    /**
+      * Callback. Invoked by the BLE stack on every write.
+      */
+    static void dispatch(const GattWriteCallbackParams *params);
+
+    /**
+      * Returns the number of handlers added.
+      */
+    static int getCount();
+
+    private:
+
+    // Index + 1 in handlers of the handler of each attribute handle, 0 if none
+    static uint8_t              slots[MICROBIT_WRITE_DISPATCHER_MAX_HANDLE + 1];
+    static MicroBitWriteHandler *handlers[MICROBIT_WRITE_DISPATCHER_HANDLERS];
+    static uint8_t              count;
+};
+
+#endif